@@ -28,6 +28,7 @@
 #include "external/printf/printf.h"
 #include "frequencies.h"
 #include "functions.h"
+#include "helper/rssi.h"
 #include "misc.h"
 #include "settings.h"
 #ifdef ENABLE_AGC_SHOW_DATA
@@ -91,12 +92,9 @@ typedef struct
 //  static const int16_t mixer_dB[]     = { ( -8), ( -6), ( -3),    0};
 //  static const int16_t pga_dB[]       = { (-33), (-27), (-21), (-15), (-9), (-6), (-3), 0};
 
-// lookup table is hugely easier than writing code to do the same
+// lookup table is hugely easier than writing code to do the same, sorted by
+// ascending gain from index 1 on so it can be binary searched
 //
-
-#define LOOKUP_TABLE 1
-
-#if LOOKUP_TABLE
 static const t_gain_table gain_table[] =
 {
     {0x03BE, -7},   //  0 .. 3 5 3 6 ..   0dB  -4dB  0dB  -3dB ..  -7dB original
@@ -145,67 +143,7 @@ static const t_gain_table gain_table[] =
     {0x03FF,0}      // 42 .. 3 7 3 7 ..   0dB   0dB  0dB   0dB ..   0dB
 };
 
-const uint8_t gain_table_size = ARRAY_SIZE(gain_table);
-#else
-
-t_gain_table gain_table[100] = {{0x03BE, -7}}; //original
-uint8_t gain_table_size = 0;
-
-void CreateTable()
-{
-typedef union  {
-    struct {
-        uint8_t pgaIdx:3;
-        uint8_t mixerIdx:2;
-        uint8_t lnaIdx:3;
-        uint8_t lnaSIdx:2;
-    };
-    uint16_t __raw;
-} GainData;
-
-    static const int8_t lna_short_dB[] = {-28, -24, -19,  0};   // corrected'ish
-    static const int8_t lna_dB[]       = {-24, -19, -14,  -9, -6, -4, -2, 0};
-    static const int8_t mixer_dB[]     = { -8,  -6,  -3,   0};
-    static const int8_t pga_dB[]       = {-33, -27, -21, -15, -9, -6, -3, 0};
-
-    unsigned i;
-    for (uint8_t lnaSIdx = 0; lnaSIdx < ARRAY_SIZE(lna_short_dB); lnaSIdx++) {
-        for (uint8_t lnaIdx = 0; lnaIdx < ARRAY_SIZE(lna_dB); lnaIdx++) {
-            for (uint8_t mixerIdx = 0; mixerIdx < ARRAY_SIZE(mixer_dB); mixerIdx++) {
-                for (uint8_t pgaIdx = 0; pgaIdx < ARRAY_SIZE(pga_dB); pgaIdx++) {
-                    int16_t db = lna_short_dB[lnaSIdx] + lna_dB[lnaIdx] + mixer_dB[mixerIdx] + pga_dB[pgaIdx];
-                    GainData gainData = {{
-                        pgaIdx,
-                        mixerIdx,
-                        lnaIdx,
-                        lnaSIdx,
-                    }};
-
-                    for (i = 1; i < ARRAY_SIZE(gain_table); i++) {
-                        t_gain_table * gain = &gain_table[i];
-                        if (db == gain->gain_dB)
-                            break;
-                        if (db > gain->gain_dB)
-                            continue;
-                        if (db < gain->gain_dB) {
-                            if(gain->gain_dB)
-                                memmove(gain + 1, gain, 100 - i);
-                            gain->gain_dB = db;
-                            gain->reg_val = gainData.__raw;
-                            break;
-                        }
-                        gain->gain_dB = db;
-                        gain->reg_val = gainData.__raw;
-                        break;
-                    }
-                }
-            }
-        }
-    }
-
-    gain_table_size = i+1;
-}
-#endif
+static const uint8_t gain_table_size = ARRAY_SIZE(gain_table);
 
 
 #ifdef ENABLE_AM_FIX_SHOW_DATA
@@ -221,9 +159,26 @@ unsigned int gain_table_index_prev[2] = {0, 0};
 int16_t prev_rssi[2] = {0, 0};
 // to help reduce gain hunting, peak hold count down tick
 unsigned int hold_counter[2] = {0, 0};
+// ticks to wait for the RSSI to follow a retune or a gain change (20 .. 30ms)
+uint8_t settle_counter[2] = {0, 0};
 // -89dBm, any higher and the AM demodulator starts to saturate/clip/distort
 const int16_t desired_rssi = (-89 + 160) * 2;
 
+// last converged gain index per frequency bucket, direct mapped, and per band
+// for buckets not seen yet .. so a retune (or a scanner hop) starts out at the
+// gain that worked there last time rather than pumping its way to it again
+#define GAIN_MEMORY_BUCKET 2500u    // 25kHz, in 10Hz units
+#define GAIN_MEMORY_SIZE   8u
+
+typedef struct
+{
+    uint16_t bucket;                // frequency / GAIN_MEMORY_BUCKET, 0 = unused
+    uint8_t  index;
+} __attribute__((packed)) t_gain_memory;
+
+static t_gain_memory gain_memory[GAIN_MEMORY_SIZE];
+static uint8_t       band_gain_index[BAND_N_ELEM];    // 0 = not converged yet
+
 int8_t currentGainDiff;
 bool enabled = true;
 
@@ -232,9 +187,6 @@ void AM_fix_init(void)
     for (int i = 0; i < 2; i++) {
         gain_table_index[i] = 0;  // re-start with original QS setting
     }
-#if !LOOKUP_TABLE
-    CreateTable();
-#endif
 }
 
 void AM_fix_reset(const unsigned vfo)
@@ -248,9 +200,48 @@ void AM_fix_reset(const unsigned vfo)
 
     prev_rssi[vfo] = 0;
     hold_counter[vfo] = 0;
+    settle_counter[vfo] = 3;
     gain_table_index_prev[vfo] = 0;
 }
 
+// highest index (from 1 on) with a gain no higher than gain_dB
+static unsigned int AM_fix_find_gain(const int16_t gain_dB)
+{
+    unsigned int lo = 1;
+    unsigned int hi = gain_table_size - 1u;
+
+    while (lo < hi) {
+        const unsigned int mid = (lo + hi + 1) / 2;
+        if (gain_table[mid].gain_dB <= gain_dB)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+static void AM_fix_recall(const unsigned vfo, const uint32_t freq, const unsigned int band)
+{
+    const t_gain_memory *mem = &gain_memory[(freq / GAIN_MEMORY_BUCKET) % GAIN_MEMORY_SIZE];
+
+    if (mem->bucket != 0 && mem->bucket == freq / GAIN_MEMORY_BUCKET)
+        gain_table_index[vfo] = mem->index;
+    else if (band < BAND_N_ELEM && band_gain_index[band] != 0)
+        gain_table_index[vfo] = band_gain_index[band];
+}
+
+static void AM_fix_remember(const unsigned vfo, const uint32_t freq, const unsigned int band)
+{
+    t_gain_memory *mem = &gain_memory[(freq / GAIN_MEMORY_BUCKET) % GAIN_MEMORY_SIZE];
+
+    mem->bucket = freq / GAIN_MEMORY_BUCKET;
+    mem->index  = gain_table_index[vfo];
+
+    if (band < BAND_N_ELEM)
+        band_gain_index[band] = gain_table_index[vfo];
+}
+
 // adjust the RX gain to try and prevent the AM demodulator from
 // saturating/overloading/clipping (distorted AM audio)
 //
@@ -258,6 +249,10 @@ void AM_fix_reset(const unsigned vfo)
 // won't/don't do it for itself, we're left to bodging it ourself by
 // playing with the RF front end gain setting
 //
+// the table is in dB, so one RSSI reading tells us where the gain wants to
+// be: go straight there when it has to come down, and halve the distance
+// each step when it may go back up
+//
 void AM_fix_10ms(const unsigned vfo)
 {
     if(!gSetting_AM_fix || !enabled || vfo > 1 )
@@ -279,82 +274,81 @@ void AM_fix_10ms(const unsigned vfo)
     }
 #endif
 
+    const uint32_t     freq = gEeprom.VfoInfo[vfo].pRX->Frequency;
+    const unsigned int band = gEeprom.VfoInfo[vfo].Band;
+
     static uint32_t lastFreq[2];
-    if(gEeprom.VfoInfo[vfo].pRX->Frequency != lastFreq[vfo]) {
-        lastFreq[vfo] = gEeprom.VfoInfo[vfo].pRX->Frequency;
+    if(freq != lastFreq[vfo]) {
+        lastFreq[vfo] = freq;
         AM_fix_reset(vfo);
+        AM_fix_recall(vfo, freq, band);
     }
 
-    int16_t rssi;
-    {   // sample the current RSSI level
-        // average it with the previous rssi (a bit of noise/spike immunity)
-        const int16_t new_rssi = BK4819_GetRSSI();
-        rssi                   = (prev_rssi[vfo] > 0) ? (prev_rssi[vfo] + new_rssi) / 2 : new_rssi;
-        prev_rssi[vfo]         = new_rssi;
+    if (settle_counter[vfo] > 0) {
+        // the RSSI still reflects the previous frequency/gain
+        settle_counter[vfo]--;
     }
+    else {
+        int16_t rssi;
+        {   // sample the current RSSI level
+            // average it with the previous rssi (a bit of noise/spike immunity)
+            const int16_t new_rssi = RSSI_GetRaw();
+            rssi                   = (prev_rssi[vfo] > 0) ? (prev_rssi[vfo] + new_rssi) / 2 : new_rssi;
+            prev_rssi[vfo]         = new_rssi;
+        }
 
 #ifdef ENABLE_AM_FIX_SHOW_DATA
-    {
-        static int16_t lastRssi;
+        {
+            static int16_t lastRssi;
 
-        if (lastRssi != rssi) { // rssi changed
-            lastRssi = rssi;
+            if (lastRssi != rssi) { // rssi changed
+                lastRssi = rssi;
 
-            if (counter == 0) {
-                counter        = 1;
-                gUpdateDisplay = true; // trigger a display update
+                if (counter == 0) {
+                    counter        = 1;
+                    gUpdateDisplay = true; // trigger a display update
+                }
             }
         }
-    }
 #endif
 
-    // automatically adjust the RF RX gain
+        // automatically adjust the RF RX gain
 
-    // update the gain hold counter
-    if (hold_counter[vfo] > 0)
-        hold_counter[vfo]--;
+        // update the gain hold counter
+        if (hold_counter[vfo] > 0)
+            hold_counter[vfo]--;
 
-    // dB difference between actual and desired RSSI level
-    int16_t diff_dB = (rssi - desired_rssi) / 2;
+        // dB difference between actual and desired RSSI level
+        const int16_t diff_dB = (rssi - desired_rssi) / 2;
 
-    if (diff_dB > 0) {  // decrease gain
-        unsigned int index = gain_table_index[vfo];   // current position we're at
+        // the gain that would bring the RSSI down/up to the desired level
+        const unsigned int index  = gain_table_index[vfo];
+        const unsigned int target = AM_fix_find_gain(gain_table[index].gain_dB - diff_dB);
+        // index 0 is out of order, start from its nearest sorted entry
+        const unsigned int from   = index ? index : AM_fix_find_gain(gain_table[0].gain_dB);
 
-        if (diff_dB >= 10) {    // jump immediately to a new gain setting
-            // this greatly speeds up initial gain reduction (but reduces noise/spike immunity)
-
-            const int16_t desired_gain_dB = (int16_t)gain_table[index].gain_dB - diff_dB + 8; // get no closer than 8dB (bit of noise/spike immunity)
-
-            // scan the table to see what index to jump straight too
-            while (index > 1)
-                if (gain_table[--index].gain_dB <= desired_gain_dB)
-                    break;
-        }
-        else
-        {   // incrementally reduce the gain .. taking it slow improves noise/spike immunity
-            if (index > 1)
-                index--;     // slow step-by-step gain reduction
+        if (diff_dB > 0) {  // decrease gain, immediately
+            if (target < from || index == 0)
+                gain_table_index[vfo] = MIN(target, from);
+            hold_counter[vfo] = 30;       // 300ms hold
         }
-
-        index = MAX(1u, index);
-
-        if (gain_table_index[vfo] != index)
-        {
-            gain_table_index[vfo] = index;
+        else if (diff_dB >= -6) {         // 6dB hysterisis (help reduce gain hunting)
             hold_counter[vfo] = 30;       // 300ms hold
+            if (index != 0)
+                AM_fix_remember(vfo, freq, band);
+        }
+        else if (hold_counter[vfo] == 0 && target > from) {
+            // hold has been released, we're free to increase gain .. half way
+            // at a time, the RSSI won't rise above the noise floor on a weak signal
+            gain_table_index[vfo] = from + (target - from + 1) / 2;
         }
-    }
-
-    if (diff_dB >= -6)                    // 6dB hysterisis (help reduce gain hunting)
-        hold_counter[vfo] = 30;           // 300ms hold
 
-    if (hold_counter[vfo] == 0)
-    {   // hold has been released, we're free to increase gain
-        const unsigned int index = gain_table_index[vfo] + 1;                 // move up to next gain index
-        gain_table_index[vfo] = MIN(index, gain_table_size - 1u);
+        if (gain_table_index[vfo] != index) {
+            prev_rssi[vfo]      = 0;      // taken at the old gain
+            settle_counter[vfo] = 2;
+        }
     }
 
-
     {   // apply the new settings to the front end registers
         const unsigned int index = gain_table_index[vfo];
 
@@ -21,7 +21,9 @@
 #include "driver/bk4819.h"
 #include "driver/crc.h"
 #include "driver/eeprom.h"
+#include "driver/py25q16.h"
 #include "frequencies.h"
+#include "helper/scratch.h"
 #include "misc.h"
 #include "radio.h"
 #include "ui/helper.h"
@@ -29,6 +31,7 @@
 #include "ui/ui.h"
 #include "settings.h"
 #include <stddef.h>
+#include <string.h>
 
 #ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
 #include "screenshot.h"
@@ -41,17 +44,28 @@ uint16_t gAirCopyBlockNumber;
 uint16_t gErrorsDuringAirCopy;
 uint8_t gAirCopyIsSendMode;
 
-uint16_t g_FSK_Buffer[36];
+uint16_t *g_FSK_Buffer;
+
+// the radio stays in AirCopy until it is switched off, so the buffers are
+// taken from the scratch region once and never given back
+typedef struct
+{
+    uint16_t FSK[36];
+    uint8_t  Blocks[AIRCOPY_MAX_BLOCKS / 8];
+} AIRCOPY_Scratch_t;
+
+SCRATCH_CHECK(AIRCOPY_Scratch_t);
 
 // ============================================================================
 // Transfer Maps Definition
 // ============================================================================
 
+// Attributes go first: they tell which frequency/name blocks are in use
 #define AIRCOPY_BANK_SEGMENTS(bank)                     \
 {                                                       \
+    { 0x8000 + (bank)*0x0100, 0x8000 + (bank)*0x0100 + 0x0100, AIRCOPY_WRITE_BYTES  }, \
     { 0x0000 + (bank)*0x0800, 0x0000 + (bank)*0x0800 + 0x0800, AIRCOPY_WRITE_STRUCT }, \
     { 0x4000 + (bank)*0x0800, 0x4000 + (bank)*0x0800 + 0x0800, AIRCOPY_WRITE_STRUCT }, \
-    { 0x8000 + (bank)*0x0100, 0x8000 + (bank)*0x0100 + 0x0100, AIRCOPY_WRITE_BYTES  }, \
 }
 
 #define AIRCOPY_STD_MAP(seg_array) \
@@ -132,17 +146,114 @@ const AIRCOPY_TransferMap_t* AIRCOPY_GetCurrentMap(void)
     return AIRCOPY_AvailableMaps[gAircopyCurrentMapIndex];
 }
 
+// ============================================================================
+// Block bookkeeping
+// ============================================================================
+
+// One bit per block of the current map: received (RX side), or sent and not
+// reported missing (TX side). The TX side replaces it with the receiver's
+// copy from each status frame, so only the blocks still clear get resent.
+static uint8_t  *AircopyBlocks;
+
+static uint16_t AircopyCursor;          // TX: next block to look at this round
+static uint8_t  AircopyPhase;
+static uint8_t  AircopyCountdown_10ms;
+static uint8_t  AircopyGap_10ms;        // TX: pause between data frames
+static uint8_t  AircopyRound;
+static uint8_t  AircopyPolls;           // TX: unanswered polls in a row
+static uint16_t AircopySent;            // TX: data frames sent this round
+static uint16_t AircopyIdle_10ms;       // RX: time since the last frame
+
+enum {
+    AIRCOPY_TX_DATA = 0,    // sending the blocks still missing
+    AIRCOPY_TX_POLL,        // asking the receiver what it has
+    AIRCOPY_TX_WAIT,        // listening for its status frame
+    AIRCOPY_RX_DATA,        // receiving
+    AIRCOPY_RX_STATUS,      // polled, status frame due
+};
+
+void AIRCOPY_Init(void)
+{
+    AIRCOPY_Scratch_t *pScratch;
+
+    PY25Q16_Flush();
+
+    // a boot mode, nothing has taken the region yet and it is kept until
+    // the radio is switched off
+    pScratch = SCRATCH_Acquire(SCRATCH_AIRCOPY, sizeof(*pScratch));
+
+    g_FSK_Buffer  = pScratch->FSK;
+    AircopyBlocks = pScratch->Blocks;
+}
+
 static void AIRCOPY_clear()
 {
-    for (uint8_t i = 0; i < 15; i++)
-    {
-        crc[i] = 0;
-    }
+    memset(AircopyBlocks, 0, AIRCOPY_MAX_BLOCKS / 8);
     #ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
         SCREENSHOT_Update(true);
     #endif
 }
 
+static bool AIRCOPY_TestBlock(uint16_t Block)
+{
+    return (AircopyBlocks[Block / 8] >> (Block % 8)) & 1u;
+}
+
+static void AIRCOPY_MarkBlock(uint16_t Block)
+{
+    if (!AIRCOPY_TestBlock(Block)) {
+        AircopyBlocks[Block / 8] |= 1u << (Block % 8);
+        gAirCopyBlockNumber++;
+    }
+}
+
+bool AIRCOPY_IsBlockDone(uint16_t Block)
+{
+    return Block < AIRCOPY_MAX_BLOCKS && AIRCOPY_TestBlock(Block);
+}
+
+// Blocks are numbered in map order, a segment not a multiple of 64 bytes
+// long still takes a whole block at its end.
+static uint16_t AIRCOPY_BlockOffset(uint16_t Block)
+{
+    const AIRCOPY_TransferMap_t *map = AIRCOPY_GetCurrentMap();
+
+    for (uint16_t i = 0; i < map->num_segments; i++)
+    {
+        const AIRCOPY_Segment_t *seg = &map->segments[i];
+        const uint16_t Blocks = (seg->end_offset - seg->start_offset + AIRCOPY_BLOCK_SIZE - 1) / AIRCOPY_BLOCK_SIZE;
+
+        if (Block < Blocks)
+            return seg->start_offset + Block * AIRCOPY_BLOCK_SIZE;
+
+        Block -= Blocks;
+    }
+
+    return AIRCOPY_FRAME_NONE;
+}
+
+static uint16_t AIRCOPY_BlockIndex(uint16_t Offset)
+{
+    const AIRCOPY_TransferMap_t *map = AIRCOPY_GetCurrentMap();
+    uint16_t Block = 0;
+
+    for (uint16_t i = 0; i < map->num_segments; i++)
+    {
+        const AIRCOPY_Segment_t *seg = &map->segments[i];
+        const uint16_t Blocks = (seg->end_offset - seg->start_offset + AIRCOPY_BLOCK_SIZE - 1) / AIRCOPY_BLOCK_SIZE;
+
+        if (Offset >= seg->start_offset && Offset < seg->end_offset) {
+            if ((Offset - seg->start_offset) % AIRCOPY_BLOCK_SIZE)
+                break;
+            return Block + (Offset - seg->start_offset) / AIRCOPY_BLOCK_SIZE;
+        }
+
+        Block += Blocks;
+    }
+
+    return AIRCOPY_FRAME_NONE;
+}
+
 static inline const AIRCOPY_Segment_t *AIRCOPY_FindSegmentForOffset(uint16_t off)
 {
     const AIRCOPY_TransferMap_t *map = AIRCOPY_GetCurrentMap();
@@ -158,18 +269,73 @@ static inline const AIRCOPY_Segment_t *AIRCOPY_FindSegmentForOffset(uint16_t off
     return NULL;
 }
 
-static inline void AIRCOPY_CheckComplete(void)
+// A frequency or name block holds 4 channel records and is only worth
+// sending when one of those channels is in use
+static bool AIRCOPY_IsChannelBlockEmpty(uint16_t Offset)
+{
+    ChannelAttributes_t Att[AIRCOPY_BLOCK_SIZE / AIRCOPY_CHANNEL_SIZE];
+    const uint16_t Channel = (Offset % AIRCOPY_CHANNEL_AREA) / AIRCOPY_CHANNEL_SIZE;
+
+    EEPROM_ReadBuffer(AIRCOPY_ATTR_BASE + Channel * sizeof(Att[0]), Att, sizeof(Att));
+
+    for (unsigned int i = 0; i < ARRAY_SIZE(Att); i++) {
+        if (Att[i].band <= BAND7_470MHz)
+            return false;
+    }
+
+    return true;
+}
+
+// TX: empty channel blocks count as done from the start
+static void AIRCOPY_SkipEmptyBlocks(void)
 {
     const AIRCOPY_TransferMap_t *map = AIRCOPY_GetCurrentMap();
-    uint16_t done = gAirCopyBlockNumber + gErrorsDuringAirCopy;
 
-    if (done >= map->total_blocks)
+    for (uint16_t i = 0; i < map->total_blocks; i++)
+    {
+        const uint16_t Offset = AIRCOPY_BlockOffset(i);
+        const AIRCOPY_Segment_t *seg = AIRCOPY_FindSegmentForOffset(Offset);
+
+        if (seg != NULL && seg->write_mode == AIRCOPY_WRITE_STRUCT && AIRCOPY_IsChannelBlockEmpty(Offset))
+            AIRCOPY_MarkBlock(i);
+    }
+}
+
+// RX: with the attributes of 32 channels stored, erase the frequency and
+// name blocks the sender is going to skip
+static void AIRCOPY_EraseEmptyBlocks(uint16_t AttrOffset)
+{
+    static const uint8_t Erased[AIRCOPY_BLOCK_SIZE] = { [0 ... AIRCOPY_BLOCK_SIZE - 1] = 0xFF };
+    const uint16_t First = (AttrOffset - AIRCOPY_ATTR_BASE) / sizeof(ChannelAttributes_t);
+    const uint16_t Count = AIRCOPY_BLOCK_SIZE / sizeof(ChannelAttributes_t);
+    const uint16_t PerBlock = AIRCOPY_BLOCK_SIZE / AIRCOPY_CHANNEL_SIZE;
+
+    for (uint16_t Channel = First; Channel < First + Count; Channel += PerBlock)
     {
-        gAircopyState = AIRCOPY_COMPLETE;
+        for (uint16_t Area = 0; Area < 2; Area++)
+        {
+            const uint16_t Offset = Area * AIRCOPY_CHANNEL_AREA + Channel * AIRCOPY_CHANNEL_SIZE;
+            const uint16_t Block = AIRCOPY_BlockIndex(Offset);
+
+            if (Block >= AIRCOPY_GetCurrentMap()->total_blocks || AIRCOPY_TestBlock(Block))
+                continue;
+
+            if (AIRCOPY_IsChannelBlockEmpty(Offset)) {
+                for (unsigned int i = 0; i < sizeof(Erased); i += 8)
+                    EEPROM_WriteBuffer(Offset + i, Erased + i);
+                AIRCOPY_MarkBlock(Block);
+            }
+        }
+    }
+}
+
+static void AIRCOPY_Complete(void)
+{
+    gAircopyState = AIRCOPY_COMPLETE;
+    PY25Q16_Flush();
 #ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
-        SCREENSHOT_Update(false);
+    SCREENSHOT_Update(false);
 #endif
-    }
 }
 
 static inline void AIRCOPY_Obfuscation(void)
@@ -183,66 +349,173 @@ static inline void AIRCOPY_Obfuscation(void)
 // Send/Receive Functions
 // ============================================================================
 
-bool AIRCOPY_SendMessage(void)
+static void AIRCOPY_EnterRx(void)
 {
-    static uint8_t gAircopySendCountdown = 1;
-    static uint16_t CurrentOffset = 0;
-    static uint16_t CurrentSegmentIndex = 0;
+    RADIO_SetupRegisters(true);
+    BK4819_SetupAircopy();
+    gFSKWriteIndex = 0;
+    BK4819_PrepareFSKReceive();
+}
 
-    if (gAircopyState != AIRCOPY_TRANSFER) {
-        return 1;
-    }
+// Frame: 0xABCD, offset (or AIRCOPY_FRAME_*), 64 bytes, CRC, 0xDCBA;
+// the payload is filled in by the caller
+static void AIRCOPY_SendFrame(uint16_t Offset)
+{
+    g_FSK_Buffer[0]  = 0xABCD;
+    g_FSK_Buffer[1]  = Offset;
+    g_FSK_Buffer[34] = CRC_Calculate(&g_FSK_Buffer[1], 2 + 64);
+    g_FSK_Buffer[35] = 0xDCBA;
 
-    if (--gAircopySendCountdown) {
-        return 1;
-    }
+    AIRCOPY_Obfuscation();
 
+    RADIO_SetTxParameters();
+
+    BK4819_SendFSKData(g_FSK_Buffer);
+    BK4819_SetupPowerAmplifier(0, 0);
+    BK4819_ToggleGpioOut(BK4819_GPIO1_PIN29_PA_ENABLE, false);
+}
+
+static void AIRCOPY_StartRound(void)
+{
+    AircopyPhase  = AIRCOPY_TX_DATA;
+    AircopyCursor = 0;
+    AircopySent   = 0;
+    AircopyPolls  = 0;
+    AircopyRound++;
+}
+
+static bool AIRCOPY_SendNextBlock(void)
+{
     const AIRCOPY_TransferMap_t *map = AIRCOPY_GetCurrentMap();
 
-    // Initialize on first call
-    if (gAirCopyBlockNumber == 0) {
-        CurrentSegmentIndex = 0;
-        CurrentOffset = map->segments[0].start_offset;
+    while (AircopyCursor < map->total_blocks && AIRCOPY_TestBlock(AircopyCursor))
+        AircopyCursor++;
+
+    if (AircopyCursor >= map->total_blocks)
+        return false;
+
+    const uint16_t Offset = AIRCOPY_BlockOffset(AircopyCursor);
+
+    EEPROM_ReadBuffer(Offset, &g_FSK_Buffer[2], 64);
+    AIRCOPY_SendFrame(Offset);
+
+    AIRCOPY_MarkBlock(AircopyCursor);
+    AircopyCursor++;
+    AircopySent++;
+    return true;
+}
+
+static void AIRCOPY_HandleStatus(void)
+{
+    const AIRCOPY_TransferMap_t *map = AIRCOPY_GetCurrentMap();
+    uint16_t Missing = 0;
+
+    memcpy(AircopyBlocks, &g_FSK_Buffer[2], AIRCOPY_MAX_BLOCKS / 8);
+
+    // it may not have the attributes telling it what to skip yet
+    AIRCOPY_SkipEmptyBlocks();
+
+    gAirCopyBlockNumber = 0;
+    for (uint16_t i = 0; i < map->total_blocks; i++) {
+        if (AIRCOPY_TestBlock(i))
+            gAirCopyBlockNumber++;
+        else
+            Missing++;
     }
 
-    // Advance to next segment if current is done
-    while (CurrentSegmentIndex < map->num_segments &&
-           CurrentOffset >= map->segments[CurrentSegmentIndex].end_offset)
-    {
-        CurrentSegmentIndex++;
-        if (CurrentSegmentIndex < map->num_segments) {
-            CurrentOffset = map->segments[CurrentSegmentIndex].start_offset;
-        }
+    if (Missing == 0 || AircopyRound >= AIRCOPY_MAX_ROUNDS) {
+        AIRCOPY_Complete();
+        return;
     }
 
-    // Check if transfer is complete
-    if (CurrentSegmentIndex >= map->num_segments) {
-        gAircopyState = AIRCOPY_COMPLETE;
-        #ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
-            SCREENSHOT_Update(false);
-        #endif
-        return 0;
+    // back off when more than 1 in 8 got lost, speed up on a clean round
+    if (Missing * 8 > AircopySent)
+        AircopyGap_10ms = MIN(AircopyGap_10ms * 2, AIRCOPY_GAP_MAX_10ms);
+    else
+    if (Missing * 32 < AircopySent)
+        AircopyGap_10ms = MAX(AircopyGap_10ms / 2, AIRCOPY_GAP_MIN_10ms);
+
+    AIRCOPY_StartRound();
+    AircopyCountdown_10ms = AircopyGap_10ms;
+}
+
+// Called every 10 ms during a transfer, returns 0 when a frame went out
+bool AIRCOPY_SendMessage(void)
+{
+    if (gAircopyState != AIRCOPY_TRANSFER) {
+        return 1;
     }
 
-    // Send data from current offset
-    g_FSK_Buffer[1] = CurrentOffset;
-    EEPROM_ReadBuffer(CurrentOffset, &g_FSK_Buffer[2], 64);
+    if (!gAirCopyIsSendMode)
+    {
+        if (AircopyPhase == AIRCOPY_RX_STATUS) {
+            if (--AircopyCountdown_10ms)
+                return 1;
 
-    g_FSK_Buffer[34] = CRC_Calculate(&g_FSK_Buffer[1], 2 + 64);
+            const bool Done = gAirCopyBlockNumber >= AIRCOPY_GetCurrentMap()->total_blocks;
 
-    AIRCOPY_Obfuscation();
+            memset(&g_FSK_Buffer[2], 0, 64);
+            memcpy(&g_FSK_Buffer[2], AircopyBlocks, AIRCOPY_MAX_BLOCKS / 8);
+            AIRCOPY_SendFrame(AIRCOPY_FRAME_STATUS);
 
-    RADIO_SetTxParameters();
+            if (Done) {
+                AIRCOPY_Complete();
+                return 0;
+            }
 
-    BK4819_SendFSKData(g_FSK_Buffer);
-    BK4819_SetupPowerAmplifier(0, 0);
-    BK4819_ToggleGpioOut(BK4819_GPIO1_PIN29_PA_ENABLE, false);
+            AircopyPhase     = AIRCOPY_RX_DATA;
+            AircopyIdle_10ms = 1;
+            AIRCOPY_EnterRx();
+            return 0;
+        }
+
+        // the sender went quiet (or is a v1 radio, which never polls)
+        if (AircopyIdle_10ms && ++AircopyIdle_10ms > AIRCOPY_RX_IDLE_10ms) {
+            AIRCOPY_Complete();
+            return 0;
+        }
+
+        return 1;
+    }
+
+    if (AircopyCountdown_10ms && --AircopyCountdown_10ms) {
+        return 1;
+    }
 
-    CurrentOffset += 64;
-    gAirCopyBlockNumber++;
-    gAircopySendCountdown = 30;
+    switch (AircopyPhase)
+    {
+        case AIRCOPY_TX_DATA:
+            if (AIRCOPY_SendNextBlock()) {
+                AircopyCountdown_10ms = AircopyGap_10ms;
+                return 0;
+            }
+            AircopyPhase = AIRCOPY_TX_POLL;
+            [[fallthrough]];
+
+        case AIRCOPY_TX_POLL:
+            memset(&g_FSK_Buffer[2], 0, 64);
+            AIRCOPY_SendFrame(AIRCOPY_FRAME_POLL);
+            AIRCOPY_EnterRx();
+            AircopyPhase          = AIRCOPY_TX_WAIT;
+            AircopyCountdown_10ms = AIRCOPY_STATUS_WAIT_10ms;
+            return 0;
+
+        default:
+        case AIRCOPY_TX_WAIT:
+            // no answer; after a few tries assume a v1 receiver and stop
+            if (++AircopyPolls >= AIRCOPY_MAX_POLLS) {
+                AIRCOPY_Complete();
+                return 0;
+            }
+            AircopyPhase = AIRCOPY_TX_POLL;
+            AircopyCountdown_10ms = 1;
+            return 1;
+    }
+}
 
-    return 0;
+bool AIRCOPY_IsReceiving(void)
+{
+    return !gAirCopyIsSendMode || AircopyPhase == AIRCOPY_TX_WAIT;
 }
 
 void AIRCOPY_StorePacket(void)
@@ -256,13 +529,14 @@ void AIRCOPY_StorePacket(void)
     uint16_t Status = BK4819_ReadRegister(BK4819_REG_0B);
     BK4819_PrepareFSKReceive();
 
+    if (!gAirCopyIsSendMode)
+        AircopyIdle_10ms = 1;   // heard something, (re)start the idle timer
+
     if ((Status & 0x0010U) != 0 || g_FSK_Buffer[0] != 0xABCD || g_FSK_Buffer[35] != 0xDCBA) {
         gErrorsDuringAirCopy++;
 
         BK4819_ResetFSK();           // <- important
         BK4819_PrepareFSKReceive();  // <- re-arm proprement
-
-        AIRCOPY_CheckComplete();
         return;
     }
 
@@ -271,20 +545,36 @@ void AIRCOPY_StorePacket(void)
     uint16_t Crc = CRC_Calculate(&g_FSK_Buffer[1], 2 + 64);
     if (g_FSK_Buffer[34] != Crc) {
         gErrorsDuringAirCopy++;
-        AIRCOPY_CheckComplete();
         return;
     }
 
     uint16_t Offset = g_FSK_Buffer[1];
 
+    if (gAirCopyIsSendMode) {
+        if (Offset == AIRCOPY_FRAME_STATUS && AircopyPhase == AIRCOPY_TX_WAIT)
+            AIRCOPY_HandleStatus();
+        return;
+    }
+
+    if (Offset == AIRCOPY_FRAME_POLL) {
+        // give the sender time to turn around before answering
+        AircopyPhase          = AIRCOPY_RX_STATUS;
+        AircopyCountdown_10ms = AIRCOPY_TURNAROUND_10ms;
+        return;
+    }
+
     const AIRCOPY_Segment_t *seg = AIRCOPY_FindSegmentForOffset(Offset);
-    
-    if (seg == NULL) {
+    const uint16_t Block = AIRCOPY_BlockIndex(Offset);
+
+    if (seg == NULL || Block >= AIRCOPY_GetCurrentMap()->total_blocks) {
         gErrorsDuringAirCopy++;
-        AIRCOPY_CheckComplete();
         return;
     }
 
+    if (AIRCOPY_TestBlock(Block)) {
+        return;     // a repeat, we have it already
+    }
+
     if (seg->write_mode == AIRCOPY_WRITE_BYTES)
     {
         /* Raw bytes stream, written in 8-byte EEPROM chunks */
@@ -308,8 +598,12 @@ void AIRCOPY_StorePacket(void)
         }
     }
 
-    gAirCopyBlockNumber++;
-    AIRCOPY_CheckComplete();
+    AIRCOPY_MarkBlock(Block);
+
+    Offset = AIRCOPY_BlockOffset(Block);
+    if (Offset >= AIRCOPY_ATTR_BASE && Offset < AIRCOPY_ATTR_BASE + MR_CHANNELS_MAX * sizeof(ChannelAttributes_t)) {
+        AIRCOPY_EraseEmptyBlocks(Offset);
+    }
 }
 
 static void AIRCOPY_InitTransfer(bool isSendMode)
@@ -317,11 +611,24 @@ static void AIRCOPY_InitTransfer(bool isSendMode)
     gAircopyStep = 1;
     gFSKWriteIndex = 0;
     gAirCopyBlockNumber = 0;
+    gErrorsDuringAirCopy = 0;
     gInputBoxIndex = 0;
     gAirCopyIsSendMode = isSendMode;
 
     AIRCOPY_clear();
-    
+
+    AircopyRound          = 0;
+    AircopyGap_10ms       = AIRCOPY_GAP_MIN_10ms;
+    AircopyCountdown_10ms = 1;
+    AircopyIdle_10ms      = 0;
+
+    if (isSendMode) {
+        AIRCOPY_SkipEmptyBlocks();
+        AIRCOPY_StartRound();
+    }
+    else
+        AircopyPhase = AIRCOPY_RX_DATA;
+
     gAircopyState = AIRCOPY_TRANSFER;
 }
 
@@ -373,7 +680,6 @@ static void AIRCOPY_Key_EXIT()
 {
     if (gInputBoxIndex == 0) {
         AIRCOPY_InitTransfer(0); // Mode: Receive
-        gErrorsDuringAirCopy = lErrorsDuringAirCopy = 0;
 
         BK4819_PrepareFSKReceive();
         
@@ -385,10 +691,6 @@ static void AIRCOPY_Key_EXIT()
 static void AIRCOPY_Key_MENU()
 {
     AIRCOPY_InitTransfer(1); // Mode: Send
-    
-    g_FSK_Buffer[0] = 0xABCD;
-    g_FSK_Buffer[1] = 0;
-    g_FSK_Buffer[35] = 0xDCBA;
 }
 
 static void AIRCOPY_Key_UP_DOWN(int8_t Direction)
@@ -29,8 +29,33 @@
 #define AIRCOPY_CHANNELS_PER_BANK    128
 #define AIRCOPY_NUM_BANKS            MR_CHANNELS_MAX / AIRCOPY_CHANNELS_PER_BANK
 #define AIRCOPY_CHANNEL_SIZE         16       // bytes per channel (freq/name)
+#define AIRCOPY_CHANNEL_AREA         0x4000u  // Freq at 0x0000, Name at 0x4000
+#define AIRCOPY_ATTR_BASE            0x8000u  // 2 bytes per channel
 #define AIRCOPY_BANK_SIZE_BYTES      0x1080u  // 0x800 (Freq) + 0x800 (Name) + 0x80 (Attr)
 #define AIRCOPY_BAR_WIDTH            120      // Visible width of the progress gauge
+#define AIRCOPY_MAX_BLOCKS           128      // Block bitmap size, the largest map has 68
+
+// ============================================================================
+// Protocol v2
+// ============================================================================
+
+/*
+ * Data frames are the v1 ones. After each pass the sender polls, the
+ * receiver answers with a status frame holding its block bitmap, and the
+ * sender goes round again with only the blocks still missing. The pause
+ * between data frames follows the loss seen in the last round.
+ */
+#define AIRCOPY_FRAME_NONE           0xFFFFu  // not a block offset
+#define AIRCOPY_FRAME_POLL           0xFFFEu  // in place of the offset
+#define AIRCOPY_FRAME_STATUS         0xFFFDu
+
+#define AIRCOPY_GAP_MIN_10ms         5        // v1 used a fixed 30
+#define AIRCOPY_GAP_MAX_10ms         30
+#define AIRCOPY_MAX_ROUNDS           8
+#define AIRCOPY_MAX_POLLS            3
+#define AIRCOPY_STATUS_WAIT_10ms     150      // poll to status frame
+#define AIRCOPY_TURNAROUND_10ms      20       // poll end to status frame start
+#define AIRCOPY_RX_IDLE_10ms         500      // receiver gives up on silence
 
 // ============================================================================
 // Segment write mode
@@ -94,14 +119,17 @@ extern uint16_t        gAirCopyBlockNumber;
 extern uint16_t        gErrorsDuringAirCopy;
 extern uint8_t         gAirCopyIsSendMode;
 
-extern uint16_t        g_FSK_Buffer[36];
+extern uint16_t       *g_FSK_Buffer;     // 36 words, valid after AIRCOPY_Init()
 
 // ============================================================================
 // API
 // ============================================================================
 
+void AIRCOPY_Init(void);
 bool AIRCOPY_SendMessage(void);
+bool AIRCOPY_IsReceiving(void);
 void AIRCOPY_StorePacket(void);
+bool AIRCOPY_IsBlockDone(uint16_t Block);
 void AIRCOPY_ProcessKeys(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld);
 
 const AIRCOPY_TransferMap_t* AIRCOPY_GetCurrentMap(void);
@@ -36,6 +36,7 @@
 #include "app/generic.h"
 #include "app/main.h"
 #include "app/menu.h"
+#include "app/priority.h"
 #include "app/scanner.h"
 #if defined(ENABLE_UART) || defined(ENABLE_USB)
     #include "app/uart.h"
@@ -54,13 +55,18 @@
 #include "driver/bk4819.h"
 #include "driver/gpio.h"
 #include "driver/keyboard.h"
+#include "driver/py25q16.h"
 #include "driver/st7565.h"
 #include "driver/system.h"
+#ifdef ENABLE_USB
+    #include "driver/vcp.h"
+#endif
 #include "dtmf.h"
 #include "external/printf/printf.h"
 #include "frequencies.h"
 #include "functions.h"
 #include "helper/battery.h"
+#include "helper/rssi.h"
 #include "misc.h"
 #include "radio.h"
 #include "settings.h"
@@ -178,6 +184,11 @@ static void CheckForIncoming(void)
         FUNCTION_Select(FUNCTION_INCOMING);
         //gUpdateDisplay = true;
     }
+
+#ifdef ENABLE_SCAN_CSS_SKIP
+    if (gScanStateDir != SCAN_OFF)
+        CHFRSCANNER_CssHit();
+#endif
 }
 
 static void HandleIncoming(void)
@@ -191,6 +202,9 @@ static void HandleIncoming(void)
             FUNCTION_Select(FUNCTION_FOREGROUND);
             gUpdateDisplay = true;
         }
+#ifdef ENABLE_SCAN_CSS_SKIP
+        CHFRSCANNER_CssCarrierLost();
+#endif
         return;
     }
 
@@ -643,7 +657,12 @@ static void DualwatchAlternate(void)
         }
     }
 
-    RADIO_SetupRegisters(false);
+    #ifdef ENABLE_NOAA
+        if (gIsNoaaMode)
+            RADIO_SetupRegisters(false);    // the NOAA channel moves on every pass
+        else
+    #endif
+            RADIO_SwitchRxVfo();
 
     #ifdef ENABLE_NOAA
         gDualWatchCountdown_10ms = gIsNoaaMode ? dual_watch_count_noaa_10ms : dual_watch_count_toggle_10ms;
@@ -712,15 +731,8 @@ static void CheckRadioInterrupts(void)
 
 #ifdef ENABLE_DTMF_CALLING
                     if (gRxVfo->DTMF_DECODING_ENABLE || gSetting_KILLED) {
-                        if (gDTMF_RX_index >= sizeof(gDTMF_RX) - 1) { // make room
-                            memmove(&gDTMF_RX[0], &gDTMF_RX[1], sizeof(gDTMF_RX) - 1);
-                            gDTMF_RX_index--;
-                        }
-                        gDTMF_RX[gDTMF_RX_index++] = c;
-                        gDTMF_RX[gDTMF_RX_index]   = 0;
-                        gDTMF_RX_timeout           = DTMF_RX_timeout_500ms;  // time till we delete it
-                        gDTMF_RX_pending           = true;
-                        
+                        DTMF_RX_Append(c);
+
                         SYSTEM_DelayMs(3);//fix DTMF not reply@Yurisu
                         DTMF_HandleRequest();
                     }
@@ -746,6 +758,11 @@ static void CheckRadioInterrupts(void)
         if (interrupts.ctcssFound)
             g_CTCSS_Lost = false;
 
+#ifdef ENABLE_SCAN_CSS_SKIP
+        if (interrupts.cdcssLost && gScanStateDir != SCAN_OFF)
+            CHFRSCANNER_CssEvent();
+#endif
+
 #ifdef ENABLE_VOX
         if (interrupts.voxLost) {
             g_VOX_Lost         = true;
@@ -788,7 +805,7 @@ static void CheckRadioInterrupts(void)
         if (interrupts.fskFifoAlmostFull &&
             gScreenToDisplay == DISPLAY_AIRCOPY &&
             gAircopyState == AIRCOPY_TRANSFER &&
-            gAirCopyIsSendMode == 0)
+            AIRCOPY_IsReceiving())
         {
             for (unsigned int i = 0; i < 4; i++) {
                 g_FSK_Buffer[gFSKWriteIndex++] = BK4819_ReadRegister(BK4819_REG_5F);
@@ -906,6 +923,10 @@ void APP_Update(void)
     }
 #endif
 
+#ifdef ENABLE_USB_DUAL_CDC
+    VCP_LogFlush();
+#endif
+
 #ifdef ENABLE_USB
     if (UART_IsCommandAvailable(UART_PORT_VCP)) {
         // SCHEDULER_Disable();
@@ -1055,6 +1076,9 @@ void APP_Update(void)
 #endif
 #ifdef ENABLE_DTMF_CALLING
         && gDTMF_CallState == DTMF_CALL_STATE_NONE
+#endif
+#ifdef ENABLE_PRIORITY_WATCH
+        && !PRIORITY_IsLooking()
 #endif
     ) {
         DualwatchAlternate();    // toggle between the two VFO's
@@ -1097,6 +1121,9 @@ void APP_Update(void)
 #endif
 #ifdef ENABLE_NOAA
             || (gIsNoaaMode && (IS_NOAA_CHANNEL(gEeprom.ScreenChannel[0]) || IS_NOAA_CHANNEL(gEeprom.ScreenChannel[1])))
+#endif
+#ifdef ENABLE_PRIORITY_WATCH
+            || PRIORITY_IsActive()
 #endif
         ) {
             gBatterySaveCountdown_10ms = battery_save_count_10ms;
@@ -1108,6 +1135,7 @@ void APP_Update(void)
     }
 
     if (gPowerSaveCountdownExpired && gCurrentFunction == FUNCTION_POWER_SAVE
+        && !AUDIO_IsBeeping()
 #ifdef ENABLE_VOICE
         && gVoiceWriteIndex == 0
 #endif
@@ -1338,6 +1366,12 @@ void APP_TimeSlice10ms(void)
     gNextTimeslice = false;
 
     SETTINGS_SaveVfoIndicesFlush();
+    PY25Q16_TimeSlice10ms();
+#ifdef ENABLE_VOICE
+    AUDIO_VoiceStream();
+#endif
+    RSSI_TimeSlice10ms();
+    BK4819_ToneSeq_TimeSlice10ms();
 
     BACKLIGHT_Update();
 
@@ -1418,7 +1452,8 @@ void APP_TimeSlice10ms(void)
 
     if (gCurrentFunction == FUNCTION_TRANSMIT) {
 #ifdef ENABLE_ALARM
-        if (gAlarmState == ALARM_STATE_TXALARM || gAlarmState == ALARM_STATE_SITE_ALARM) {
+        if ((gAlarmState == ALARM_STATE_TXALARM || gAlarmState == ALARM_STATE_SITE_ALARM) &&
+            !BK4819_ToneSeq_IsBusy()) {  // not over the PTT-ID
             uint16_t Tone;
 
             gAlarmRunningCounter++;
@@ -1488,8 +1523,12 @@ void APP_TimeSlice10ms(void)
 
     SCANNER_TimeSlice10ms();
 
+#ifdef ENABLE_PRIORITY_WATCH
+    PRIORITY_TimeSlice10ms();
+#endif
+
 #ifdef ENABLE_AIRCOPY
-    if (gScreenToDisplay == DISPLAY_AIRCOPY && gAircopyState == AIRCOPY_TRANSFER && gAirCopyIsSendMode == 1) {
+    if (gScreenToDisplay == DISPLAY_AIRCOPY && gAircopyState == AIRCOPY_TRANSFER) {
         if (!AIRCOPY_SendMessage()) {
             GUI_DisplayScreen();
         }
@@ -1580,6 +1619,10 @@ void APP_TimeSlice500ms(void)
     // Skipped authentic device check
 
 #ifdef ENABLE_FMRADIO
+    // the BK1080 is powered down while the main receiver holds the audio
+    if (gFmRadioMode && gCurrentFunction == FUNCTION_FOREGROUND && gFM_RestoreCountdown_10ms == 0)
+        FM_CheckChannelTimeSlice500ms();
+
     if (gFmRadioCountdown_500ms > 0)
     {
         gFmRadioCountdown_500ms--;
@@ -1621,6 +1664,7 @@ void APP_TimeSlice500ms(void)
             // TODO:
             // PWM_PLUS0_CH0_COMP = 0;
             BACKLIGHT_SetBrightness(0);
+            PY25Q16_Flush();
             ST7565_ShutDown();
         }
         else if(gSleepModeCountdown_500ms != 0 && gSleepModeCountdown_500ms < 21 && gSetting_set_off != 0)
@@ -1655,6 +1699,7 @@ void APP_TimeSlice500ms(void)
 
         if (gBatteryCurrent > 500 || gBatteryCalibration[3] < gBatteryCurrentVoltage)
         {
+            PY25Q16_Flush();
             #ifdef ENABLE_OVERLAY
                 overlay_FLASH_RebootToBootloader();
             #else
@@ -1669,8 +1714,24 @@ void APP_TimeSlice500ms(void)
 
     // Skipped authentic device check
 
-    if (gCurrentFunction != FUNCTION_TRANSMIT)
+    // The ADC ring spans a few seconds, let the TX sag drain out of it first.
+    // After that, keep waiting while the ring still shows the battery
+    // climbing back (over 48 counts a minute, about three times the slope
+    // noise of 64 samples), up to 10 s in all.
+    static uint8_t BatteryHoldoff_500ms;
+    static uint8_t BatteryRecovery_500ms;
+
+    if (gCurrentFunction == FUNCTION_TRANSMIT) {
+        BatteryHoldoff_500ms  = 7;
+        BatteryRecovery_500ms = 13;
+    }
+    else if (BatteryHoldoff_500ms > 0)
+        BatteryHoldoff_500ms--;
+    else if (BatteryRecovery_500ms > 0 && BOARD_ADC_GetBatterySlope() > 48)
+        BatteryRecovery_500ms--;
+    else
     {
+        BatteryRecovery_500ms = 0;
 
         if ((gBatteryCheckCounter & 1) == 0)
         {
@@ -2047,6 +2108,9 @@ static void ProcessKey(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
                 goto Skip;
             }
 
+            if (BK4819_ToneSeq_IsBusy()) // PTT-ID still going out
+                goto Skip;
+
             if (Key == KEY_SIDE2) { // transmit 1750Hz tone
                 Code = 0xFE;
             }
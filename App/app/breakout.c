@@ -15,6 +15,8 @@
  */
 
 #include "app/breakout.h"
+#include "driver/py25q16.h"
+#include "helper/scratch.h"
 
 #ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
 #include "screenshot.h"
@@ -38,7 +40,9 @@ char str[12];
 
 static KeyboardState kbd = {KEY_INVALID, KEY_INVALID, 0};
 
-Brick brick[BRICK_NUMBER];
+// in the scratch region while the game runs
+SCRATCH_CHECK(Brick[BRICK_NUMBER]);
+static Brick *brick;
 Racket racket;
 Ball ball;
 
@@ -452,7 +456,16 @@ void APP_RunBreakout(void) {
         // Finish the brightness fade if it is in progress
         BACKLIGHT_UpdateTickless();
 
+        // The game loop pumps neither the flash write-behind nor the tone
+        // sequencer: finish both now
+        PY25Q16_Flush();
+        AUDIO_BeepWait();
+
         // Init game
+        brick = SCRATCH_Acquire(SCRATCH_BREAKOUT, sizeof(Brick) * BRICK_NUMBER);
+        if (brick == NULL)
+            return;
+
         UI_DisplayClear();
         reset();
         initWall();
@@ -499,4 +512,9 @@ void APP_RunBreakout(void) {
                 }
             #endif
         }
+
+        SCRATCH_Release(SCRATCH_BREAKOUT);
+        brick = NULL;
+
+        PY25Q16_Flush();
 }
\ No newline at end of file
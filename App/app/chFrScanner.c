@@ -1,9 +1,15 @@
 
+#include <string.h>
+
 #include "app/app.h"
 #include "app/chFrScanner.h"
+#include "dcs.h"
 #include "functions.h"
 #include "misc.h"
 #include "settings.h"
+#ifdef ENABLE_SCAN_CSS_REPORT
+    #include "external/printf/printf.h"
+#endif
 //#include "debugging.h"
 
 int8_t            gScanStateDir;
@@ -37,6 +43,63 @@ uint8_t             initialCROSS_BAND_RX_TX;
 static void NextFreqChannel(void);
 static void NextMemChannel(void);
 
+#ifdef ENABLE_SCAN_CSS_SKIP
+ScanCssStats_t      gScanCssStats;
+
+// A memory channel with tone squelch whose squelch has opened: the CxCSS
+// detector armed by RADIO_SetupRegisters() on the hop has until the scan
+// pause runs out to report the expected code
+static bool         cssHitPending;
+
+static bool IsCssChannel(void)
+{
+    return gScanStateDir != SCAN_OFF && IS_MR_CHANNEL(gNextMrChannel) && gCurrentCodeType != CODE_TYPE_OFF;
+}
+
+static void CssReject(ScanCssReject_t reason)
+{
+    // a detector event can also come in before the squelch has opened
+    const uint16_t dwell = !cssHitPending ? 0 :
+        scan_pause_delay_in_3_10ms - MIN(gScanPauseDelayIn_10ms, scan_pause_delay_in_3_10ms);
+
+    cssHitPending = false;
+
+    gScanCssStats.Count[reason]++;
+    gScanCssStats.Time_10ms += dwell;
+    if (dwell > gScanCssStats.TimeMax_10ms)
+        gScanCssStats.TimeMax_10ms = dwell;
+
+    // hop on the next pass of the main loop
+    gScanPauseDelayIn_10ms = 0;
+    gScheduleScanListen    = true;
+}
+
+void CHFRSCANNER_CssHit(void)
+{
+    cssHitPending = IsCssChannel();
+}
+
+// Called from the BK4819 interrupt handling once the CxCSS detector armed
+// on the hop has reported, whether or not the squelch has opened yet
+void CHFRSCANNER_CssEvent(void)
+{
+    if (!IsCssChannel())
+        return;
+
+    if ((gCurrentCodeType == CODE_TYPE_DIGITAL || gCurrentCodeType == CODE_TYPE_REVERSE_DIGITAL) &&
+        g_CDCSS_Lost && gCDCSSCodeType == CDCSS_NEGATIVE_CODE)
+    {
+        CssReject(SCAN_CSS_REJECT_POLARITY);
+    }
+}
+
+void CHFRSCANNER_CssCarrierLost(void)
+{
+    if (cssHitPending && IsCssChannel())
+        CssReject(SCAN_CSS_REJECT_CARRIER);
+}
+#endif
+
 #if defined(ENABLE_FEAT_F4HWN_RESUME_STATE) || defined(ENABLE_SCAN_RANGES)
     void CHFRSCANNER_ScanRange(void) {
         gScanRangeStart = gScanRangeStart ? 0 : gTxVfo->pRX->Frequency;
@@ -52,7 +115,15 @@ void CHFRSCANNER_Start(const bool storeBackupSettings, const int8_t scan_directi
         initialCROSS_BAND_RX_TX = gEeprom.CROSS_BAND_RX_TX;
         gEeprom.CROSS_BAND_RX_TX = CROSS_BAND_OFF;
         gScanKeepResult = false;
+
+#ifdef ENABLE_SCAN_CSS_SKIP
+        memset(&gScanCssStats, 0, sizeof(gScanCssStats));
+#endif
     }
+
+#ifdef ENABLE_SCAN_CSS_SKIP
+    cssHitPending = false;
+#endif
     
     RADIO_SelectVfos();
 
@@ -126,6 +197,11 @@ void CHFRSCANNER_ContinueScanning(void)
     }
     else
     {
+#ifdef ENABLE_SCAN_CSS_SKIP
+        if (gCurrentFunction == FUNCTION_INCOMING && cssHitPending)
+            CssReject(SCAN_CSS_REJECT_TIMEOUT);
+        cssHitPending = false;
+#endif
         IS_FREQ_CHANNEL(gNextMrChannel) ? NextFreqChannel() : NextMemChannel();
     }
 
@@ -136,6 +212,10 @@ void CHFRSCANNER_ContinueScanning(void)
 
 void CHFRSCANNER_Found(void)
 {
+#ifdef ENABLE_SCAN_CSS_SKIP
+    cssHitPending = false;
+#endif
+
     if (gEeprom.SCAN_RESUME_MODE > 80) {
         if (!gScanPauseMode) {
             gScanPauseDelayIn_10ms = scan_pause_delay_in_5_10ms * (gEeprom.SCAN_RESUME_MODE - 80) * 5;
@@ -209,6 +289,15 @@ void CHFRSCANNER_Stop(void)
     
     gScanStateDir = SCAN_OFF;
 
+#if defined(ENABLE_SCAN_CSS_SKIP) && defined(ENABLE_SCAN_CSS_REPORT)
+    printf("scan css: timeout %u polarity %u carrier %u, %lu ms total, %u ms max\n",
+        gScanCssStats.Count[SCAN_CSS_REJECT_TIMEOUT],
+        gScanCssStats.Count[SCAN_CSS_REJECT_POLARITY],
+        gScanCssStats.Count[SCAN_CSS_REJECT_CARRIER],
+        gScanCssStats.Time_10ms * 10,
+        gScanCssStats.TimeMax_10ms * 10);
+#endif
+
     const uint32_t chFr = gScanKeepResult ? lastFoundFrqOrChan : initialFrqOrChan;
     const bool channelChanged = chFr != initialFrqOrChan;
     if (IS_MR_CHANNEL(gNextMrChannel)) {
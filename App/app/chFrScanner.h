@@ -24,6 +24,27 @@ void CHFRSCANNER_ContinueScanning(void);
     void CHFRSCANNER_ScanRange(void);
 #endif
 
+#ifdef ENABLE_SCAN_CSS_SKIP
+    typedef enum {
+        SCAN_CSS_REJECT_TIMEOUT = 0,    // no code reported within the pause
+        SCAN_CSS_REJECT_POLARITY,       // DCS code seen with the wrong polarity
+        SCAN_CSS_REJECT_CARRIER,        // carrier dropped before the code was seen
+        SCAN_CSS_REJECT_NUM
+    } ScanCssReject_t;
+
+    typedef struct {
+        uint16_t Count[SCAN_CSS_REJECT_NUM];
+        uint32_t Time_10ms;             // dwell spent on rejected hits
+        uint16_t TimeMax_10ms;
+    } ScanCssStats_t;
+
+    extern ScanCssStats_t gScanCssStats;
+
+    void CHFRSCANNER_CssHit(void);
+    void CHFRSCANNER_CssEvent(void);
+    void CHFRSCANNER_CssCarrierLost(void);
+#endif
+
 #ifdef ENABLE_FEAT_F4HWN
     extern uint32_t lastFoundFrqOrChan;
     extern uint32_t lastFoundFrqOrChanOld;
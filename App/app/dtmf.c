@@ -68,15 +68,232 @@ bool              gDTMF_IsGroupCall;
 DTMF_ReplyState_t gDTMF_ReplyState;
 
 #ifdef ENABLE_DTMF_CALLING
+// Every sequence DTMF_HandleRequest() reacts to is matched as the digits
+// arrive, one shift-and automaton per pattern: bit i of State is set while
+// the last i + 1 received digits equal the first i + 1 pattern digits, so a
+// digit costs one table lookup and a shift per pattern. The patterns are
+// compiled from the settings at the first digit of each burst.
+typedef enum {
+    DTMF_MATCH_KILL = 0,
+    DTMF_MATCH_REVIVE,
+    DTMF_MATCH_ACK,         // "AB"
+    DTMF_MATCH_CALL_RSP,    // callee + separator + "AAAAA"
+    DTMF_MATCH_CALL,        // our ID + separator + any 3 digits
+    DTMF_MATCH_N
+} DTMF_Match_t;
+
+typedef struct {
+    uint16_t Mask[16];      // per received digit: pattern positions it fits
+    uint16_t Final;         // last position, 0 if the pattern can't match
+    bool     Group;         // the group call code fits any position
+    uint16_t State;
+    uint16_t GroupState;    // partial matches that used the group call code
+} DTMF_Pattern_t;
+
+static DTMF_Pattern_t DTMF_Patterns[DTMF_MATCH_N];
+static uint8_t        DTMF_Matched;         // one bit per DTMF_Match_t
+static uint8_t        DTMF_MatchedGroup;
+
+static int DTMF_DigitIndex(const char c)
+{
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'D') return c - 'A' + 10;
+    if (c == '*')             return 14;
+    if (c == '#')             return 15;
+    return -1;
+}
+
+// pattern = pA + Sep + pB, Sep 0 for none, '?' in pB fits any digit
+static void DTMF_CompilePattern(DTMF_Match_t Match, const char *pA, const char Sep, const char *pB, const bool Group)
+{
+    DTMF_Pattern_t *pPattern = &DTMF_Patterns[Match];
+    unsigned int    Len      = 0;
+
+    memset(pPattern, 0, sizeof(*pPattern));
+    pPattern->Group = Group;
+
+    for (unsigned int Part = 0; Part < 3; Part++)
+    {
+        const char *pPart = (Part == 0) ? pA : (Part == 2) ? pB : NULL;
+        const char  One[2] = { Sep, 0 };
+
+        if (Part == 1)
+            pPart = One;
+
+        for (; pPart != NULL && *pPart; pPart++, Len++)
+        {
+            if (Len >= 16)
+                return;     // longer than gDTMF_RX holds, never matched
+
+            if (*pPart == '?')
+            {
+                for (unsigned int i = 0; i < 16; i++)
+                    pPattern->Mask[i] |= 1u << Len;
+            }
+            else
+            {
+                const int i = DTMF_DigitIndex(*pPart);
+                if (i >= 0)
+                    pPattern->Mask[i] |= 1u << Len;
+            }
+        }
+    }
+
+    if (Len)
+        pPattern->Final = 1u << (Len - 1);
+}
+
+static void DTMF_CompilePatterns(void)
+{
+    DTMF_CompilePattern(DTMF_MATCH_KILL, gEeprom.ANI_DTMF_ID, gEeprom.DTMF_SEPARATE_CODE, gEeprom.KILL_CODE, true);
+    DTMF_CompilePattern(DTMF_MATCH_REVIVE, gEeprom.ANI_DTMF_ID, gEeprom.DTMF_SEPARATE_CODE, gEeprom.REVIVE_CODE, true);
+    DTMF_CompilePattern(DTMF_MATCH_ACK, "AB", 0, NULL, true);
+    DTMF_CompilePattern(DTMF_MATCH_CALL_RSP, gDTMF_String, gEeprom.DTMF_SEPARATE_CODE, "AAAAA", false);
+    DTMF_CompilePattern(DTMF_MATCH_CALL, gEeprom.ANI_DTMF_ID, gEeprom.DTMF_SEPARATE_CODE, "???", true);
+}
+
+static void DTMF_FeedPatterns(const char c)
+{
+    const int  i       = DTMF_DigitIndex(c);
+    const bool IsGroup = (c == gEeprom.DTMF_GROUP_CALL_CODE);
+
+    DTMF_Matched      = 0;
+    DTMF_MatchedGroup = 0;
+
+    for (unsigned int m = 0; m < DTMF_MATCH_N; m++)
+    {
+        DTMF_Pattern_t *pPattern = &DTMF_Patterns[m];
+        const uint16_t  Exact    = (i >= 0) ? pPattern->Mask[i] : 0;
+        const uint16_t  Any      = (IsGroup && pPattern->Group) ? 0xFFFF : 0;
+        const uint16_t  Next     = (pPattern->State << 1) | 1u;
+
+        pPattern->GroupState = ((pPattern->GroupState << 1) & (Exact | Any)) | (Next & Any & ~Exact);
+        pPattern->State      = Next & (Exact | Any);
+
+        if (pPattern->State & pPattern->Final)
+        {
+            DTMF_Matched |= 1u << m;
+            if (pPattern->GroupState & pPattern->Final)
+                DTMF_MatchedGroup |= 1u << m;
+        }
+    }
+}
+
 void DTMF_clear_RX(void)
 {
     gDTMF_RX_timeout = 0;
     gDTMF_RX_index   = 0;
     gDTMF_RX_pending = false;
     memset(gDTMF_RX, 0, sizeof(gDTMF_RX));
+
+    for (unsigned int m = 0; m < DTMF_MATCH_N; m++)
+    {
+        DTMF_Patterns[m].State      = 0;
+        DTMF_Patterns[m].GroupState = 0;
+    }
+    DTMF_Matched      = 0;
+    DTMF_MatchedGroup = 0;
+}
+
+void DTMF_RX_Append(const char c)
+{
+    if (gDTMF_RX_index == 0)
+        DTMF_CompilePatterns();
+
+    if (gDTMF_RX_index >= sizeof(gDTMF_RX) - 1) { // make room
+        memmove(&gDTMF_RX[0], &gDTMF_RX[1], sizeof(gDTMF_RX) - 1);
+        gDTMF_RX_index--;
+    }
+    gDTMF_RX[gDTMF_RX_index++] = c;
+    gDTMF_RX[gDTMF_RX_index]   = 0;
+    gDTMF_RX_timeout           = DTMF_RX_timeout_500ms;  // time till we delete it
+    gDTMF_RX_pending           = true;
+
+    DTMF_FeedPatterns(c);
 }
 #endif
 
+// tones of the DTMF string being sent, see DTMF_BuildSteps()
+static BK4819_ToneStep_t DTMF_TxSteps[23];
+static unsigned int      DTMF_TxCount;
+static BK4819_ToneStep_t DTMF_PreloadStep;
+static bool              DTMF_ReplyPending;
+static bool              DTMF_ReplySending;
+static void            (*DTMF_ReplyDone)(void);
+
+static unsigned int DTMF_BuildSteps(const char *pString, bool bDelayFirst)
+{
+    unsigned int Count = 0;
+
+    for (unsigned int i = 0; pString[i] && Count < ARRAY_SIZE(DTMF_TxSteps); i++)
+    {
+        BK4819_ToneStep_t *pStep = &DTMF_TxSteps[Count];
+        uint16_t           Persist;
+
+        if (!BK4819_GetDTMFTones(pString[i], &pStep->Tone1, &pStep->Tone2))
+            continue;
+
+        if (bDelayFirst && i == 0)
+            Persist = gEeprom.DTMF_FIRST_CODE_PERSIST_TIME;
+        else
+        if (pString[i] == '*' || pString[i] == '#')
+            Persist = gEeprom.DTMF_HASH_CODE_PERSIST_TIME;
+        else
+            Persist = gEeprom.DTMF_CODE_PERSIST_TIME;
+
+        pStep->On_10ms  = Persist / 10;
+        pStep->Off_10ms = gEeprom.DTMF_CODE_INTERVAL_TIME / 10;
+        Count++;
+    }
+
+    return Count;
+}
+
+static void DTMF_ReplySent(void)
+{
+    void (*Done)(void) = DTMF_ReplyDone;
+
+    DTMF_ReplyPending = false;
+    DTMF_ReplySending = false;
+    DTMF_ReplyDone    = NULL;
+
+    AUDIO_AudioPathOff();
+
+    gEnableSpeaker = false;
+
+    BK4819_ExitDTMF_TX(false);
+
+    if (Done)
+        Done();
+}
+
+static void DTMF_ReplyPreloaded(void)
+{
+    BK4819_EnterDTMF_TX(gEeprom.DTMF_SIDE_TONE);
+
+    DTMF_ReplySending = true;
+    BK4819_ToneSeq_Start(DTMF_TxSteps, DTMF_TxCount, DTMF_ReplySent);
+}
+
+void DTMF_ReplyCancel(void)
+{
+    if (!DTMF_ReplyPending)
+        return;
+
+    BK4819_ToneSeq_Stop();
+
+    AUDIO_AudioPathOff();
+
+    gEnableSpeaker = false;
+
+    if (DTMF_ReplySending)
+        BK4819_ExitDTMF_TX(false);
+
+    DTMF_ReplyPending = false;
+    DTMF_ReplySending = false;
+    DTMF_ReplyDone    = NULL;
+}
+
 void DTMF_SendEndOfTransmission(void)
 {
     if (gCurrentVfo->DTMF_PTT_ID_TX_MODE == PTT_ID_APOLLO) {
@@ -96,13 +313,9 @@ void DTMF_SendEndOfTransmission(void)
 
         BK4819_EnterDTMF_TX(gEeprom.DTMF_SIDE_TONE);
 
-        BK4819_PlayDTMFString(
-                gEeprom.DTMF_DOWN_CODE,
-                0,
-                gEeprom.DTMF_FIRST_CODE_PERSIST_TIME,
-                gEeprom.DTMF_HASH_CODE_PERSIST_TIME,
-                gEeprom.DTMF_CODE_PERSIST_TIME,
-                gEeprom.DTMF_CODE_INTERVAL_TIME);
+        // has to be out before the carrier drops
+        BK4819_ToneSeq_Start(DTMF_TxSteps, DTMF_BuildSteps(gEeprom.DTMF_DOWN_CODE, false), NULL);
+        BK4819_ToneSeq_Wait();
 
         AUDIO_AudioPathOff();
         gEnableSpeaker = false;
@@ -185,22 +398,6 @@ char DTMF_GetCharacter(const unsigned int code)
     }
 }
 #ifdef ENABLE_DTMF_CALLING
-static bool CompareMessage(const char *pMsg, const char *pTemplate, const unsigned int size, const bool bCheckGroup)
-{
-    unsigned int i;
-    for (i = 0; i < size; i++)
-    {
-        if (pMsg[i] != pTemplate[i])
-        {
-            if (!bCheckGroup || pMsg[i] != gEeprom.DTMF_GROUP_CALL_CODE)
-                return false;
-            gDTMF_IsGroupCall = true;
-        }
-    }
-
-    return true;
-}
-
 DTMF_CallMode_t DTMF_CheckGroupCall(const char *pMsg, const unsigned int size)
 {
     for (unsigned int i = 0; i < size; i++)
@@ -235,7 +432,6 @@ void DTMF_Append(const char code)
 void DTMF_HandleRequest(void)
 {   // proccess the RX'ed DTMF characters
 
-    char         String[21];
     unsigned int Offset;
 
     if (!gDTMF_RX_pending)
@@ -257,12 +453,7 @@ void DTMF_HandleRequest(void)
 
     if (gDTMF_RX_index >= 9)
     {   // look for the KILL code
-
-        sprintf(String, "%s%c%s", gEeprom.ANI_DTMF_ID, gEeprom.DTMF_SEPARATE_CODE, gEeprom.KILL_CODE);
-
-        Offset = gDTMF_RX_index - strlen(String);
-
-        if (CompareMessage(gDTMF_RX + Offset, String, strlen(String), true))
+        if (DTMF_Matched & (1u << DTMF_MATCH_KILL))
         {   // bugger
 
             if (gEeprom.PERMIT_REMOTE_KILL)
@@ -298,12 +489,7 @@ void DTMF_HandleRequest(void)
 
     if (gDTMF_RX_index >= 9)
     {   // look for the REVIVE code
-
-        sprintf(String, "%s%c%s", gEeprom.ANI_DTMF_ID, gEeprom.DTMF_SEPARATE_CODE, gEeprom.REVIVE_CODE);
-
-        Offset = gDTMF_RX_index - strlen(String);
-
-        if (CompareMessage(gDTMF_RX + Offset, String, strlen(String), true))
+        if (DTMF_Matched & (1u << DTMF_MATCH_REVIVE))
         {   // shit, we're back !
 
             gSetting_KILLED  = false;
@@ -323,11 +509,7 @@ void DTMF_HandleRequest(void)
 
     if (gDTMF_RX_index >= 2)
     {   // look for ACK reply
-        char *pPrintStr = "AB";
-
-        Offset = gDTMF_RX_index - strlen(pPrintStr);
-
-        if (CompareMessage(gDTMF_RX + Offset, pPrintStr, strlen(pPrintStr), true)) {
+        if (DTMF_Matched & (1u << DTMF_MATCH_ACK)) {
             // ends with "AB"
 
             if (gDTMF_ReplyState != DTMF_REPLY_NONE)          // 1of11
@@ -346,12 +528,7 @@ void DTMF_HandleRequest(void)
         gDTMF_CallMode  == DTMF_CALL_MODE_NOT_GROUP &&
         gDTMF_RX_index >= 9)
     {   // waiting for a reply
-
-        sprintf(String, "%s%c%s", gDTMF_String, gEeprom.DTMF_SEPARATE_CODE, "AAAAA");
-
-        Offset = gDTMF_RX_index - strlen(String);
-
-        if (CompareMessage(gDTMF_RX + Offset, String, strlen(String), false))
+        if (DTMF_Matched & (1u << DTMF_MATCH_CALL_RSP))
         {   // we got a response
             gDTMF_State    = DTMF_STATE_CALL_OUT_RSP;
             DTMF_clear_RX();
@@ -367,13 +544,12 @@ void DTMF_HandleRequest(void)
     if (gDTMF_RX_index >= 7)
     {   // see if we're being called
 
-        gDTMF_IsGroupCall = false;
-
-        sprintf(String, "%s%c", gEeprom.ANI_DTMF_ID, gEeprom.DTMF_SEPARATE_CODE);
+        gDTMF_IsGroupCall = (DTMF_MatchedGroup & (1u << DTMF_MATCH_CALL)) != 0;
 
-        Offset = gDTMF_RX_index - strlen(String) - 3;
+        // our ID, the separator, then the caller
+        Offset = gDTMF_RX_index - strlen(gEeprom.ANI_DTMF_ID) - 1 - 3;
 
-        if (CompareMessage(gDTMF_RX + Offset, String, strlen(String), true))
+        if (DTMF_Matched & (1u << DTMF_MATCH_CALL))
         {   // it's for us !
 
             gDTMF_CallState = DTMF_CALL_STATE_RECEIVED;
@@ -412,7 +588,7 @@ void DTMF_HandleRequest(void)
 }
 #endif
 
-void DTMF_Reply(void)
+void DTMF_Reply(void (*Done)(void))
 {
     uint16_t    Delay;
 #ifdef ENABLE_DTMF_CALLING
@@ -457,6 +633,8 @@ void DTMF_Reply(void)
                 gCurrentVfo->DTMF_PTT_ID_TX_MODE == PTT_ID_TX_DOWN)
             {
                 gDTMF_ReplyState = DTMF_REPLY_NONE;
+                if (Done)
+                    Done();
                 return;
             }
 
@@ -468,7 +646,15 @@ void DTMF_Reply(void)
     gDTMF_ReplyState = DTMF_REPLY_NONE;
 
     if (pString == NULL)
+    {
+        if (Done)
+            Done();
         return;
+    }
+
+    DTMF_ReplyCancel();
+
+    DTMF_TxCount = DTMF_BuildSteps(pString, true);
 
     Delay = (gEeprom.DTMF_PRELOAD_TIME < 200) ? 200 : gEeprom.DTMF_PRELOAD_TIME;
 
@@ -478,21 +664,11 @@ void DTMF_Reply(void)
         gEnableSpeaker = true;
     }
 
-    SYSTEM_DelayMs(Delay);
-
-    BK4819_EnterDTMF_TX(gEeprom.DTMF_SIDE_TONE);
-
-    BK4819_PlayDTMFString(
-        pString,
-        1,
-        gEeprom.DTMF_FIRST_CODE_PERSIST_TIME,
-        gEeprom.DTMF_HASH_CODE_PERSIST_TIME,
-        gEeprom.DTMF_CODE_PERSIST_TIME,
-        gEeprom.DTMF_CODE_INTERVAL_TIME);
-
-    AUDIO_AudioPathOff();
+    // the preload is a silent step with the mic still live, the DTMF
+    // generator only takes over once it has passed
+    DTMF_PreloadStep.On_10ms = Delay / 10;
 
-    gEnableSpeaker = false;
-
-    BK4819_ExitDTMF_TX(false);
+    DTMF_ReplyPending = true;
+    DTMF_ReplyDone    = Done;
+    BK4819_ToneSeq_Start(&DTMF_PreloadStep, 1, DTMF_ReplyPreloaded);
 }
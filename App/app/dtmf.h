@@ -84,7 +84,8 @@ bool DTMF_ValidateCodes(char *pCode, const unsigned int size);
 char DTMF_GetCharacter(const unsigned int code);
 void DTMF_clear_input_box(void);
 void DTMF_Append(const char code);
-void DTMF_Reply(void);
+void DTMF_Reply(void (*Done)(void));
+void DTMF_ReplyCancel(void);
 void DTMF_SendEndOfTransmission(void);
 
 #ifdef ENABLE_DTMF_CALLING
@@ -109,6 +110,7 @@ extern bool              gDTMF_IsTx;
 extern uint8_t           gDTMF_TxStopCountdown_500ms;
 
 void DTMF_clear_RX(void);
+void DTMF_RX_Append(const char c);
 DTMF_CallMode_t DTMF_CheckGroupCall(const char *pDTMF, const unsigned int size);
 bool DTMF_GetContact(const int Index, char *pContact);
 bool DTMF_FindContact(const char *pContact, char *pResult);
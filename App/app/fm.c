@@ -43,6 +43,16 @@ bool              gFM_FoundFrequency;
 bool              gFM_AutoScan;
 uint16_t          gFM_RestoreCountdown_10ms;
 
+// the first look at a scan step, whether it deserves the full dwell
+static bool       FM_Probing;
+// RSSI of the auto scan finds, the weakest make room when the list is full
+static uint8_t    FM_ScanRssi[FM_CHANNELS_MAX];
+
+// saved channel being listened to and how many ticks it has gone without a station
+static uint8_t    FM_CheckChannel = 0xFF;
+static uint8_t    FM_CheckMisses;
+// channels found without a station while playing, bit per channel, RAM only
+static uint8_t    FM_ChannelDead[(FM_CHANNELS_MAX + 7) / 8];
 
 
 const uint8_t BUTTON_STATE_PRESSED = 1 << 0;
@@ -63,16 +73,34 @@ bool FM_CheckValidChannel(uint8_t Channel)
             gFM_Channels[Channel] < BK1080_GetFreqHiLimit(gEeprom.FM_Band);
 }
 
+static bool FM_IsChannelDead(uint8_t Channel)
+{
+    return FM_ChannelDead[Channel / 8] & (1u << (Channel % 8));
+}
+
+static void FM_SetChannelDead(uint8_t Channel, bool bDead)
+{
+    if (bDead)
+        FM_ChannelDead[Channel / 8] |= 1u << (Channel % 8);
+    else
+        FM_ChannelDead[Channel / 8] &= ~(1u << (Channel % 8));
+}
+
 uint8_t FM_FindNextChannel(uint8_t Channel, uint8_t Direction)
 {
-    for (unsigned i = 0; i < ARRAY_SIZE(gFM_Channels); i++) {
-        if (Channel == 0xFF)
-            Channel = ARRAY_SIZE(gFM_Channels) - 1;
-        else if (Channel >= ARRAY_SIZE(gFM_Channels))
-            Channel = 0;
-        if (FM_CheckValidChannel(Channel))
-            return Channel;
-        Channel += Direction;
+    // a channel without a station is only returned when there is nothing else
+    for (unsigned pass = 0; pass < 2; pass++) {
+        uint8_t Next = Channel;
+
+        for (unsigned i = 0; i < ARRAY_SIZE(gFM_Channels); i++) {
+            if (Next == 0xFF)
+                Next = ARRAY_SIZE(gFM_Channels) - 1;
+            else if (Next >= ARRAY_SIZE(gFM_Channels))
+                Next = 0;
+            if (FM_CheckValidChannel(Next) && (pass || !FM_IsChannelDead(Next)))
+                return Next;
+            Next += Direction;
+        }
     }
 
     return 0xFF;
@@ -127,6 +155,7 @@ void FM_EraseChannels(void)
     PY25Q16_WriteBuffer(0x00A028, clearBuf, sizeof(clearBuf), false);
 
     memset(gFM_Channels, 0xFF, sizeof(gFM_Channels));
+    memset(FM_ChannelDead, 0, sizeof(FM_ChannelDead));
 }
 
 uint16_t FM_WrapFrequency(uint16_t Frequency) {
@@ -147,7 +176,10 @@ void FM_Tune(uint16_t Frequency, int8_t Step, bool bFlag)
 
     gEnableSpeaker = false;
 
-    gFmPlayCountdown_10ms = (gFM_ScanState == FM_SCAN_OFF) ? fm_play_countdown_noscan_10ms : fm_play_countdown_scan_10ms;
+    // an empty channel shows in the RSSI and SNR long before the AFC of a
+    // station has settled, so each step gets a quick look first
+    FM_Probing            = (gFM_ScanState != FM_SCAN_OFF);
+    gFmPlayCountdown_10ms = FM_Probing ? fm_probe_countdown_scan_10ms : fm_play_countdown_noscan_10ms;
 
     gScheduleFM                 = false;
     gFM_FoundFrequency          = false;
@@ -232,6 +264,71 @@ int FM_CheckFrequencyLock(uint16_t Frequency, uint16_t LowerLimit)
     return 0;
 }
 
+// worth the full dwell, read fm_probe_countdown_scan_10ms after the tune
+static bool FM_MightBeStation(void)
+{
+    return BK1080_REG_07_GET_SNR(BK1080_ReadRegister(BK1080_REG_07)) > 2 &&
+           BK1080_REG_10_GET_RSSI(BK1080_ReadRegister(BK1080_REG_10)) >= 10;
+}
+
+static void FM_AddStation(uint16_t Frequency, uint8_t Rssi)
+{
+    unsigned int i = gFM_ChannelPosition;
+
+    if (i < FM_CHANNELS_MAX) {
+        gFM_ChannelPosition++;
+    }
+    else {
+        // full, drop the weakest if this one is stronger
+        i = 0;
+        for (unsigned int j = 1; j < FM_CHANNELS_MAX; j++)
+            if (FM_ScanRssi[j] < FM_ScanRssi[i])
+                i = j;
+
+        if (FM_ScanRssi[i] >= Rssi)
+            return;
+
+        // the scan goes up, the newcomer belongs at the end
+        memmove(&gFM_Channels[i], &gFM_Channels[i + 1], (FM_CHANNELS_MAX - 1 - i) * sizeof(gFM_Channels[0]));
+        memmove(&FM_ScanRssi[i], &FM_ScanRssi[i + 1], FM_CHANNELS_MAX - 1 - i);
+        i = FM_CHANNELS_MAX - 1;
+    }
+
+    gFM_Channels[i] = Frequency;
+    FM_ScanRssi[i]  = Rssi;
+}
+
+void FM_CheckChannelTimeSlice500ms(void)
+{
+    enum { DEAD_AFTER_500ms = 3 };
+
+    if (gFM_ScanState != FM_SCAN_OFF || !gEeprom.FM_IsMrMode) {
+        FM_CheckChannel = 0xFF;
+        return;
+    }
+
+    const uint8_t Channel = gEeprom.FM_SelectedChannel;
+    if (!FM_CheckValidChannel(Channel) || gEeprom.FM_FrequencyPlaying != gFM_Channels[Channel]) {
+        FM_CheckChannel = 0xFF;
+        return;
+    }
+
+    if (Channel != FM_CheckChannel) {
+        // just tuned, let the AFC settle before the first look
+        FM_CheckChannel = Channel;
+        FM_CheckMisses  = 0;
+        return;
+    }
+
+    if (FM_MightBeStation()) {
+        FM_CheckMisses = 0;
+        FM_SetChannelDead(Channel, false);
+    }
+    else if (FM_CheckMisses < DEAD_AFTER_500ms && ++FM_CheckMisses == DEAD_AFTER_500ms) {
+        FM_SetChannelDead(Channel, true);
+    }
+}
+
 static void Key_DIGITS(KEY_Code_t Key, uint8_t state)
 {
     enum { STATE_FREQ_MODE, STATE_MR_MODE, STATE_SAVE };
@@ -462,6 +559,7 @@ static void Key_MENU(uint8_t state)
         if (!gEeprom.FM_IsMrMode) {
             if (gAskToSave) {
                 gFM_Channels[gFM_ChannelPosition] = gEeprom.FM_FrequencyPlaying;
+                FM_SetChannelDead(gFM_ChannelPosition, false);
                 gRequestSaveFM = true;
             }
             gAskToSave = !gAskToSave;
@@ -487,6 +585,7 @@ static void Key_MENU(uint8_t state)
 
         if (gAskToSave) {
             gFM_Channels[gFM_ChannelPosition] = gEeprom.FM_FrequencyPlaying;
+            FM_SetChannelDead(gFM_ChannelPosition, false);
             gRequestSaveFM = true;
         }
         gAskToSave = !gAskToSave;
@@ -595,7 +694,23 @@ void FM_ProcessKeys(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld)
 
 void FM_Play(void)
 {
-    if (!FM_CheckFrequencyLock(gEeprom.FM_FrequencyPlaying, BK1080_GetFreqLoLimit(gEeprom.FM_Band))) {
+    bool bWeak = false;
+
+    if (FM_Probing) {
+        FM_Probing = false;
+
+        if (FM_MightBeStation()) {
+            // give the AFC the rest of the dwell
+            gFmPlayCountdown_10ms = fm_play_countdown_scan_10ms - fm_probe_countdown_scan_10ms;
+            return;
+        }
+
+        // still goes through FM_CheckFrequencyLock(), the next step compares
+        // against the deviation it records
+        bWeak = true;
+    }
+
+    if (!FM_CheckFrequencyLock(gEeprom.FM_FrequencyPlaying, BK1080_GetFreqLoLimit(gEeprom.FM_Band)) && !bWeak) {
         if (!gFM_AutoScan) {
             gFmPlayCountdown_10ms = 0;
             gFM_FoundFrequency    = true;
@@ -610,17 +725,10 @@ void FM_Play(void)
             return;
         }
 
-        if (gFM_ChannelPosition < FM_CHANNELS_MAX)
-            gFM_Channels[gFM_ChannelPosition++] = gEeprom.FM_FrequencyPlaying;
-
-        if (gFM_ChannelPosition >= FM_CHANNELS_MAX) {
-            FM_PlayAndUpdate();
-            GUI_SelectNextDisplay(DISPLAY_FM);
-            return;
-        }
+        FM_AddStation(gEeprom.FM_FrequencyPlaying, BK1080_REG_10_GET_RSSI(BK1080_ReadRegister(BK1080_REG_10)));
     }
 
-    if (gFM_AutoScan && gEeprom.FM_FrequencyPlaying >= BK1080_GetFreqHiLimit(1))
+    if (gFM_AutoScan && gEeprom.FM_FrequencyPlaying >= BK1080_GetFreqHiLimit(gEeprom.FM_Band))
         FM_PlayAndUpdate();
     else
         FM_Tune(gEeprom.FM_FrequencyPlaying, gFM_ScanState, false);
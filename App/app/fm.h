@@ -57,6 +57,10 @@ void    FM_ProcessKeys(KEY_Code_t Key, bool bKeyPressed, bool bKeyHeld);
 void    FM_Play(void);
 void    FM_Start(void);
 
+// watches the saved channel that is playing, one without a station is
+// skipped when stepping through the channels until it is played or saved again
+void    FM_CheckChannelTimeSlice500ms(void);
+
 #endif
 
 #endif
@@ -85,13 +85,10 @@ static void toggle_chan_scanlist(void)
         return;
     }
     
-    ChannelAttributes_t *att = MR_GetChannelAttributes(gTxVfo->CHANNEL_SAVE);
-
     // Remove exclude
-    if(att->exclude == true)
+    if(MR_IsChannelExcluded(gTxVfo->CHANNEL_SAVE))
     {
-        att->exclude = false;
-        MR_SaveChannelAttributesToFlash(gTxVfo->CHANNEL_SAVE, att);
+        MR_SetChannelExcluded(gTxVfo->CHANNEL_SAVE, false);
     } 
     else 
     {
@@ -760,10 +757,7 @@ static void MAIN_Key_MENU(bool bKeyPressed, bool bKeyHeld)
             {
                 if(FUNCTION_IsRx() || gScanPauseDelayIn_10ms > 9)
                 {
-                    ChannelAttributes_t *att = MR_GetChannelAttributes(lastFoundFrqOrChan);
-                    att->exclude = true;
-
-                    MR_SaveChannelAttributesToFlash(lastFoundFrqOrChan, att);
+                    MR_SetChannelExcluded(lastFoundFrqOrChan, true);
 
                     gVfoConfigureMode = VFO_CONFIGURE;
                     gFlagResetVfos    = true;
@@ -23,6 +23,7 @@
 #include "app/generic.h"
 #include "app/menu.h"
 #include "app/scanner.h"
+#include "app/sqlcal.h"
 #include "audio.h"
 #include "board.h"
 #include "driver/backlight.h"
@@ -30,6 +31,7 @@
 #include "driver/eeprom.h"
 #include "driver/gpio.h"
 #include "driver/keyboard.h"
+#include "driver/py25q16.h"
 #include "frequencies.h"
 #include "helper/battery.h"
 #include "misc.h"
@@ -216,6 +218,13 @@ int MENU_GetLimits(uint8_t menu_id, int32_t *pMin, int32_t *pMax)
             *pMax = ARRAY_SIZE(gSubMenu_RESET) - 1;
             break;
 
+#ifdef ENABLE_SQUELCH_CAL
+        case MENU_SQL_CAL:
+            //*pMin = 0;
+            *pMax = ARRAY_SIZE(gSubMenu_SQL_CAL) - 1;
+            break;
+#endif
+
         case MENU_COMPAND:
         case MENU_ABR_ON_TX_RX:
             //*pMin = 0;
@@ -301,6 +310,13 @@ int MENU_GetLimits(uint8_t menu_id, int32_t *pMin, int32_t *pMax)
             *pMax = MR_CHANNEL_LAST + 2;
             break;
 
+#ifdef ENABLE_PRIORITY_WATCH
+        case MENU_S_PRI_WATCH:
+            //*pMin = 0;
+            *pMax = 10;
+            break;
+#endif
+
         case MENU_SAVE:
             //*pMin = 0;
             *pMax = 5;
@@ -483,6 +499,17 @@ void MENU_AcceptSetting(void)
             gRequestSaveSquelch   = true;
             break;
 
+#ifdef ENABLE_SQUELCH_CAL
+        case MENU_SQL_CAL:
+            if (gSubMenuSelection)
+                SQLCAL_Run();
+            else
+                SQLCAL_Clear();
+            gVfoConfigureMode = VFO_CONFIGURE;
+            gFlagResetVfos    = true;
+            break;
+#endif
+
         case MENU_STEP:
             gTxVfo->STEP_SETTING = FREQUENCY_GetStepIdxFromSortedIdx(gSubMenuSelection);
             if (IS_FREQ_CHANNEL(gTxVfo->CHANNEL_SAVE))
@@ -603,6 +630,12 @@ void MENU_AcceptSetting(void)
             gEeprom.SCANLIST_PRIORITY_CH[1] = gSubMenuSelection;
             break;
 
+#ifdef ENABLE_PRIORITY_WATCH
+        case MENU_S_PRI_WATCH:
+            gEeprom.PRIORITY_WATCH = gSubMenuSelection;
+            break;
+#endif
+
         case MENU_SAVE:
             gEeprom.BATTERY_SAVE = gSubMenuSelection;
             break;
@@ -1028,6 +1061,9 @@ void MENU_ShowCurrentSetting(void)
             break;
 
         case MENU_RESET:
+#ifdef ENABLE_SQUELCH_CAL
+        case MENU_SQL_CAL:
+#endif
             gSubMenuSelection = 0;
             break;
 
@@ -1229,6 +1265,12 @@ void MENU_ShowCurrentSetting(void)
             gSubMenuSelection = gEeprom.SCANLIST_PRIORITY_CH[1];
             break;
 
+#ifdef ENABLE_PRIORITY_WATCH
+        case MENU_S_PRI_WATCH:
+            gSubMenuSelection = gEeprom.PRIORITY_WATCH;
+            break;
+#endif
+
         #ifdef ENABLE_ALARM
             case MENU_AL_MOD:
                 gSubMenuSelection = gEeprom.ALARM_MODE;
@@ -1794,6 +1836,7 @@ static void MENU_Key_MENU(const bool bKeyPressed, const bool bKeyHeld)
                         #endif
 
                         MENU_AcceptSetting();
+                        PY25Q16_Flush();
 
                         #if defined(ENABLE_OVERLAY)
                             overlay_FLASH_RebootToBootloader();
@@ -0,0 +1,254 @@
+#ifdef ENABLE_PRIORITY_WATCH
+
+#include "app/chFrScanner.h"
+#ifdef ENABLE_DTMF_CALLING
+    #include "app/dtmf.h"
+#endif
+#ifdef ENABLE_FMRADIO
+    #include "app/fm.h"
+#endif
+#include "app/priority.h"
+#include "app/scanner.h"
+#include "audio.h"
+#include "driver/bk4819.h"
+#include "functions.h"
+#include "helper/rssi.h"
+#include "misc.h"
+#include "radio.h"
+#include "settings.h"
+#include "ui/ui.h"
+
+// the RSSI has settled 20 .. 30 ms after a retune
+#define PRIORITY_DWELL_10ms 3
+
+// quiet time on a priority channel we moved to before going back
+#define PRIORITY_HOME_10ms  300
+
+typedef enum {
+    PRIORITY_IDLE = 0,
+    PRIORITY_LOOKING,       // tuned to a priority channel, waiting for its RSSI
+    PRIORITY_BACK           // back on gRxVfo, re-checking the squelch it was receiving on
+} PriorityState_t;
+
+static PriorityState_t  PriorityState;
+static uint16_t         PriorityInterval_10ms;
+static uint16_t         PriorityDwell_10ms;
+static FUNCTION_Type_t  PriorityFunction;   // what was going on when we left
+static uint8_t          PriorityIndex;
+static uint16_t         PriorityChannel;
+static uint8_t          PriorityOpenRssi;
+
+// where the VFO was before it moved to priority channel HomeOn
+static uint16_t         HomeChannel = 0xFFFF;
+static uint16_t         HomeMrChannel;
+static uint8_t          HomeVfo;
+static uint16_t         HomeOn;
+static uint16_t         HomeCountdown_10ms;
+
+static uint16_t PRIORITY_GetChannel(unsigned int Index)
+{
+    const uint16_t Channel = gEeprom.SCANLIST_PRIORITY_CH[Index];
+
+    if (Channel == gRxVfo->CHANNEL_SAVE || !RADIO_CheckValidChannel(Channel, false, 0))
+        return 0xFFFF;
+
+    return Channel;
+}
+
+static bool PRIORITY_CanLook(void)
+{
+    return gEeprom.PRIORITY_WATCH != 0
+        && gEeprom.SQUELCH_LEVEL != 0       // no threshold to tell a signal by
+        && (gCurrentFunction == FUNCTION_FOREGROUND || gCurrentFunction == FUNCTION_RECEIVE)
+        && gScanStateDir == SCAN_OFF
+        && !SCANNER_IsScanning()
+        && !gCssBackgroundScan
+        && !gPttIsPressed
+#ifdef ENABLE_AIRCOPY
+        && gScreenToDisplay != DISPLAY_AIRCOPY
+#endif
+#ifdef ENABLE_VOICE
+        && gVoiceWriteIndex == 0
+#endif
+#ifdef ENABLE_FMRADIO
+        && !gFmRadioMode
+#endif
+#ifdef ENABLE_NOAA
+        && !gIsNoaaMode
+#endif
+#ifdef ENABLE_DTMF_CALLING
+        && gDTMF_CallState == DTMF_CALL_STATE_NONE
+#endif
+        ;
+}
+
+// tune to the next priority channel from PriorityIndex on, false if none is left
+static bool PRIORITY_Hop(void)
+{
+    for (; PriorityIndex < 2; PriorityIndex++)
+    {
+        const uint16_t Channel = PRIORITY_GetChannel(PriorityIndex);
+
+        if (Channel != 0xFFFF && RADIO_TuneToPriority(PriorityIndex, Channel, &PriorityOpenRssi))
+        {
+            PriorityChannel    = Channel;
+            PriorityDwell_10ms = PRIORITY_DWELL_10ms;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void PRIORITY_MoveTo(uint16_t Channel)
+{
+    const unsigned int Vfo = gEeprom.RX_VFO;
+
+    if (HomeChannel == 0xFFFF)
+    {
+        HomeChannel   = gEeprom.ScreenChannel[Vfo];
+        HomeMrChannel = gEeprom.MrChannel[Vfo];
+        HomeVfo       = Vfo;
+    }
+    HomeOn             = Channel;
+    HomeCountdown_10ms = PRIORITY_HOME_10ms;
+
+    gEeprom.ScreenChannel[Vfo] = Channel;
+    gEeprom.MrChannel[Vfo]     = Channel;
+    RADIO_ConfigureChannel(Vfo, VFO_CONFIGURE_RELOAD);
+
+    // ends whatever was being received, the squelch takes it from here
+    RADIO_SetupRegisters(true);
+
+    gUpdateDisplay = true;
+}
+
+static void PRIORITY_GoHome(void)
+{
+    gEeprom.ScreenChannel[HomeVfo] = HomeChannel;
+    gEeprom.MrChannel[HomeVfo]     = HomeMrChannel;
+    HomeChannel                    = 0xFFFF;
+
+    RADIO_ConfigureChannel(HomeVfo, VFO_CONFIGURE_RELOAD);
+    RADIO_SetupRegisters(true);
+
+    gUpdateDisplay = true;
+}
+
+static void PRIORITY_TuneBack(void)
+{
+    RADIO_TuneBackToRxVfo();
+
+    // the image left the AF muted
+    if (gCurrentFunction == FUNCTION_RECEIVE || gCurrentFunction == FUNCTION_MONITOR)
+        RADIO_SetModulation(gRxVfo->Modulation);
+}
+
+static void PRIORITY_Look(void)
+{
+    if (gCurrentFunction != PriorityFunction || !RADIO_IsOnPriority())
+    {   // something else took over the radio, TX sets it up from scratch
+        if (RADIO_IsOnPriority() && gCurrentFunction != FUNCTION_TRANSMIT)
+            PRIORITY_TuneBack();
+
+        PriorityState = PRIORITY_IDLE;
+        return;
+    }
+
+    if (--PriorityDwell_10ms > 0)
+        return;
+
+    if (RSSI_GetRaw() >= PriorityOpenRssi)
+    {
+        PriorityState = PRIORITY_IDLE;
+        PRIORITY_MoveTo(PriorityChannel);
+        return;
+    }
+
+    PriorityIndex++;
+    if (PRIORITY_Hop())
+        return;
+
+    PRIORITY_TuneBack();
+
+    if (gCurrentFunction != FUNCTION_RECEIVE)
+    {
+        PriorityState = PRIORITY_IDLE;
+        return;
+    }
+
+    PriorityState      = PRIORITY_BACK;
+    PriorityDwell_10ms = PRIORITY_DWELL_10ms;
+}
+
+void PRIORITY_TimeSlice10ms(void)
+{
+    switch (PriorityState)
+    {
+        case PRIORITY_LOOKING:
+            PRIORITY_Look();
+            return;
+
+        case PRIORITY_BACK:
+            if (--PriorityDwell_10ms > 0)
+                return;
+
+            // the squelch restarted with the retune and only reports opening
+            if (gCurrentFunction == FUNCTION_RECEIVE && RSSI_GetRaw() < gRxVfo->SquelchCloseRSSIThresh)
+                g_SquelchLost = true;
+
+            PriorityState = PRIORITY_IDLE;
+            return;
+
+        default:
+            break;
+    }
+
+    if (HomeChannel != 0xFFFF)
+    {
+        if (gEeprom.PRIORITY_WATCH == 0 || gEeprom.ScreenChannel[HomeVfo] != HomeOn)
+            HomeChannel = 0xFFFF;       // moved on by hand
+        else if (gCurrentFunction != FUNCTION_FOREGROUND || !PRIORITY_CanLook())
+            HomeCountdown_10ms = PRIORITY_HOME_10ms;
+        else if (--HomeCountdown_10ms == 0)
+        {
+            PRIORITY_GoHome();
+            return;
+        }
+    }
+
+    if (!PRIORITY_CanLook())
+    {
+        PriorityInterval_10ms = gEeprom.PRIORITY_WATCH * 100;
+        return;
+    }
+
+    if (PriorityInterval_10ms > 0 && --PriorityInterval_10ms > 0)
+        return;
+
+    PriorityInterval_10ms = gEeprom.PRIORITY_WATCH * 100;
+
+    PriorityFunction = gCurrentFunction;
+    PriorityIndex    = 0;
+    if (PRIORITY_Hop())
+        PriorityState = PRIORITY_LOOKING;
+}
+
+bool PRIORITY_IsLooking(void)
+{
+    return PriorityState != PRIORITY_IDLE;
+}
+
+bool PRIORITY_IsActive(void)
+{
+    if (gEeprom.PRIORITY_WATCH == 0 || gEeprom.SQUELCH_LEVEL == 0)
+        return false;
+
+    // parked on a priority channel, waiting to go home
+    if (HomeChannel != 0xFFFF || PriorityState != PRIORITY_IDLE)
+        return true;
+
+    return PRIORITY_GetChannel(0) != 0xFFFF || PRIORITY_GetChannel(1) != 0xFFFF;
+}
+
+#endif
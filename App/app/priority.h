@@ -0,0 +1,18 @@
+#ifndef APP_PRIORITY_H
+#define APP_PRIORITY_H
+
+#ifdef ENABLE_PRIORITY_WATCH
+
+#include <stdbool.h>
+
+// Priority watch: every PRIORITY_WATCH seconds, while parked on a channel or
+// a frequency, look at the priority channels of the current scan list for a
+// few tens of ms and move over to one that carries a signal.
+void PRIORITY_TimeSlice10ms(void);
+bool PRIORITY_IsLooking(void);
+// watch enabled with a priority channel to look at, keeps battery save off
+bool PRIORITY_IsActive(void);
+
+#endif
+
+#endif
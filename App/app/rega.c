@@ -159,6 +159,7 @@ void REGA_TransmitZvei(const uint16_t tones[],const char message[])
     // Set the radio to transmit mode
     RADIO_PrepareCssTX();
     FUNCTION_Select(FUNCTION_TRANSMIT);
+    BK4819_ToneSeq_Wait();  // any PTT-ID first
 
     // Wait to allow the radio to switch to transmit mode and stabilize the transmitter
     SYSTEM_DelayMs(ZVEI_PRE_LENGTH_MS);
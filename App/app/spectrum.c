@@ -24,6 +24,7 @@
 
 #include "driver/backlight.h"
 #include "frequencies.h"
+#include "helper/scratch.h"
 #include "ui/helper.h"
 #include "ui/main.h"
 
@@ -67,10 +68,22 @@ ScanInfo scanInfo;
 static KeyboardState kbd = {KEY_INVALID, KEY_INVALID, 0};
 
 #ifdef ENABLE_SCAN_RANGES
-static uint16_t blacklistFreqs[15];
 static uint8_t blacklistFreqsIdx;
 #endif
 
+// only needed while the spectrum runs, lives in the scratch region
+typedef struct
+{
+    uint16_t rssiHistory[128];
+#ifdef ENABLE_SCAN_RANGES
+    uint16_t blacklistFreqs[15];
+#endif
+} SpectrumScratch_t;
+
+SCRATCH_CHECK(SpectrumScratch_t);
+
+static SpectrumScratch_t *scratch;
+
 const char *bwOptions[] = {"25", "12.5", "6.25"};
 const uint8_t modulationTypeTuneSteps[] = {100, 50, 10};
 const uint8_t modTypeReg47Values[] = {1, 7, 5};
@@ -89,7 +102,6 @@ SpectrumSettings settings = {.stepsCount = STEPS_64,
 
 uint32_t fMeasure = 0;
 uint32_t currentFreq, tempFreq;
-uint16_t rssiHistory[128];
 int vfo;
 uint8_t freqInputIndex = 0;
 uint8_t freqInputDotIndex = 0;
@@ -546,11 +558,11 @@ static void ResetBlacklist()
 {
     for (int i = 0; i < 128; ++i)
     {
-        if (rssiHistory[i] == RSSI_MAX_VALUE)
-            rssiHistory[i] = 0;
+        if (scratch->rssiHistory[i] == RSSI_MAX_VALUE)
+            scratch->rssiHistory[i] = 0;
     }
 #ifdef ENABLE_SCAN_RANGES
-    memset(blacklistFreqs, 0, sizeof(blacklistFreqs));
+    memset(scratch->blacklistFreqs, 0, sizeof(scratch->blacklistFreqs));
     blacklistFreqsIdx = 0;
 #endif
 }
@@ -612,14 +624,14 @@ static void SetRssiHistory(uint16_t idx, uint16_t rssi)
 #ifdef ENABLE_SCAN_RANGES
     if (scanInfo.measurementsCount > 128)
     {
-        uint8_t i = (uint32_t)ARRAY_SIZE(rssiHistory) * 1000 / scanInfo.measurementsCount * idx / 1000;
-        if (rssiHistory[i] < rssi || isListening)
-            rssiHistory[i] = rssi;
-        rssiHistory[(i + 1) % 128] = 0;
+        uint8_t i = (uint32_t)ARRAY_SIZE(scratch->rssiHistory) * 1000 / scanInfo.measurementsCount * idx / 1000;
+        if (scratch->rssiHistory[i] < rssi || isListening)
+            scratch->rssiHistory[i] = rssi;
+        scratch->rssiHistory[(i + 1) % 128] = 0;
         return;
     }
 #endif
-    rssiHistory[idx] = rssi;
+    scratch->rssiHistory[idx] = rssi;
 }
 
 static void Measure()
@@ -886,7 +898,7 @@ static void UpdateFreqInput(KEY_Code_t key)
 static void Blacklist()
 {
 #ifdef ENABLE_SCAN_RANGES
-    blacklistFreqs[blacklistFreqsIdx++ % ARRAY_SIZE(blacklistFreqs)] = peak.i;
+    scratch->blacklistFreqs[blacklistFreqsIdx++ % ARRAY_SIZE(scratch->blacklistFreqs)] = peak.i;
 #endif
 
     SetRssiHistory(peak.i, RSSI_MAX_VALUE);
@@ -899,8 +911,8 @@ static void Blacklist()
 static bool IsBlacklisted(uint16_t idx)
 {
     if (blacklistFreqsIdx)
-        for (uint8_t i = 0; i < ARRAY_SIZE(blacklistFreqs); i++)
-            if (blacklistFreqs[i] == idx)
+        for (uint8_t i = 0; i < ARRAY_SIZE(scratch->blacklistFreqs); i++)
+            if (scratch->blacklistFreqs[i] == idx)
                 return true;
     return false;
 }
@@ -937,7 +949,7 @@ uint8_t Rssi2Y(uint16_t rssi)
         uint8_t ox = 0;
         for (uint8_t i = 0; i < bars; ++i)
         {
-            uint16_t rssi = rssiHistory[(bars>128) ? i >> settings.stepsCount : i];
+            uint16_t rssi = scratch->rssiHistory[(bars>128) ? i >> settings.stepsCount : i];
             
 #ifdef ENABLE_SCAN_RANGES
             uint8_t x;
@@ -981,7 +993,7 @@ uint8_t Rssi2Y(uint16_t rssi)
     {
         for (uint8_t x = 0; x < 128; ++x)
         {
-            uint16_t rssi = rssiHistory[x >> settings.stepsCount];
+            uint16_t rssi = scratch->rssiHistory[x >> settings.stepsCount];
             if (rssi != RSSI_MAX_VALUE)
             {
                 DrawVLine(Rssi2Y(rssi), DrawingEndY, x, true);
@@ -1543,7 +1555,7 @@ static bool HandleUserInput()
 
 static void Scan()
 {
-    if (rssiHistory[scanInfo.i] != RSSI_MAX_VALUE
+    if (scratch->rssiHistory[scanInfo.i] != RSSI_MAX_VALUE
 #ifdef ENABLE_SCAN_RANGES
         && !IsBlacklisted(scanInfo.i)
 #endif
@@ -1573,8 +1585,8 @@ static void UpdateScan()
     }
 
     if (! (scanInfo.measurementsCount >> 7)) // if (scanInfo.measurementsCount < 128)
-        memset(&rssiHistory[scanInfo.measurementsCount], 0,
-               sizeof(rssiHistory) - scanInfo.measurementsCount * sizeof(rssiHistory[0]));
+        memset(&scratch->rssiHistory[scanInfo.measurementsCount], 0,
+               sizeof(scratch->rssiHistory) - scanInfo.measurementsCount * sizeof(scratch->rssiHistory[0]));
 
     redrawScreen = true;
     preventKeypress = false;
@@ -1663,9 +1675,13 @@ static void Tick()
     SCREENSHOT_ParseInput();
 #endif
 
+    // this loop replaces the main one, so it drives the flash write-behind too
+    PY25Q16_Process();
+
     if (gNextTimeslice)
     {
         gNextTimeslice = false;
+        PY25Q16_TimeSlice10ms();
 #ifdef ENABLE_AM_FIX
         if (settings.modulationType == MODULATION_AM && !lockAGC)
         {
@@ -1741,6 +1757,13 @@ static void Tick()
 
 void APP_RunSpectrum()
 {
+    PY25Q16_Flush();
+    AUDIO_BeepWait();
+
+    scratch = SCRATCH_Acquire(SCRATCH_SPECTRUM, sizeof(*scratch));
+    if (scratch == NULL)
+        return;
+
     settings.backlightState = gEeprom.BACKLIGHT_TIME == 0 ? false : true;
 
     // TX here coz it always? set to active VFO
@@ -1797,7 +1820,7 @@ void APP_RunSpectrum()
 
     RelaunchScan();
 
-    memset(rssiHistory, 0, sizeof(rssiHistory));
+    memset(scratch->rssiHistory, 0, sizeof(scratch->rssiHistory));
 
     isInitialized = true;
 
@@ -1806,5 +1829,10 @@ void APP_RunSpectrum()
         Tick();
     }
 
+    SCRATCH_Release(SCRATCH_SPECTRUM);
+    scratch = NULL;
+
+    PY25Q16_Flush();
+
     BACKLIGHT_TurnOn();
 }
\ No newline at end of file
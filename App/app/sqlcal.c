@@ -0,0 +1,119 @@
+#ifdef ENABLE_SQUELCH_CAL
+
+#include <string.h>
+
+#include "app/sqlcal.h"
+#include "audio.h"
+#include "driver/bk4819.h"
+#include "driver/system.h"
+#include "frequencies.h"
+#include "functions.h"
+#include "misc.h"
+#include "settings.h"
+
+// frequencies measured per band, evenly spread over it
+#define SQLCAL_POINTS   8
+
+// the busiest points are dropped as likely carrying a signal
+#define SQLCAL_DISCARD  2
+
+// RSSI reads per point, 1 ms apart
+#define SQLCAL_SAMPLES  8
+
+typedef struct
+{
+    uint16_t Mean;
+    uint16_t Peak;
+} SqlCalPoint_t;
+
+static void SQLCAL_Tune(uint32_t Frequency)
+{
+    BK4819_SetFrequency(Frequency);
+    BK4819_PickRXFilterPathBasedOnFrequency(Frequency);
+
+    // restart the receiver on the new frequency
+    const uint16_t Reg = BK4819_ReadRegister(BK4819_REG_30);
+    BK4819_WriteRegister(BK4819_REG_30, 0);
+    BK4819_WriteRegister(BK4819_REG_30, Reg);
+
+    SYSTEM_DelayMs(20);     // RSSI settling
+}
+
+static void SQLCAL_Measure(SqlCalPoint_t *pPoint)
+{
+    uint32_t Sum = 0;
+
+    pPoint->Peak = 0;
+
+    for (unsigned int i = 0; i < SQLCAL_SAMPLES; i++)
+    {
+        const uint16_t Rssi = BK4819_GetRSSI();
+
+        Sum += Rssi;
+        if (Rssi > pPoint->Peak)
+            pPoint->Peak = Rssi;
+
+        SYSTEM_DelayMs(1);
+    }
+
+    pPoint->Mean = Sum / SQLCAL_SAMPLES;
+}
+
+// highest RSSI the quietest points of the band reached
+static uint8_t SQLCAL_MeasureBand(FREQUENCY_Band_t Band)
+{
+    SqlCalPoint_t Points[SQLCAL_POINTS];
+
+    const uint32_t Lower = frequencyBandTable[Band].lower;
+    const uint32_t Span  = frequencyBandTable[Band].upper - Lower;
+
+    for (unsigned int i = 0; i < SQLCAL_POINTS; i++)
+    {
+        SQLCAL_Tune(Lower + (Span / (2 * SQLCAL_POINTS)) * (2 * i + 1));
+        SQLCAL_Measure(&Points[i]);
+    }
+
+    // insertion sort by mean, quietest first
+    for (unsigned int i = 1; i < SQLCAL_POINTS; i++)
+    {
+        const SqlCalPoint_t Point = Points[i];
+        unsigned int        j     = i;
+
+        for (; j > 0 && Points[j - 1].Mean > Point.Mean; j--)
+            Points[j] = Points[j - 1];
+        Points[j] = Point;
+    }
+
+    uint16_t Ceiling = 0;
+    for (unsigned int i = 0; i < SQLCAL_POINTS - SQLCAL_DISCARD; i++)
+        if (Points[i].Peak > Ceiling)
+            Ceiling = Points[i].Peak;
+
+    // the settings loader drops anything outside this range
+    return (Ceiling < SQLCAL_CEILING_MIN) ? SQLCAL_CEILING_MIN :
+           (Ceiling > SQLCAL_CEILING_MAX) ? SQLCAL_CEILING_MAX : Ceiling;
+}
+
+void SQLCAL_Run(void)
+{
+    // an open squelch would play the sweep
+    if (gCurrentFunction != FUNCTION_FOREGROUND)
+        FUNCTION_Select(FUNCTION_FOREGROUND);
+
+    AUDIO_AudioPathOff();
+    gEnableSpeaker = false;
+
+    BK4819_RX_TurnOn();
+
+    for (unsigned int Band = 0; Band < BAND_N_ELEM; Band++)
+        gEeprom.SQUELCH_CAL[Band] = SQLCAL_MeasureBand((FREQUENCY_Band_t)Band);
+
+    // the caller reconfigures both VFOs, that retunes the radio
+}
+
+void SQLCAL_Clear(void)
+{
+    memset(gEeprom.SQUELCH_CAL, SQLCAL_NONE, sizeof(gEeprom.SQUELCH_CAL));
+}
+
+#endif
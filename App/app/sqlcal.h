@@ -0,0 +1,25 @@
+#ifndef APP_SQLCAL_H
+#define APP_SQLCAL_H
+
+#ifdef ENABLE_SQUELCH_CAL
+
+#include <stdint.h>
+
+// marks a band the squelch calibration has not measured
+#define SQLCAL_NONE        0xFF
+
+// range of a stored ceiling, -150 .. -60dBm; anything else loads as SQLCAL_NONE
+#define SQLCAL_CEILING_MIN 20
+#define SQLCAL_CEILING_MAX 200
+
+// Squelch calibration: sweep every band with the receiver idle and remember
+// the RSSI noise ceiling, the level an empty channel can reach there. The
+// squelch RSSI thresholds are then set relative to it instead of the factory
+// tables (see RADIO_ConfigureSquelchAndOutputPower()). Takes a couple of
+// seconds and blocks meanwhile.
+void SQLCAL_Run(void);
+void SQLCAL_Clear(void);
+
+#endif
+
+#endif
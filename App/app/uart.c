@@ -31,6 +31,7 @@
 #include "driver/crc.h"
 #include "driver/eeprom.h"
 #include "driver/gpio.h"
+#include "driver/py25q16.h"
 
 #if defined(ENABLE_UART)
 #include "driver/uart.h"
@@ -41,6 +42,7 @@
 #endif
 
 #include "functions.h"
+#include "helper/rssi.h"
 #include "misc.h"
 #include "settings.h"
 #include "version.h"
@@ -57,9 +59,6 @@
     #define DMA_CHANNEL LL_DMA_CHANNEL_2
 #endif
 
-// !! Make sure this is correct!
-#define MAX_REPLY_SIZE 144
-
 typedef struct {
     uint16_t ID;
     uint16_t Size;
@@ -187,25 +186,23 @@ typedef union
     static uint16_t VCP_ReadIndex;
 #endif
 
+#if defined(ENABLE_USB)
+    // largest reply on the wire: the 0x051C read reply with header and footer
+    #define VCP_REPLY_MAX (sizeof(Header_t) + sizeof(REPLY_051B_t) + sizeof(Footer_t))
+    _Static_assert(VCP_REPLY_MAX < CDC_TX_RING_SIZE, "a VCP reply must fit into the TX ring");
+#endif
+
 // static bool     bIsEncrypted = true;
 #define bIsEncrypted true
 
 #ifdef ENABLE_USB
 static void SendReply_VCP(void *pReply, uint16_t Size)
 {
-    static uint8_t VCP_ReplyBuf[MAX_REPLY_SIZE + sizeof(Header_t) + sizeof(Footer_t)];
-
-    // !!
-    if (Size > MAX_REPLY_SIZE)
-    {
-        return;
-    }
-
-    memcpy(VCP_ReplyBuf + sizeof(Header_t), pReply, Size);
+    Header_t Header;
+    Footer_t Footer;
 
-    Header_t *pHeader = (Header_t *)VCP_ReplyBuf;
-    Footer_t *pFooter = (Footer_t *)(VCP_ReplyBuf + sizeof(Header_t) + Size);
-    pReply = VCP_ReplyBuf + sizeof(Header_t);
+    // Never waits for the host and always fits: UART_IsCommandAvailable()
+    // holds a command back until the TX ring has room for VCP_REPLY_MAX
 
     if (bIsEncrypted)
     {
@@ -215,27 +212,24 @@ static void SendReply_VCP(void *pReply, uint16_t Size)
             pBytes[i] ^= Obfuscation[i % 16];
     }
 
-    pHeader->ID = 0xCDAB;
-    pHeader->Size = Size;
+    Header.ID = 0xCDAB;
+    Header.Size = Size;
 
-    // VCP_Send((uint8_t *)&Header, sizeof(Header));
-    // VCP_Send(pReply, Size);
-   
     if (bIsEncrypted)
     {
-        pFooter->Padding[0] = Obfuscation[(Size + 0) % 16] ^ 0xFF;
-        pFooter->Padding[1] = Obfuscation[(Size + 1) % 16] ^ 0xFF;
+        Footer.Padding[0] = Obfuscation[(Size + 0) % 16] ^ 0xFF;
+        Footer.Padding[1] = Obfuscation[(Size + 1) % 16] ^ 0xFF;
     }
     else
     {
-        pFooter->Padding[0] = 0xFF;
-        pFooter->Padding[1] = 0xFF;
+        Footer.Padding[0] = 0xFF;
+        Footer.Padding[1] = 0xFF;
     }
-    pFooter->ID = 0xBADC;
-
-    // VCP_Send((uint8_t *)&Footer, sizeof(Footer));
+    Footer.ID = 0xBADC;
 
-    VCP_SendAsync(VCP_ReplyBuf, sizeof(Header_t) + Size + sizeof(Footer_t));
+    VCP_SendAsync((const uint8_t *)&Header, sizeof(Header));
+    VCP_SendAsync(pReply, Size);
+    VCP_SendAsync((const uint8_t *)&Footer, sizeof(Footer));
 }
 #endif // ENABLE_USB
 
@@ -484,9 +478,9 @@ static void CMD_0527(uint32_t Port)
 
     Reply.Header.ID             = 0x0528;
     Reply.Header.Size           = sizeof(Reply.Data);
-    Reply.Data.RSSI             = BK4819_ReadRegister(BK4819_REG_67) & 0x01FF;
-    Reply.Data.ExNoiseIndicator = BK4819_ReadRegister(BK4819_REG_65) & 0x007F;
-    Reply.Data.GlitchIndicator  = BK4819_ReadRegister(BK4819_REG_63);
+    Reply.Data.RSSI             = RSSI_GetRaw();
+    Reply.Data.ExNoiseIndicator = RSSI_GetExNoise();
+    Reply.Data.GlitchIndicator  = RSSI_GetGlitch();
 
     SendReply(Port, &Reply, sizeof(Reply));
 }
@@ -665,6 +659,11 @@ bool UART_IsCommandAvailable(uint32_t Port)
 #if defined(ENABLE_USB)
     else if (Port == UART_PORT_VCP)
     {
+        // Leave the command where it is until its reply can be queued whole;
+        // the main loop calls again once the host has read the ring
+        if (VCP_GetTxFree() < VCP_REPLY_MAX)
+            return false;
+
         DmaLength = VCP_RxBufPointer;
         ReadBuf = VCP_RxBuf;
         ReadBufSize = sizeof(VCP_RxBuf);
@@ -845,6 +844,8 @@ void UART_HandleCommand(uint32_t Port)
 #endif
 
         case 0x05DD: // reset
+            PY25Q16_Flush();
+            UART_Flush();
             #if defined(ENABLE_OVERLAY)
                 overlay_FLASH_RebootToBootloader();
             #else
@@ -864,6 +865,11 @@ void UART_HandleCommand(uint32_t Port)
     } // switch
 
     #ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
+        #ifdef ENABLE_USB_DUAL_CDC
+            // screen stream has its own ACM port, only a UART session collides with it
+            if (Port == UART_PORT_VCP)
+                return;
+        #endif
         gUART_LockScreenshot = 20; // lock screenshot
     #endif
 }
\ No newline at end of file
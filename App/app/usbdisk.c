@@ -0,0 +1,58 @@
+#ifdef ENABLE_USB_MSC
+
+#include <string.h>
+
+#include "app/usbdisk.h"
+#include "driver/backlight.h"
+#include "driver/gpio.h"
+#include "driver/keyboard.h"
+#include "driver/st7565.h"
+#include "misc.h"
+#include "ui/helper.h"
+#include "usb_config.h"
+#include "py32f071_ll_bus.h"
+
+static void DisplayUsbDisk(void)
+{
+    memset(gStatusLine, 0, sizeof(gStatusLine));
+    UI_DisplayClear();
+
+    UI_PrintString("USB DISK", 0, 127, 1, 10);
+    UI_PrintStringSmallNormal("READ ONLY", 0, 127, 3);
+    UI_PrintStringSmallNormal("EJECT, THEN PRESS", 0, 127, 4);
+    UI_PrintStringSmallNormal("ANY KEY TO REBOOT", 0, 127, 5);
+
+    ST7565_BlitStatusLine();
+    ST7565_BlitFullScreen();
+}
+
+void USBDISK_Run(void)
+{
+    DisplayUsbDisk();
+    BACKLIGHT_TurnOn();
+
+    LL_APB1_GRP2_EnableClock(LL_APB1_GRP2_PERIPH_SYSCFG);
+    LL_IOP_GRP1_EnableClock(LL_IOP_GRP1_PERIPH_GPIOA); // PA12:11
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_USBD);
+
+    msc_disk_init();
+
+    NVIC_SetPriority(USBD_IRQn, 3);
+    NVIC_EnableIRQ(USBD_IRQn);
+
+    while (true)
+    {
+        if (!gNextTimeslice)
+            continue;
+
+        gNextTimeslice = false;
+
+        if (GPIO_IsPttPressed() || KEYBOARD_Poll() != KEY_INVALID)
+        {
+            NVIC_DisableIRQ(USBD_IRQn);
+            NVIC_SystemReset();
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef APP_USBDISK_H
+#define APP_USBDISK_H
+
+#ifdef ENABLE_USB_MSC
+
+// Boot-time USB mass-storage mode (PTT + # at power on). The radio
+// enumerates as a small read-only FAT drive holding the codeplug instead of
+// the CDC serial port, for backups; any key reboots.
+void USBDISK_Run(void) __attribute__((noreturn));
+
+#endif
+
+#endif
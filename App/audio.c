@@ -36,6 +36,87 @@
 
 BEEP_Type_t gBeepToPlay = BEEP_NONE;
 
+// Beeps are played by the BK4819 tone sequencer from the 10 ms time slice,
+// in two sequences: a short settle with the audio path off, then the tones
+// once the path is back on. Only the few ms of register set-up around
+// them still block.
+static bool              BeepActive;
+static uint16_t          BeepToneConfig;    // REG_71 to restore afterwards
+static uint16_t          BeepFrequency;
+static uint8_t           BeepCount;
+static bool              BeepLowGain;       // short key beeps, quieter tone
+static BK4819_ToneStep_t BeepSteps[4];      // lead-in plus up to three tones
+
+static const BK4819_ToneStep_t BeepSettle = { 0, 0, 2, 0 };
+
+static void AUDIO_BeepDone(void)
+{
+    AUDIO_AudioPathOff();
+
+    SYSTEM_DelayMs(5);
+    BK4819_TurnsOffTones_TurnsOnRX();
+    SYSTEM_DelayMs(5);
+    BK4819_WriteRegister(BK4819_REG_71, BeepToneConfig);
+
+#ifdef ENABLE_FMRADIO
+    const bool isFmRadio = gFmRadioMode;
+    
+    if (isFmRadio)
+        SYSTEM_DelayMs(10);
+#endif
+
+
+    if (gEnableSpeaker)
+        AUDIO_AudioPathOn();
+
+#ifdef ENABLE_FMRADIO
+    if (isFmRadio)
+        BK1080_Mute(false);
+#endif
+
+    if (gCurrentFunction == FUNCTION_POWER_SAVE && gRxIdleMode)
+        BK4819_Sleep();
+
+#ifdef ENABLE_VOX
+    gVoxResumeCountdown = 80;
+#endif
+
+    BeepActive = false;
+}
+
+static void AUDIO_BeepSettled(void)
+{
+    if (BeepLowGain)
+    {
+        BK4819_WriteRegister(BK4819_REG_70, BK4819_REG_70_ENABLE_TONE1 | ((1 & 0x7f) << BK4819_REG_70_SHIFT_TONE1_TUNING_GAIN));
+    }
+
+    BK4819_PlayTone(BeepFrequency, true);
+
+    SYSTEM_DelayMs(2);
+
+    AUDIO_AudioPathOn();
+
+    BK4819_ToneSeq_Start(BeepSteps, BeepCount, AUDIO_BeepDone);
+}
+
+bool AUDIO_IsBeeping(void)
+{
+    return BeepActive;
+}
+
+void AUDIO_BeepWait(void)
+{
+    if (!BeepActive)
+        return;
+
+    BK4819_ToneSeq_Wait();
+
+    // the sequence was taken over before it ended, restore anyway
+    if (BeepActive)
+        AUDIO_BeepDone();
+}
+
 void AUDIO_PlayBeep(BEEP_Type_t Beep)
 {
 
@@ -60,19 +141,9 @@ void AUDIO_PlayBeep(BEEP_Type_t Beep)
     if (gCurrentFunction == FUNCTION_MONITOR)
         return;
 
-#ifdef ENABLE_FMRADIO
-    if (gFmRadioMode)
-        BK1080_Mute(true);
-#endif
-
-    AUDIO_AudioPathOff();
-
-    if (gCurrentFunction == FUNCTION_POWER_SAVE && gRxIdleMode)
-        BK4819_RX_TurnOn();
-
-    SYSTEM_DelayMs(20);
-
-    uint16_t ToneConfig = BK4819_ReadRegister(BK4819_REG_71);
+    // one sequencer: let a beep or PTT-ID still playing finish first
+    AUDIO_BeepWait();
+    BK4819_ToneSeq_Wait();
 
     uint16_t ToneFrequency;
     switch (Beep)
@@ -111,104 +182,74 @@ void AUDIO_PlayBeep(BEEP_Type_t Beep)
 #endif
     }
 
-    if(Beep == BEEP_400HZ_30MS || Beep == BEEP_500HZ_30MS || Beep == BEEP_600HZ_30MS)
-    {
-        BK4819_WriteRegister(BK4819_REG_70, BK4819_REG_70_ENABLE_TONE1 | ((1 & 0x7f) << BK4819_REG_70_SHIFT_TONE1_TUNING_GAIN));
-    }
-
-    BK4819_PlayTone(ToneFrequency, true);
-
-    SYSTEM_DelayMs(2);
-
-    AUDIO_AudioPathOn();
+    uint8_t Tones;
+    uint8_t Duration_10ms;
 
-    SYSTEM_DelayMs(60);
-
-    uint16_t Duration;
+    BeepLowGain = false;
     switch (Beep)
     {
         case BEEP_880HZ_60MS_DOUBLE_BEEP:
-            BK4819_ExitTxMute();
-            SYSTEM_DelayMs(60);
-            BK4819_EnterTxMute();
-            SYSTEM_DelayMs(20);
-            [[fallthrough]];
+            Tones = 3;
+            Duration_10ms = 6;
+            break;
         case BEEP_500HZ_60MS_DOUBLE_BEEP_OPTIONAL:
         case BEEP_500HZ_60MS_DOUBLE_BEEP:
-            BK4819_ExitTxMute();
-            SYSTEM_DelayMs(60);
-            BK4819_EnterTxMute();
-            SYSTEM_DelayMs(20);
-            [[fallthrough]];
+            Tones = 2;
+            Duration_10ms = 6;
+            break;
         case BEEP_1KHZ_60MS_OPTIONAL:
-            BK4819_ExitTxMute();
-            Duration = 60;
+            Tones = 1;
+            Duration_10ms = 6;
             break;
 #ifdef ENABLE_FEAT_F4HWN
         case BEEP_400HZ_30MS:
         case BEEP_500HZ_30MS:
         case BEEP_600HZ_30MS:
-            BK4819_ExitTxMute();
-            Duration = 30;
+            Tones = 1;
+            Duration_10ms = 3;
+            BeepLowGain = true;
             break;
 #endif
         case BEEP_440HZ_500MS:
 #ifndef ENABLE_FEAT_F4HWN
         case BEEP_880HZ_200MS:
-            BK4819_ExitTxMute();
-            Duration = 200;
+            Tones = 1;
+            Duration_10ms = 20;
             break;
         case BEEP_880HZ_500MS:
 #endif
         default:
-            BK4819_ExitTxMute();
-            Duration = 500;
+            Tones = 1;
+            Duration_10ms = 50;
             break;
     }
 
-    SYSTEM_DelayMs(Duration);
-    BK4819_EnterTxMute();
-    SYSTEM_DelayMs(20);
+    // 60 ms of silence for the audio path, then the tones 20 ms apart
+    BeepSteps[0] = (BK4819_ToneStep_t){ 0, 0, 6, 0 };
+    for (uint8_t i = 1; i <= Tones; i++)
+        BeepSteps[i] = (BK4819_ToneStep_t){ ToneFrequency, 0, Duration_10ms, 2 };
 
-    AUDIO_AudioPathOff();
-
-    SYSTEM_DelayMs(5);
-    BK4819_TurnsOffTones_TurnsOnRX();
-    SYSTEM_DelayMs(5);
-    BK4819_WriteRegister(BK4819_REG_71, ToneConfig);
+    BeepCount     = Tones + 1;
+    BeepFrequency = ToneFrequency;
 
 #ifdef ENABLE_FMRADIO
-    const bool isFmRadio = gFmRadioMode;
-    
-    if (isFmRadio)
-        SYSTEM_DelayMs(10);
+    if (gFmRadioMode)
+        BK1080_Mute(true);
 #endif
 
-
-    if (gEnableSpeaker)
-        AUDIO_AudioPathOn();
-
-#ifdef ENABLE_FMRADIO
-    if (isFmRadio)
-        BK1080_Mute(false);
-#endif
+    AUDIO_AudioPathOff();
 
     if (gCurrentFunction == FUNCTION_POWER_SAVE && gRxIdleMode)
-        BK4819_Sleep();
+        BK4819_RX_TurnOn();
 
-#ifdef ENABLE_VOX
-    gVoxResumeCountdown = 80;
-#endif
+    BeepToneConfig = BK4819_ReadRegister(BK4819_REG_71);
+    BeepActive     = true;
 
+    BK4819_ToneSeq_Start(&BeepSettle, 1, AUDIO_BeepSettled);
 }
 
 #ifdef ENABLE_VOICE
 
-uint16_t gVoiceBuf[VOICE_BUF_CAP][VOICE_BUF_LEN];
-uint8_t gVoiceBufReadIndex = 0;
-uint8_t gVoiceBufWriteIndex = 0;
-uint8_t gVoiceBufLen = 0;
-
 VOICE_ID_t        gVoiceID[8];
 uint8_t           gVoiceReadIndex;
 uint8_t           gVoiceWriteIndex;
@@ -216,46 +257,16 @@ volatile uint16_t gCountdownToPlayNextVoice_10ms;
 volatile bool     gFlagPlayQueuedVoice;
 VOICE_ID_t        gAnotherVoiceID = VOICE_ID_INVALID;
 
-static const uint16_t VOICE_SAMPLES[256] = 
-{
-    0x06a8, 0x06b8, 0x0688, 0x0698, 0x06e8, 0x06f8, 0x06c8, 0x06d8, //
-    0x0628, 0x0638, 0x0608, 0x0618, 0x0668, 0x0678, 0x0648, 0x0658, //
-    0x0754, 0x075c, 0x0744, 0x074c, 0x0774, 0x077c, 0x0764, 0x076c, //
-    0x0714, 0x071c, 0x0704, 0x070c, 0x0734, 0x073c, 0x0724, 0x072c, //
-    0x02a0, 0x02e0, 0x0220, 0x0260, 0x03a0, 0x03e0, 0x0320, 0x0360, //
-    0x00a0, 0x00e0, 0x0020, 0x0060, 0x01a0, 0x01e0, 0x0120, 0x0160, //
-    0x0550, 0x0570, 0x0510, 0x0530, 0x05d0, 0x05f0, 0x0590, 0x05b0, //
-    0x0450, 0x0470, 0x0410, 0x0430, 0x04d0, 0x04f0, 0x0490, 0x04b0, //
-    0x07ea, 0x07eb, 0x07e8, 0x07e9, 0x07ee, 0x07ef, 0x07ec, 0x07ed, //
-    0x07e2, 0x07e3, 0x07e0, 0x07e1, 0x07e6, 0x07e7, 0x07e4, 0x07e5, //
-    0x07fa, 0x07fb, 0x07f8, 0x07f9, 0x07fe, 0x07ff, 0x07fc, 0x07fd, //
-    0x07f2, 0x07f3, 0x07f0, 0x07f1, 0x07f6, 0x07f7, 0x07f4, 0x07f5, //
-    0x07aa, 0x07ae, 0x07a2, 0x07a6, 0x07ba, 0x07be, 0x07b2, 0x07b6, //
-    0x078a, 0x078e, 0x0782, 0x0786, 0x079a, 0x079e, 0x0792, 0x0796, //
-    0x07d5, 0x07d7, 0x07d1, 0x07d3, 0x07dd, 0x07df, 0x07d9, 0x07db, //
-    0x07c5, 0x07c7, 0x07c1, 0x07c3, 0x07cd, 0x07cf, 0x07c9, 0x07cb, //
-    0x0958, 0x0948, 0x0978, 0x0968, 0x0918, 0x0908, 0x0938, 0x0928, //
-    0x09d8, 0x09c8, 0x09f8, 0x09e8, 0x0998, 0x0988, 0x09b8, 0x09a8, //
-    0x08ac, 0x08a4, 0x08bc, 0x08b4, 0x088c, 0x0884, 0x089c, 0x0894, //
-    0x08ec, 0x08e4, 0x08fc, 0x08f4, 0x08cc, 0x08c4, 0x08dc, 0x08d4, //
-    0x0d60, 0x0d20, 0x0de0, 0x0da0, 0x0c60, 0x0c20, 0x0ce0, 0x0ca0, //
-    0x0f60, 0x0f20, 0x0fe0, 0x0fa0, 0x0e60, 0x0e20, 0x0ee0, 0x0ea0, //
-    0x0ab0, 0x0a90, 0x0af0, 0x0ad0, 0x0a30, 0x0a10, 0x0a70, 0x0a50, //
-    0x0bb0, 0x0b90, 0x0bf0, 0x0bd0, 0x0b30, 0x0b10, 0x0b70, 0x0b50, //
-    0x0815, 0x0814, 0x0817, 0x0816, 0x0811, 0x0810, 0x0813, 0x0812, //
-    0x081d, 0x081c, 0x081f, 0x081e, 0x0819, 0x0818, 0x081b, 0x081a, //
-    0x0805, 0x0804, 0x0807, 0x0806, 0x0801, 0x0800, 0x0803, 0x0802, //
-    0x080d, 0x080c, 0x080f, 0x080e, 0x0809, 0x0808, 0x080b, 0x080a, //
-    0x0856, 0x0852, 0x085e, 0x085a, 0x0846, 0x0842, 0x084e, 0x084a, //
-    0x0876, 0x0872, 0x087e, 0x087a, 0x0866, 0x0862, 0x086e, 0x086a, //
-    0x082b, 0x0829, 0x082f, 0x082d, 0x0823, 0x0821, 0x0827, 0x0825, //
-    0x083b, 0x0839, 0x083f, 0x083d, 0x0833, 0x0831, 0x0837, 0x0835 //
-};
+// set in the index entry size of an IMA ADPCM clip, 8-bit clips leave it clear
+#define VOICE_CLIP_ADPCM 0x80000000u
 
 static struct
 {
-    uint32_t Addr;
-    uint32_t Size;
+    uint32_t       Addr;
+    uint32_t       Size;
+    VOICE_Format_t Format;
+    int16_t        Predictor;
+    uint8_t        StepIndex;
 } VoiceClipState = {0};
 
 static bool LoadVoiceClip(uint8_t VoiceID)
@@ -273,71 +284,102 @@ static bool LoadVoiceClip(uint8_t VoiceID)
     } Info;
     PY25Q16_ReadBuffer(Addr + 8 * VoiceID, &Info, 8);
 
-    if (Info.Offset > 0x0b0000 || Info.Size > 0x019000)
+    const bool Adpcm = (Info.Size & VOICE_CLIP_ADPCM) != 0;
+    Info.Size &= ~VOICE_CLIP_ADPCM;
+
+    if (Info.Offset > 0x0b0000 || Info.Size == 0 || Info.Size > 0x019000)
     {
         return false;
     }
 
-    VoiceClipState.Addr = 0x14d000 + Info.Offset;
-    VoiceClipState.Size = Info.Size;
+    VoiceClipState.Addr   = 0x14d000 + Info.Offset;
+    VoiceClipState.Size   = Info.Size;
+    VoiceClipState.Format = VOICE_FORMAT_LAW8;
+
+    if (Adpcm)
+    {   // the clip starts with the decoder state: predictor, step index, pad
+        struct
+        {
+            int16_t Predictor;
+            uint8_t StepIndex;
+            uint8_t Pad;
+        } Header;
+
+        if (Info.Size <= sizeof(Header))
+        {
+            return false;
+        }
+
+        PY25Q16_ReadBuffer(VoiceClipState.Addr, &Header, sizeof(Header));
+        VoiceClipState.Addr     += sizeof(Header);
+        VoiceClipState.Size     -= sizeof(Header);
+        VoiceClipState.Format    = VOICE_FORMAT_ADPCM4;
+        VoiceClipState.Predictor = Header.Predictor;
+        VoiceClipState.StepIndex = Header.StepIndex;
+    }
+
     return true;
 }
 
-static inline uint32_t CalcDelay(uint32_t Size)
+// clip length in 10ms units, 8000 samples/s
+static uint16_t VoiceClipLength(void)
 {
-    return 2 * Size; // in ms!!
+    return (VoiceClipState.Format == VOICE_FORMAT_ADPCM4) ? VoiceClipState.Size / 40 : VoiceClipState.Size / 80;
 }
 
-static void LoadVoiceSamples()
+void AUDIO_VoiceStream(void)
 {
-    if (0 == VoiceClipState.Addr || 0 == VoiceClipState.Size)
-    {
-        return;
-    }
-    if (gVoiceBufLen >= VOICE_BUF_CAP)
+    uint8_t Buf[64];
+
+    while (VoiceClipState.Size > 0)
     {
-        return;
-    }
+        uint32_t Size = VOICE_StreamFree();
 
-    extern uint8_t **gFrameBuffer;
-    uint8_t *Buf = (uint8_t *)gFrameBuffer;
-    PY25Q16_ReadBuffer(VoiceClipState.Addr, Buf, VOICE_BUF_LEN);
-    VoiceClipState.Addr += VOICE_BUF_LEN;
-    VoiceClipState.Size -= VOICE_BUF_LEN;
+        if (Size > sizeof(Buf))
+            Size = sizeof(Buf);
+        if (Size > VoiceClipState.Size)
+            Size = VoiceClipState.Size;
+        if (Size == 0)
+            return;
 
-    for (uint32_t i = 0; i < VOICE_BUF_LEN; i++)
-    {
-        gVoiceBuf[gVoiceBufWriteIndex][i] = VOICE_SAMPLES[Buf[i]];
+        PY25Q16_ReadBuffer(VoiceClipState.Addr, Buf, Size);
+        VoiceClipState.Addr += Size;
+        VoiceClipState.Size -= Size;
+
+        VOICE_StreamWrite(Buf, Size);
     }
-    VOICE_BUF_ForwardWriteIndex();
-    gVoiceBufLen++;
+}
+
+// start playing a clip, returns its length in 10ms units, 0 if there is none
+static uint16_t AUDIO_PlayVoice(uint8_t VoiceID)
+{
+    VOICE_Stop();
+    VoiceClipState.Size = 0;
+
+    if (!LoadVoiceClip(VoiceID))
+        return 0;
+
+    const uint16_t Length = VoiceClipLength();
+
+    AUDIO_VoiceStream();
+    VOICE_Start(VoiceClipState.Format, VoiceClipState.Predictor, VoiceClipState.StepIndex);
+
+    return Length;
 }
 
 void AUDIO_PlaySingleVoice(bool bFlag)
 {
-    uint8_t VoiceID;
-    uint8_t Delay;
+    uint8_t  VoiceID;
+    uint16_t Delay;
 
     VoiceID = gVoiceID[0];
 
     if (gEeprom.VOICE_PROMPT != VOICE_PROMPT_OFF && gVoiceWriteIndex > 0)
     {
-        if (gEeprom.VOICE_PROMPT == VOICE_PROMPT_CHINESE)
-        {   // Chinese
-            if (VoiceID >= ARRAY_SIZE(VoiceClipLengthChinese))
-                goto Bailout;
+        if (VoiceID >= VOICE_ID_END)
+            goto Bailout;
 
-            Delay    = VoiceClipLengthChinese[VoiceID];
-            VoiceID += VOICE_ID_CHI_BASE;
-        }
-        else
-        {   // English
-            if (VoiceID >= ARRAY_SIZE(VoiceClipLengthEnglish))
-                goto Bailout;
-
-            Delay    = VoiceClipLengthEnglish[VoiceID];
-            VoiceID += VOICE_ID_ENG_BASE;
-        }
+        AUDIO_BeepWait();   // a key beep goes out before the prompt
 
         if (FUNCTION_IsRx())   // 1of11
             BK4819_SetAF(BK4819_AF_MUTE);
@@ -354,14 +396,22 @@ void AUDIO_PlaySingleVoice(bool bFlag)
         #endif
 
         SYSTEM_DelayMs(5);
-        AUDIO_PlayVoice(VoiceID);
+        Delay = AUDIO_PlayVoice(VoiceID);
+        if (Delay == 0)
+            Delay = 1;      // no clip, keep the queue going and restore the audio
 
         if (gVoiceWriteIndex == 1)
             Delay += 3;
 
         if (bFlag)
         {
-            SYSTEM_DelayMs(Delay * 10);
+            // nobody else feeds the stream while we wait here
+            while (Delay-- > 0)
+            {
+                AUDIO_VoiceStream();
+                SYSTEM_DelayMs(10);
+            }
+            VOICE_Stop();
 
             if (FUNCTION_IsRx())    // 1of11
                 RADIO_SetModulation(gRxVfo->Modulation);
@@ -452,45 +502,19 @@ Skip:
 
 void AUDIO_PlayQueuedVoice(void)
 {
-    uint8_t VoiceID;
-    uint8_t Delay;
-    bool    Skip;
-
-    Skip = false;
+    uint16_t Delay;
 
     if (gVoiceReadIndex != gVoiceWriteIndex && gEeprom.VOICE_PROMPT != VOICE_PROMPT_OFF)
     {
-        VoiceID = gVoiceID[gVoiceReadIndex];
-        if (gEeprom.VOICE_PROMPT == VOICE_PROMPT_CHINESE)
-        {
-            if (VoiceID < ARRAY_SIZE(VoiceClipLengthChinese))
-            {
-                Delay = VoiceClipLengthChinese[VoiceID];
-                VoiceID += VOICE_ID_CHI_BASE;
-            }
-            else
-                Skip = true;
-        }
-        else
-        {
-            if (VoiceID < ARRAY_SIZE(VoiceClipLengthEnglish))
-            {
-                Delay = VoiceClipLengthEnglish[VoiceID];
-                VoiceID += VOICE_ID_ENG_BASE;
-            }
-            else
-                Skip = true;
-        }
+        Delay = AUDIO_PlayVoice(gVoiceID[gVoiceReadIndex]);
 
         gVoiceReadIndex++;
 
-        if (!Skip)
+        if (Delay > 0)
         {
             if (gVoiceReadIndex == gVoiceWriteIndex)
                 Delay += 3;
 
-            AUDIO_PlayVoice(VoiceID);
-
             gCountdownToPlayNextVoice_10ms = Delay;
             gFlagPlayQueuedVoice           = false;
 
@@ -515,6 +539,8 @@ void AUDIO_PlayQueuedVoice(void)
     if (!gEnableSpeaker)
         AUDIO_AudioPathOff();
 
+    VOICE_Stop();
+
     #ifdef ENABLE_VOX
         gVoxResumeCountdown = 80;
     #endif
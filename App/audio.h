@@ -46,6 +46,9 @@ typedef enum BEEP_Type_t BEEP_Type_t;
 extern BEEP_Type_t       gBeepToPlay;
 
 void AUDIO_PlayBeep(BEEP_Type_t Beep);
+bool AUDIO_IsBeeping(void);
+// Plays out a beep still in progress, for code about to reuse the BK4819
+void AUDIO_BeepWait(void);
 
 #define AUDIO_AudioPathOn() GPIO_EnableAudioPath()
 
@@ -153,6 +156,7 @@ void AUDIO_PlayBeep(BEEP_Type_t Beep);
     void    AUDIO_SetVoiceID(uint8_t Index, VOICE_ID_t VoiceID);
     uint8_t AUDIO_SetDigitVoice(uint8_t Index, uint16_t Value);
     void    AUDIO_PlayQueuedVoice(void);
+    void    AUDIO_VoiceStream(void);
 #endif
 
 #endif
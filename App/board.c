@@ -25,6 +25,9 @@
 #include "py32f071_ll_gpio.h"
 #include "py32f071_ll_rcc.h"
 #include "py32f071_ll_adc.h"
+#include "py32f071_ll_dma.h"
+#include "py32f071_ll_system.h"
+#include "py32f071_ll_tim.h"
 #include "driver/voice.h"
 #include "driver/backlight.h"
 #ifdef ENABLE_FMRADIO
@@ -135,6 +138,17 @@ void BOARD_GPIO_Init(void)
 #endif // ENABLE_SWD
 }
 
+// The battery voltage is sampled in the background: TIM3 triggers a
+// conversion ADC_RATE_HZ times a second and DMA1 channel 6 drops the results
+// into a ring, so the last 3.2 s are always at hand without waiting on the ADC.
+#define ADC_TIMx            TIM3
+#define ADC_DMA_CHANNEL     LL_DMA_CHANNEL_6
+#define ADC_RATE_HZ         20
+#define ADC_RING_LEN        64
+
+static volatile uint16_t AdcRing[ADC_RING_LEN];
+static bool              AdcRingFull;
+
 void BOARD_ADC_Init(void)
 {
     LL_IOP_GRP1_EnableClock(LL_IOP_GRP1_PERIPH_GPIOB);
@@ -147,33 +161,100 @@ void BOARD_ADC_Init(void)
     LL_ADC_SetResolution(ADC1, LL_ADC_RESOLUTION_12B);
     LL_ADC_SetDataAlignment(ADC1, LL_ADC_DATA_ALIGN_RIGHT);
     LL_ADC_SetSequencersScanMode(ADC1, LL_ADC_SEQ_SCAN_DISABLE);
-    LL_ADC_REG_SetTriggerSource(ADC1, LL_ADC_REG_TRIG_SOFTWARE);
+    LL_ADC_REG_SetTriggerSource(ADC1, LL_ADC_REG_TRIG_EXT_TIM3_TRGO);
     LL_ADC_REG_SetContinuousMode(ADC1, LL_ADC_REG_CONV_SINGLE);
-    LL_ADC_REG_SetDMATransfer(ADC1, LL_ADC_REG_DMA_TRANSFER_NONE);
+    LL_ADC_REG_SetDMATransfer(ADC1, LL_ADC_REG_DMA_TRANSFER_UNLIMITED);
     LL_ADC_REG_SetSequencerLength(ADC1, LL_ADC_REG_SEQ_SCAN_DISABLE);
     LL_ADC_REG_SetSequencerDiscont(ADC1, LL_ADC_REG_SEQ_DISCONT_DISABLE);
     LL_ADC_REG_SetSequencerDiscont(ADC1, LL_ADC_REG_SEQ_DISCONT_DISABLE);
     LL_ADC_REG_SetSequencerRanks(ADC1, LL_ADC_REG_RANK_1, LL_ADC_CHANNEL_8);
-    LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_8, LL_ADC_SAMPLINGTIME_41CYCLES_5);
+    // a few conversions a second, so take the longest sample time the divider likes best
+    LL_ADC_SetChannelSamplingTime(ADC1, LL_ADC_CHANNEL_8, LL_ADC_SAMPLINGTIME_239CYCLES_5);
 
     LL_ADC_StartCalibration(ADC1);
     while (LL_ADC_IsCalibrationOnGoing(ADC1))
         ;
 
     LL_ADC_Enable(ADC1);
+
+    LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1);
+    LL_APB1_GRP2_EnableClock(LL_APB1_GRP2_PERIPH_SYSCFG);
+    LL_SYSCFG_SetDMARemap(DMA1, ADC_DMA_CHANNEL, LL_SYSCFG_DMA_MAP_ADC1);
+
+    LL_DMA_ConfigTransfer(DMA1, ADC_DMA_CHANNEL,                //
+                          LL_DMA_DIRECTION_PERIPH_TO_MEMORY     //
+                              | LL_DMA_MODE_CIRCULAR            //
+                              | LL_DMA_PERIPH_NOINCREMENT       //
+                              | LL_DMA_MEMORY_INCREMENT         //
+                              | LL_DMA_PDATAALIGN_HALFWORD      //
+                              | LL_DMA_MDATAALIGN_HALFWORD      //
+                              | LL_DMA_PRIORITY_LOW             //
+    );
+    LL_DMA_SetPeriphAddress(DMA1, ADC_DMA_CHANNEL, LL_ADC_DMA_GetRegAddr(ADC1, LL_ADC_DMA_REG_REGULAR_DATA));
+    LL_DMA_SetMemoryAddress(DMA1, ADC_DMA_CHANNEL, (uint32_t)AdcRing);
+    LL_DMA_SetDataLength(DMA1, ADC_DMA_CHANNEL, ADC_RING_LEN);
+    LL_DMA_EnableChannel(DMA1, ADC_DMA_CHANNEL);
+
+    LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_TIM3);
+    LL_TIM_SetPrescaler(ADC_TIMx, SystemCoreClock / 1000 - 1);
+    LL_TIM_SetAutoReload(ADC_TIMx, 1000 / ADC_RATE_HZ - 1);
+    LL_TIM_SetTriggerOutput(ADC_TIMx, LL_TIM_TRGO_UPDATE);
+
+    LL_ADC_REG_StartConversionExtTrig(ADC1, LL_ADC_REG_TRIG_EXT_RISING);
+
+    // loads the prescaler and converts once, the first reader needn't wait a period
+    LL_TIM_GenerateEvent_UPDATE(ADC_TIMx);
+    LL_TIM_EnableCounter(ADC_TIMx);
 }
 
+// Mean of the ring, 64x oversampled once it has filled. Never blocks except
+// for the one conversion right after BOARD_ADC_Init().
 void BOARD_ADC_GetBatteryInfo(uint16_t *pVoltage, uint16_t *pCurrent)
 {
-    LL_ADC_REG_StartConversionSWStart(ADC1);
-    while (!LL_ADC_IsActiveFlag_EOS(ADC1))
-        ;
-    LL_ADC_ClearFlag_JEOS(ADC1);
+    unsigned int Count = ADC_RING_LEN;
+
+    if (!AdcRingFull)
+    {
+        if (LL_DMA_IsActiveFlag_TC6(DMA1))
+            AdcRingFull = true;
+        else
+            while ((Count = ADC_RING_LEN - LL_DMA_GetDataLength(DMA1, ADC_DMA_CHANNEL)) == 0)
+                ;
+    }
+
+    uint32_t Sum = 0;
+    for (unsigned int i = 0; i < Count; i++)
+        Sum += AdcRing[i];
+
+    *pVoltage = (Sum + Count / 2) / Count;
 
-    *pVoltage = LL_ADC_REG_ReadConversionData12(ADC1);
+    // no current sense is wired to the ADC on this board (PB1 is left
+    // unconverted, as before), callers only ever saw 0 here
     *pCurrent = 0;
 }
 
+// Least-squares slope over the ring in ADC counts per minute: positive while
+// the voltage recovers or charges, negative under load. 0 until the ring has
+// filled once.
+int16_t BOARD_ADC_GetBatterySlope(void)
+{
+    if (!AdcRingFull)
+        return 0;
+
+    // the oldest sample is the one DMA overwrites next
+    const unsigned int Head = ADC_RING_LEN - LL_DMA_GetDataLength(DMA1, ADC_DMA_CHANNEL);
+
+    // weights 2i - 63 are odd and sum to 0, |Sum| < 4095 * 1024
+    int32_t Sum = 0;
+    for (unsigned int i = 0; i < ADC_RING_LEN; i++)
+        Sum += (int32_t)(2 * i - (ADC_RING_LEN - 1)) * AdcRing[(Head + i) % ADC_RING_LEN];
+
+    // 2 * Sum / (64 * (64^2 - 1) / 3) per sample, 60 * 20 samples a minute
+    Sum = Sum * 5 / 182;
+
+    return (Sum > INT16_MAX) ? INT16_MAX : (Sum < INT16_MIN) ? INT16_MIN : Sum;
+}
+
 void BOARD_Init(void)
 {
     BOARD_GPIO_Init();
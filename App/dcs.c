@@ -63,6 +63,24 @@ uint32_t DCS_GetGolayCodeWord(DCS_CodeType_t CodeType, uint8_t Option)
     return Code;
 }
 
+// DCS_Options is sorted, so the 9 data bits are looked up by bisection
+static uint8_t DCS_FindOption(uint16_t Data)
+{
+    unsigned int Lo = 0;
+    unsigned int Hi = ARRAY_SIZE(DCS_Options);
+
+    while (Lo < Hi)
+    {
+        const unsigned int Mid = (Lo + Hi) / 2;
+        if (DCS_Options[Mid] < Data)
+            Lo = Mid + 1;
+        else
+            Hi = Mid;
+    }
+
+    return (Lo < ARRAY_SIZE(DCS_Options) && DCS_Options[Lo] == Data) ? Lo : 0xFF;
+}
+
 uint8_t DCS_GetCdcssCode(uint32_t Code)
 {
     unsigned int i;
@@ -70,13 +88,13 @@ uint8_t DCS_GetCdcssCode(uint32_t Code)
     {
         uint32_t Shift;
 
+        // only a candidate with the 100 marker, a known code and matching
+        // parity is a hit, the Golay check runs on the last one only
         if (((Code >> 9) & 0x7U) == 4)
         {
-            unsigned int j;
-            for (j = 0; j < ARRAY_SIZE(DCS_Options); j++)
-                if (DCS_Options[j] == (Code & 0x1FF))
-                    if (DCS_GetGolayCodeWord(2, j) == Code)
-                        return j;
+            const uint8_t j = DCS_FindOption(Code & 0x1FF);
+            if (j != 0xFF && DCS_GetGolayCodeWord(2, j) == Code)
+                return j;
         }
 
         Shift = Code >> 1;
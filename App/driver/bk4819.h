@@ -63,6 +63,31 @@ enum BK4819_CssScanResult_t
 
 typedef enum BK4819_CssScanResult_t BK4819_CssScanResult_t;
 
+// one tone (pair) of a BK4819_ToneSeq_Start() sequence, Tone1 0 for silence
+typedef struct
+{
+    uint16_t Tone1;     // Hz
+    uint16_t Tone2;     // Hz
+    uint8_t  On_10ms;
+    uint8_t  Off_10ms;  // TX muted
+} BK4819_ToneStep_t;
+
+typedef void (*BK4819_ToneDone_t)(void);
+
+#define BK4819_IMAGE_MAX 32
+
+// A recorded setup: the writes made between BK4819_ImageBegin() and
+// BK4819_ImageEnd(), in order, with repeated writes to a plain register folded
+// into one. BK4819_ImageApply() replays it, skipping registers that already
+// hold the value.
+typedef struct
+{
+    uint8_t  Count;     // 0 = not recorded
+    uint8_t  GpioMask;  // REG_33 bits set or cleared while recording
+    uint8_t  Reg[BK4819_IMAGE_MAX];
+    uint16_t Value[BK4819_IMAGE_MAX];
+} BK4819_Image_t;
+
 // radio is asleep, not listening
 extern bool gRxIdleMode;
 
@@ -73,6 +98,10 @@ void     BK4819_SetRegValue(RegisterSpec s, uint16_t v);
 void     BK4819_WriteU8(uint8_t Data);
 void     BK4819_WriteU16(uint16_t Data);
 
+void     BK4819_ImageBegin(BK4819_Image_t *pImage);
+bool     BK4819_ImageEnd(void);
+void     BK4819_ImageApply(const BK4819_Image_t *pImage);
+
 void     BK4819_SetAGC(bool enable);
 void     BK4819_InitAGC(bool amModulation);
 
@@ -131,8 +160,14 @@ void     BK4819_EnterDTMF_TX(bool bLocalLoopback);
 void     BK4819_ExitDTMF_TX(bool bKeep);
 void     BK4819_EnableTXLink(void);
 
+bool     BK4819_GetDTMFTones(char Code, uint16_t *pTone1, uint16_t *pTone2);
 void     BK4819_PlayDTMF(char Code);
-void     BK4819_PlayDTMFString(const char *pString, bool bDelayFirst, uint16_t FirstCodePersistTime, uint16_t HashCodePersistTime, uint16_t CodePersistTime, uint16_t CodeInternalTime);
+
+void     BK4819_ToneSeq_Start(const BK4819_ToneStep_t *pSteps, unsigned int Count, BK4819_ToneDone_t Done);
+void     BK4819_ToneSeq_TimeSlice10ms(void);
+bool     BK4819_ToneSeq_IsBusy(void);
+void     BK4819_ToneSeq_Wait(void);
+void     BK4819_ToneSeq_Stop(void);
 
 void     BK4819_TransmitTone(bool bLocalLoopback, uint32_t Frequency);
 
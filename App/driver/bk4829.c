@@ -17,6 +17,7 @@
 
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "settings.h"
 #include "misc.h"
@@ -39,6 +40,13 @@ static const uint16_t FSK_RogerTable[7] = {0xF1A2, 0x7446, 0x61A4, 0x6544, 0x4E8
 
 static uint16_t gBK4819_GpioOutState;
 
+// last value written to each register, to skip rewriting it from an image
+static uint16_t BK4819_Shadow[0x80];
+static uint32_t BK4819_ShadowValid[0x80 / 32];
+
+static BK4819_Image_t *BK4819_pImage;       // recording, writes go here
+static uint16_t        BK4819_ImageGpioOutState;
+
 bool gRxIdleMode;
 
 static inline void CS_Assert()
@@ -213,10 +221,108 @@ static uint16_t BK4819_ReadU16(void)
     return Value;
 }
 
+// writes that trigger something in the chip, or land in one of several hidden
+// registers picked by the value: each one counts, as does their order
+static inline bool BK4819_IsCommandRegister(BK4819_REGISTER_t Register)
+{
+    return Register == BK4819_REG_00 || Register == BK4819_REG_02 || Register == BK4819_REG_07 ||
+           Register == BK4819_REG_08 || Register == BK4819_REG_30 || Register == BK4819_REG_5F;
+}
+
+static inline bool BK4819_ShadowMatches(BK4819_REGISTER_t Register, uint16_t Data)
+{
+    const unsigned int i = Register & 0x7F;
+    return (BK4819_ShadowValid[i / 32] & (1u << (i % 32))) && BK4819_Shadow[i] == Data;
+}
+
+static int BK4819_ImageFind(BK4819_REGISTER_t Register)
+{
+    for (int i = BK4819_pImage->Count - 1; i >= 0; i--)
+        if (BK4819_pImage->Reg[i] == Register)
+            return i;
+    return -1;
+}
+
+static void BK4819_ImageAdd(BK4819_REGISTER_t Register, uint16_t Data)
+{
+    BK4819_Image_t *pImage = BK4819_pImage;
+
+    if (!BK4819_IsCommandRegister(Register))
+    {
+        const int i = BK4819_ImageFind(Register);
+        if (i >= 0)
+        {
+            pImage->Value[i] = Data;
+            return;
+        }
+    }
+
+    // one past the end marks an overflow, BK4819_ImageEnd() reports it
+    if (pImage->Count < BK4819_IMAGE_MAX)
+    {
+        pImage->Reg[pImage->Count]   = Register;
+        pImage->Value[pImage->Count] = Data;
+    }
+    if (pImage->Count <= BK4819_IMAGE_MAX)
+        pImage->Count++;
+}
+
+void BK4819_ImageBegin(BK4819_Image_t *pImage)
+{
+    pImage->Count    = 0;
+    pImage->GpioMask = 0;
+
+    BK4819_ImageGpioOutState = gBK4819_GpioOutState;
+    BK4819_pImage            = pImage;
+}
+
+bool BK4819_ImageEnd(void)
+{
+    BK4819_Image_t *pImage = BK4819_pImage;
+
+    BK4819_pImage        = NULL;
+    gBK4819_GpioOutState = BK4819_ImageGpioOutState;
+
+    if (pImage->Count > BK4819_IMAGE_MAX)
+    {
+        pImage->Count = 0;
+        return false;
+    }
+
+    return true;
+}
+
+void BK4819_ImageApply(const BK4819_Image_t *pImage)
+{
+    for (unsigned int i = 0; i < pImage->Count; i++)
+    {
+        const BK4819_REGISTER_t Register = pImage->Reg[i];
+        uint16_t                Value    = pImage->Value[i];
+
+        if (Register == BK4819_REG_33)
+        {   // only the pins the setup drives, the LEDs etc. stay as they are now
+            Value = (gBK4819_GpioOutState & ~pImage->GpioMask) | (Value & pImage->GpioMask);
+            gBK4819_GpioOutState = Value;
+        }
+
+        if (!BK4819_IsCommandRegister(Register) && BK4819_ShadowMatches(Register, Value))
+            continue;
+
+        BK4819_WriteRegister(Register, Value);
+    }
+}
+
 uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
 {
     uint16_t Value;
 
+    if (BK4819_pImage)
+    {   // read-modify-write while recording, build on what is recorded so far
+        const int i = BK4819_IsCommandRegister(Register) ? -1 : BK4819_ImageFind(Register);
+        if (i >= 0)
+            return BK4819_pImage->Value[i];
+    }
+
     CS_Release();
     SCL_Reset();
 
@@ -237,6 +343,23 @@ uint16_t BK4819_ReadRegister(BK4819_REGISTER_t Register)
 
 void BK4819_WriteRegister(BK4819_REGISTER_t Register, uint16_t Data)
 {
+    if (BK4819_pImage)
+    {
+        BK4819_ImageAdd(Register, Data);
+        return;
+    }
+
+    if (Register == BK4819_REG_00)
+    {   // soft reset, nothing we wrote before holds any more
+        memset(BK4819_ShadowValid, 0, sizeof(BK4819_ShadowValid));
+    }
+    else
+    {
+        const unsigned int i = Register & 0x7F;
+        BK4819_Shadow[i] = Data;
+        BK4819_ShadowValid[i / 32] |= 1u << (i % 32);
+    }
+
     CS_Release();
     SCL_Reset();
 
@@ -408,6 +531,9 @@ int16_t BK4819_GetRSSI_dBm(void)
 
 void BK4819_ToggleGpioOut(BK4819_GPIO_PIN_t Pin, bool bSet)
 {
+    if (BK4819_pImage)
+        BK4819_pImage->GpioMask |= 0x40u >> Pin;
+
     if (bSet)
         gBK4819_GpioOutState |=  (0x40u >> Pin);
     else
@@ -1289,15 +1415,9 @@ void BK4819_EnableTXLink(void)
         BK4819_REG_30_DISABLE_RX_DSP);
 }
 
-void BK4819_PlayDTMF(char Code)
+bool BK4819_GetDTMFTones(char Code, uint16_t *pTone1, uint16_t *pTone2)
 {
-
-    struct DTMF_TonePair {
-        uint16_t tone1;
-        uint16_t tone2;
-    };
-
-    const struct DTMF_TonePair tones[] = {
+    static const uint16_t tones[16][2] = {
         {941, 1336},
         {697, 1209},
         {697, 1336},
@@ -1316,48 +1436,141 @@ void BK4819_PlayDTMF(char Code)
         {941, 1477},
     };
 
-
-    const struct DTMF_TonePair *pSelectedTone = NULL;
+    unsigned int i;
     switch (Code)
     {
-        case '0'...'9': pSelectedTone = &tones[0  + Code - '0']; break;
-        case 'A'...'D': pSelectedTone = &tones[10 + Code - 'A']; break;
-        case '*': pSelectedTone = &tones[14]; break;
-        case '#': pSelectedTone = &tones[15]; break;
-        default: pSelectedTone = NULL;
+        case '0'...'9': i = 0  + Code - '0'; break;
+        case 'A'...'D': i = 10 + Code - 'A'; break;
+        case '*': i = 14; break;
+        case '#': i = 15; break;
+        default: return false;
     }
 
-    if (pSelectedTone) {
-        BK4819_WriteRegister(BK4819_REG_71, (((uint32_t)pSelectedTone->tone1 * 103244) + 5000) / 10000);   // with rounding
-        BK4819_WriteRegister(BK4819_REG_72, (((uint32_t)pSelectedTone->tone2 * 103244) + 5000) / 10000);   // with rounding
+    *pTone1 = tones[i][0];
+    *pTone2 = tones[i][1];
+    return true;
+}
+
+static void SetDTMFTones(uint16_t Tone1, uint16_t Tone2)
+{
+    BK4819_WriteRegister(BK4819_REG_71, (((uint32_t)Tone1 * 103244) + 5000) / 10000);   // with rounding
+    BK4819_WriteRegister(BK4819_REG_72, (((uint32_t)Tone2 * 103244) + 5000) / 10000);   // with rounding
+}
+
+void BK4819_PlayDTMF(char Code)
+{
+    uint16_t Tone1, Tone2;
+
+    if (BK4819_GetDTMFTones(Code, &Tone1, &Tone2))
+        SetDTMFTones(Tone1, Tone2);
+}
+
+// Tone sequencer, stepped from the 10 ms time slice so the main loop keeps
+// running while PTT-ID and DTMF replies go out. The caller owns the step
+// list and sets up the tone generator (BK4819_EnterDTMF_TX) beforehand.
+static const BK4819_ToneStep_t *ToneSeqSteps;
+static uint8_t                  ToneSeqCount;
+static uint8_t                  ToneSeqIndex;
+static uint8_t                  ToneSeqCountdown;
+static bool                     ToneSeqGap;
+static BK4819_ToneDone_t        ToneSeqDone;
+
+static void ToneSeqBeginStep(void)
+{
+    const BK4819_ToneStep_t *pStep = &ToneSeqSteps[ToneSeqIndex];
+
+    if (pStep->Tone1)
+    {
+        SetDTMFTones(pStep->Tone1, pStep->Tone2);
+        BK4819_ExitTxMute();
     }
+    // a silent step leaves the TX mute alone
+
+    ToneSeqCountdown = pStep->On_10ms;
+    ToneSeqGap       = false;
 }
 
-void BK4819_PlayDTMFString(const char *pString, bool bDelayFirst, uint16_t FirstCodePersistTime, uint16_t HashCodePersistTime, uint16_t CodePersistTime, uint16_t CodeInternalTime)
+void BK4819_ToneSeq_Start(const BK4819_ToneStep_t *pSteps, unsigned int Count, BK4819_ToneDone_t Done)
 {
-    unsigned int i;
+    ToneSeqSteps = NULL;
+
+    if (Count == 0)
+    {
+        if (Done)
+            Done();
+        return;
+    }
+
+    ToneSeqSteps = pSteps;
+    ToneSeqCount = Count;
+    ToneSeqIndex = 0;
+    ToneSeqDone  = Done;
+
+    ToneSeqBeginStep();
+
+    // started between two slices, don't let the first step run short
+    ToneSeqCountdown++;
+}
+
+void BK4819_ToneSeq_TimeSlice10ms(void)
+{
+    if (ToneSeqSteps == NULL)
+        return;
 
-    if (pString == NULL)
+    if (ToneSeqCountdown && --ToneSeqCountdown)
         return;
 
-    for (i = 0; pString[i]; i++)
+    if (!ToneSeqGap)
     {
-        uint16_t Delay;
-        BK4819_PlayDTMF(pString[i]);
-        BK4819_ExitTxMute();
-        if (bDelayFirst && i == 0)
-            Delay = FirstCodePersistTime;
-        else
-        if (pString[i] == '*' || pString[i] == '#')
-            Delay = HashCodePersistTime;
-        else
-            Delay = CodePersistTime;
-        SYSTEM_DelayMs(Delay);
-        BK4819_EnterTxMute();
-        SYSTEM_DelayMs(CodeInternalTime);
+        if (ToneSeqSteps[ToneSeqIndex].Tone1)
+            BK4819_EnterTxMute();
+
+        ToneSeqGap       = true;
+        ToneSeqCountdown = ToneSeqSteps[ToneSeqIndex].Off_10ms;
+        if (ToneSeqCountdown)
+            return;
+    }
+
+    if (++ToneSeqIndex < ToneSeqCount)
+    {
+        ToneSeqBeginStep();
+        return;
+    }
+
+    const BK4819_ToneDone_t Done = ToneSeqDone;
+
+    ToneSeqSteps = NULL;
+    ToneSeqDone  = NULL;
+
+    if (Done)
+        Done();
+}
+
+bool BK4819_ToneSeq_IsBusy(void)
+{
+    return ToneSeqSteps != NULL;
+}
+
+void BK4819_ToneSeq_Wait(void)
+{
+    while (ToneSeqSteps != NULL)
+    {
+        SYSTEM_DelayMs(10);
+        BK4819_ToneSeq_TimeSlice10ms();
     }
 }
 
+void BK4819_ToneSeq_Stop(void)
+{
+    if (ToneSeqSteps == NULL)
+        return;
+
+    BK4819_EnterTxMute();
+
+    ToneSeqSteps = NULL;
+    ToneSeqDone  = NULL;
+}
+
 void BK4819_TransmitTone(bool bLocalLoopback, uint32_t Frequency)
 {
     BK4819_EnterTxMute();
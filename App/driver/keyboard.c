@@ -21,6 +21,9 @@
 #include "driver/systick.h"
 #include "driver/i2c.h"
 #include "misc.h"
+#include "py32f071_ll_bus.h"
+#include "py32f071_ll_exti.h"
+#include "py32f071_ll_tim.h"
 
 KEY_Code_t gKeyReading0     = KEY_INVALID;
 KEY_Code_t gKeyReading1     = KEY_INVALID;
@@ -154,6 +157,165 @@ static const KEY_Code_t keyboard[5][4] = {
     }
 };
 
+// Background scan. Once KEYBOARD_StartScan() has run, the matrix is walked by
+// the TIM14 interrupt, one column per millisecond, so the rows get a full tick
+// to settle instead of being polled in a busy loop. A key is reported after
+// KEY_SCAN_STABLE identical passes. With nothing pressed for KEY_SCAN_IDLE
+// passes the timer is stopped and every column is driven low: any key, side
+// keys included, then pulls a row down and the EXTI on the rows restarts the
+// scan (and wakes the core, should it be sleeping).
+#define TIMx                TIM14
+#define EXTI_LINES_ROWS     (LL_EXTI_LINE_15 | LL_EXTI_LINE_14 | LL_EXTI_LINE_13 | LL_EXTI_LINE_12)
+
+#define KEY_SCAN_STEPS      5       // side keys, then the 4 columns
+#define KEY_SCAN_STABLE     2       // 10 ms
+#define KEY_SCAN_IDLE       20      // 100 ms
+
+static bool                KeyScanStarted;
+static volatile KEY_Code_t KeyScanKey = KEY_INVALID;   // debounced
+static KEY_Code_t          KeyScanFound;               // this pass
+static KEY_Code_t          KeyScanCandidate;
+static uint8_t             KeyScanCount;               // passes the candidate has been seen
+static uint8_t             KeyScanStep;
+
+static inline void KEYBOARD_SelectColumn(unsigned int j)
+{
+    // Set all columns high first
+    GPIO_SetOutputPin(PIN_COLS);
+
+    // Clear the specific column we are selecting, the side keys need none
+    if (j > 0)
+    {
+        GPIO_ResetOutputPin(PIN_COL(j - 1));
+    }
+}
+
+static KEY_Code_t KEYBOARD_Decode(unsigned int j, uint32_t reg)
+{
+    // check which row is pressed in this column
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        if (!(reg & PIN_MASK_ROW(i)))
+        {
+            return keyboard[j][i];
+        }
+    }
+
+    return KEY_INVALID;
+}
+
+static void KEYBOARD_Wake(void)
+{
+    LL_EXTI_DisableIT(EXTI_LINES_ROWS);
+    LL_EXTI_ClearFlag(EXTI_LINES_ROWS);
+
+    KeyScanStep      = 0;
+    KeyScanFound     = KEY_INVALID;
+    KeyScanCandidate = KEY_INVALID;
+    KeyScanCount     = 0;
+    KEYBOARD_SelectColumn(0);
+
+    LL_TIM_SetCounter(TIMx, 0);
+    LL_TIM_EnableCounter(TIMx);
+}
+
+static void KEYBOARD_Idle(void)
+{
+    LL_TIM_DisableCounter(TIMx);
+
+    LL_EXTI_ClearFlag(EXTI_LINES_ROWS);
+    LL_EXTI_EnableIT(EXTI_LINES_ROWS);
+    GPIO_ResetOutputPin(PIN_COLS);
+
+    // a key that closed while the scan was winding down gives no edge
+    if (read_rows() != PIN_MASK_ROWS)
+    {
+        KEYBOARD_Wake();
+    }
+}
+
+void KEYBOARD_StartScan(void)
+{
+    LL_APB1_GRP2_EnableClock(LL_APB1_GRP2_PERIPH_TIM14);
+
+    // 1 MHz count, 1 ms update
+    LL_TIM_SetPrescaler(TIMx, SystemCoreClock / 1000000 - 1);
+    LL_TIM_SetAutoReload(TIMx, 1000 - 1);
+    LL_TIM_ClearFlag_UPDATE(TIMx);
+    LL_TIM_EnableIT_UPDATE(TIMx);
+
+    LL_EXTI_SetEXTISource(LL_EXTI_CONFIG_PORTB, LL_EXTI_CONFIG_LINE12);
+    LL_EXTI_SetEXTISource(LL_EXTI_CONFIG_PORTB, LL_EXTI_CONFIG_LINE13);
+    LL_EXTI_SetEXTISource(LL_EXTI_CONFIG_PORTB, LL_EXTI_CONFIG_LINE14);
+    LL_EXTI_SetEXTISource(LL_EXTI_CONFIG_PORTB, LL_EXTI_CONFIG_LINE15);
+    LL_EXTI_EnableFallingTrig(EXTI_LINES_ROWS);
+
+    NVIC_SetPriority(TIM14_IRQn, 3);
+    NVIC_EnableIRQ(TIM14_IRQn);
+    NVIC_SetPriority(EXTI4_15_IRQn, 3);
+    NVIC_EnableIRQ(EXTI4_15_IRQn);
+
+    KeyScanKey     = KEY_INVALID;
+    KeyScanStarted = true;
+
+    // keys may be held already, so begin with a scan rather than waiting
+    KEYBOARD_Wake();
+}
+
+void TIM14_IRQHandler(void)
+{
+    LL_TIM_ClearFlag_UPDATE(TIMx);
+
+    // rows have settled for the column selected on the previous tick
+    if (KeyScanFound == KEY_INVALID)
+    {
+        KeyScanFound = KEYBOARD_Decode(KeyScanStep, read_rows());
+    }
+
+    if (++KeyScanStep < KEY_SCAN_STEPS)
+    {
+        KEYBOARD_SelectColumn(KeyScanStep);
+        return;
+    }
+
+    const KEY_Code_t Key = KeyScanFound;
+
+    KeyScanStep  = 0;
+    KeyScanFound = KEY_INVALID;
+    KEYBOARD_SelectColumn(0);
+
+    if (Key != KeyScanCandidate)
+    {
+        KeyScanCandidate = Key;
+        KeyScanCount     = 1;
+    }
+    else if (KeyScanCount < 0xFF)
+    {
+        KeyScanCount++;
+    }
+
+    if (KeyScanCount == KEY_SCAN_STABLE)
+    {
+        KeyScanKey = Key;
+    }
+
+    if (Key == KEY_INVALID && KeyScanCount >= KEY_SCAN_IDLE)
+    {
+        KEYBOARD_Idle();
+    }
+}
+
+void EXTI4_15_IRQHandler(void)
+{
+    // The vector is shared by lines 4-15: only a row edge while the keypad
+    // is idle starts a scan. Other lines' flags are their owners' to clear,
+    // row flags raised by the scan itself are cleared by KEYBOARD_Idle().
+    const uint32_t Rows = LL_EXTI_ReadFlag(EXTI_LINES_ROWS);
+
+    if (Rows && LL_EXTI_IsEnabledIT(LL_EXTI_LINE_12))
+        KEYBOARD_Wake();    // clears the row flags
+}
+
 KEY_Code_t KEYBOARD_Poll(void)
 {
 #ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
@@ -175,6 +337,13 @@ KEY_Code_t KEYBOARD_Poll(void)
     }
 #endif
 
+    if (KeyScanStarted)
+    {
+        return KeyScanKey;
+    }
+
+    // boot time, before the background scan runs
+
     KEY_Code_t Key = KEY_INVALID;
 
     // Scan all 5 columns - never break early to avoid GPIO state issues
@@ -183,14 +352,7 @@ KEY_Code_t KEYBOARD_Poll(void)
         uint32_t reg;
         uint32_t match_count = 0;  // Count consecutive matching reads
 
-        // Set all columns high first
-        GPIO_SetOutputPin(PIN_COLS);
-
-        // Clear the specific column we are selecting
-        if (j > 0)
-        {
-            GPIO_ResetOutputPin(PIN_COL(j - 1));
-        }
+        KEYBOARD_SelectColumn(j);
 
         // Debounce: Read rows multiple times and look for stable reads
         // CRITICAL FIX #1: Proper debounce logic (replaces confusing i *= syntax)
@@ -229,15 +391,8 @@ KEY_Code_t KEYBOARD_Poll(void)
             continue;
         }
 
-        // Debounce successful, check which row is pressed in this column
-        for (unsigned int i = 0; i < 4; i++)
-        {
-            if (!(reg & PIN_MASK_ROW(i)))
-            {
-                Key = keyboard[j][i];
-                break;
-            }
-        }
+        // Debounce successful
+        Key = KEYBOARD_Decode(j, reg);
 
         if (Key != KEY_INVALID)
         {
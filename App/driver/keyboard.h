@@ -68,6 +68,9 @@ extern volatile KEY_Code_t gKeyFromSerial;
 bool KEYBOARD_ProcessProtocolByte(ParseState_t *state, uint8_t b);
 #endif
 
+// Hands the matrix over to the timer/EXTI driven scan, KEYBOARD_Poll then
+// returns its debounced result without touching the pins.
+void       KEYBOARD_StartScan(void);
 KEY_Code_t KEYBOARD_Poll(void);
 KEY_Code_t KEYBOARD_GetKey(void);
 
@@ -14,6 +14,7 @@
  *     limitations under the License.
  */
 
+#include <stddef.h>
 #include <string.h>
 
 #include "driver/py25q16.h"
@@ -38,11 +39,86 @@
 #define SECTOR_SIZE 0x1000
 #define PAGE_SIZE 0x100
 
-static uint32_t SectorCacheAddr = 0x1000000;
-static uint8_t SectorCache[SECTOR_SIZE];
+#ifdef ENABLE_FLASH_SPARE_SECTOR
+    // The cache holds a single page. Rewriting a sector copies it to the
+    // spare sector first, then back after the erase; the journal sector
+    // records each copy so a power cut half way through can be finished on
+    // the next start (see SpareRecover()). While the copy is open, writes to
+    // other pages of the sector move the cache along (see SpareStage()).
+    #define CACHE_SIZE PAGE_SIZE
+    #define SPARE_ADDR 0x00E000
+    #define JOURNAL_ADDR 0x00F000
+#else
+    #define CACHE_SIZE SECTOR_SIZE
+#endif
+
+#define QUEUE_SIZE 128
+#define COMMIT_HOLDOFF_10ms 5
+
+// The cache doubles as a write-behind buffer: writes land in RAM and
+// PY25Q16_Process() erases/programs the flash later, polling WIP instead of
+// blocking the caller. Reads of the cached range are always served from RAM.
+typedef enum
+{
+    COMMIT_IDLE,    // cache matches flash
+    COMMIT_STAGED,  // cache holds changes not yet on flash
+    COMMIT_ERASE,   // sector erase in progress
+    COMMIT_PROGRAM, // programming the pages in CommitPages
+#ifdef ENABLE_FLASH_SPARE_SECTOR
+    COMMIT_SPARE_COPY,    // spare erased, copying the new sector contents into it
+    COMMIT_SPARE_JOURNAL, // journal erased, record still to write
+    COMMIT_SPARE_MARK,    // journal record written, target sector still to erase
+    COMMIT_SPARE_RESTORE, // programming the target back from the spare
+    COMMIT_SPARE_DONE,    // journal record being marked done
+#endif
+} CommitState_t;
+
+// Writes to other sectors while the cache is busy wait here, header + data
+typedef struct
+{
+    uint32_t Address;
+    uint16_t Size;
+    bool Append;
+} QueueRecord_t;
+
+static uint32_t CacheAddr = 0x1000000;
+static uint8_t Cache[CACHE_SIZE];
+static CommitState_t CommitState = COMMIT_IDLE;
+static bool CommitErase;                  // staged data needs 0 -> 1 bit changes
+static uint16_t CommitPages;              // one bit per cached page still to program
+static uint16_t CommitEnd = SECTOR_SIZE;  // Append: drop sector data past here on erase
+static uint16_t CommitFrom = CACHE_SIZE;  // cache bytes changed since the last commit,
+static uint16_t CommitTo;                 // only these are programmed when no erase is needed
+static uint8_t CommitHoldoff;             // 10 ms ticks to wait for more writes
+static uint8_t Queue[QUEUE_SIZE];
+static uint32_t QueueLen;
 static uint8_t BlackHole[4] __attribute__((aligned(4)));
 static volatile bool TC_Flag;
 
+#ifdef ENABLE_FLASH_SPARE_SECTOR
+
+// One per sector rewrite, appended until the journal sector is full
+typedef struct
+{
+    uint32_t Target;  // sector copied to the spare
+    uint16_t Crc;     // of the spare contents, seeded with Target
+    uint8_t Done;     // 0xff until the target has been programmed back
+    uint8_t Pad;
+} JournalRecord_t;
+
+#define JOURNAL_RECORDS (SECTOR_SIZE / sizeof(JournalRecord_t))
+#define SPARE_PAGES (SECTOR_SIZE / PAGE_SIZE)
+
+static uint8_t PageBuf[PAGE_SIZE];
+static uint16_t JournalSlot;              // first unused record
+static uint32_t SpareTarget = 0x1000000;  // sector the spare stands in for
+static uint16_t SpareCrc;
+static uint8_t SparePage;
+static uint16_t SpareDone;                // pages already programmed into the spare
+static uint32_t SpareQueueLen;            // queued writes merged into the spare copy
+
+#endif
+
 static inline void CS_Assert()
 {
     GPIO_ResetOutputPin(CS_PIN);
@@ -214,18 +290,262 @@ static uint8_t SPI_WriteByte(uint8_t Value)
 static void WriteAddr(uint32_t Addr);
 static uint8_t ReadStatusReg(uint32_t Which);
 static void WaitWIP();
+static bool IsWIP();
 static void WriteEnable();
 static void SectorErase(uint32_t Addr);
-static void SectorProgram(uint32_t Addr, const uint8_t *Buf, uint32_t Size);
 static void PageProgram(uint32_t Addr, const uint8_t *Buf, uint32_t Size);
+static void ReadFlash(uint32_t Address, uint8_t *pBuffer, uint32_t Size);
+static void Overlay(uint32_t Address, uint8_t *pBuffer, uint32_t Size, uint32_t SrcAddr, const uint8_t *pSrc, uint32_t SrcSize);
+static void StageCache(uint32_t Address, const uint8_t *pBuffer, uint32_t Size, bool Append);
+static bool QueuePush(uint32_t Address, const uint8_t *pBuffer, uint32_t Size, bool Append);
+static void QueueApply(void);
+#ifdef ENABLE_FLASH_SPARE_SECTOR
+static void SpareRecover(void);
+static void SpareBegin(void);
+static void SpareProcess(void);
+static void SpareRead(uint32_t Address, uint8_t *pBuffer, uint32_t Size);
+static bool SpareStage(uint32_t Address, const uint8_t *pBuffer, uint32_t Size, bool Append);
+#endif
 
 void PY25Q16_Init()
 {
     CS_Release();
     SPI_Init();
+
+#ifdef ENABLE_FLASH_SPARE_SECTOR
+    SpareRecover();
+#endif
 }
 
 void PY25Q16_ReadBuffer(uint32_t Address, void *pBuffer, uint32_t Size)
+{
+    if (Address >= CacheAddr && Address + Size <= CacheAddr + CACHE_SIZE)
+    {
+        // no need to wait for an erase/program of this range to finish
+        memcpy(pBuffer, Cache + (Address - CacheAddr), Size);
+    }
+    else
+    {
+        WaitWIP();
+#ifdef ENABLE_FLASH_SPARE_SECTOR
+        SpareRead(Address, pBuffer, Size);
+#else
+        ReadFlash(Address, pBuffer, Size);
+#endif
+        Overlay(Address, pBuffer, Size, CacheAddr, Cache, CACHE_SIZE);
+    }
+
+    // queued writes are newer than both
+    for (uint32_t i = 0; i < QueueLen;)
+    {
+        QueueRecord_t Rec;
+        memcpy(&Rec, Queue + i, sizeof(Rec));
+        i += sizeof(Rec);
+        Overlay(Address, pBuffer, Size, Rec.Address, Queue + i, Rec.Size);
+        i += Rec.Size;
+    }
+}
+
+void PY25Q16_WriteBuffer(uint32_t Address, const void *pBuffer, uint32_t Size, bool Append)
+{
+#ifdef DEBUG
+    printf("spi flash write: %06x %ld %d\n", Address, Size, Append);
+#endif
+
+    //#ifdef ENABLE_FEAT_F4HWN_DEBUG
+    //    gDebug++;
+    //#endif
+
+    while (Size)
+    {
+        const uint32_t ChunkAddr = Address - (Address % CACHE_SIZE);
+        uint32_t ChunkSize = CACHE_SIZE - (Address % CACHE_SIZE);
+
+        if (Size < ChunkSize)
+        {
+            ChunkSize = Size;
+        }
+
+        while (true)
+        {
+            // The cache takes the data unless it is busy with a commit or with
+            // another range, or older writes are still queued
+            if (QueueLen == 0 && (CommitState == COMMIT_IDLE || (CommitState == COMMIT_STAGED && ChunkAddr == CacheAddr)))
+            {
+                StageCache(Address, pBuffer, ChunkSize, Append);
+                if (CommitState == COMMIT_STAGED)
+                {
+                    CommitHoldoff = COMMIT_HOLDOFF_10ms;
+                }
+                break;
+            }
+
+#ifdef ENABLE_FLASH_SPARE_SECTOR
+            if (SpareStage(Address, pBuffer, ChunkSize, Append))
+            {
+                break;
+            }
+#endif
+
+            if (QueuePush(Address, pBuffer, ChunkSize, Append))
+            {
+                break;
+            }
+
+            // queue full, do it the slow way
+            PY25Q16_Flush();
+        }
+
+        Address += ChunkSize;
+        pBuffer += ChunkSize;
+        Size -= ChunkSize;
+    }
+}
+
+void PY25Q16_Process(void)
+{
+    switch (CommitState)
+    {
+    case COMMIT_IDLE:
+        if (QueueLen)
+        {
+            QueueApply();
+        }
+        return;
+
+    case COMMIT_STAGED:
+        if (CommitHoldoff || IsWIP())
+        {
+            return;
+        }
+
+        if (!CommitErase)
+        {
+            CommitState = COMMIT_PROGRAM;
+            break;
+        }
+
+#ifdef ENABLE_FLASH_SPARE_SECTOR
+        SpareBegin();
+#else
+        if (CommitEnd < SECTOR_SIZE)
+        {
+            memset(Cache + CommitEnd, 0xff, SECTOR_SIZE - CommitEnd);
+        }
+
+        // after the erase, only pages holding data need programming
+        CommitPages = 0;
+        for (uint32_t i = 0; i < SECTOR_SIZE; i++)
+        {
+            if (0xff != Cache[i])
+            {
+                CommitPages |= 1u << (i / PAGE_SIZE);
+            }
+        }
+        CommitFrom = 0;
+        CommitTo = SECTOR_SIZE;
+
+        SectorErase(CacheAddr);
+        CommitState = COMMIT_ERASE;
+#endif
+        return;
+
+    case COMMIT_ERASE:
+    case COMMIT_PROGRAM:
+        break;
+
+    default:
+#ifdef ENABLE_FLASH_SPARE_SECTOR
+        SpareProcess();
+#endif
+        return;
+    }
+
+    // issue the next page program whenever the chip is free
+    while (!IsWIP())
+    {
+        if (!CommitPages)
+        {
+            CommitState = COMMIT_IDLE;
+            CommitErase = false;
+            CommitEnd = SECTOR_SIZE;
+            CommitFrom = CACHE_SIZE;
+            CommitTo = 0;
+            return;
+        }
+
+        uint32_t Page = 0;
+        while (!(CommitPages & (1u << Page)))
+        {
+            Page++;
+        }
+
+        // without an erase only the changed bytes go out: a flag cleared in
+        // place costs a few bytes on the bus instead of a page
+        const uint32_t From = MAX(Page * PAGE_SIZE, CommitFrom);
+        const uint32_t To = MIN((Page + 1) * PAGE_SIZE, CommitTo);
+
+        CommitPages &= ~(1u << Page);
+        CommitState = COMMIT_PROGRAM;
+        PageProgram(CacheAddr + From, Cache + From, To - From);
+    }
+}
+
+void PY25Q16_TimeSlice10ms(void)
+{
+    if (CommitHoldoff)
+    {
+        CommitHoldoff--;
+    }
+}
+
+void PY25Q16_Flush(void)
+{
+    while (PY25Q16_IsFlushPending())
+    {
+        WaitWIP();
+        CommitHoldoff = 0;
+        PY25Q16_Process();
+    }
+}
+
+bool PY25Q16_IsFlushPending(void)
+{
+    return CommitState != COMMIT_IDLE || QueueLen != 0;
+}
+
+void PY25Q16_SectorErase(uint32_t Address)
+{
+    PY25Q16_Flush();
+
+    Address -= (Address % SECTOR_SIZE);
+    SectorErase(Address);
+    WaitWIP();
+    if (CacheAddr - (CacheAddr % SECTOR_SIZE) == Address)
+    {
+        memset(Cache, 0xff, CACHE_SIZE);
+    }
+}
+
+// Load the cache with one DMA read, so that a burst of small reads from
+// that range is served from RAM. Only CACHE_SIZE bytes are loaded: with the
+// spare sector enabled that is a single page, so reads outside it still go
+// to flash one by one
+void PY25Q16_Prefetch(uint32_t Address)
+{
+    Address -= (Address % CACHE_SIZE);
+
+    if (Address == CacheAddr || PY25Q16_IsFlushPending())
+    {
+        return;
+    }
+
+    WaitWIP();
+    ReadFlash(Address, Cache, CACHE_SIZE);
+    CacheAddr = Address;
+}
+
+static void ReadFlash(uint32_t Address, uint8_t *pBuffer, uint32_t Size)
 {
     CS_Assert();
 
@@ -239,108 +559,549 @@ void PY25Q16_ReadBuffer(uint32_t Address, void *pBuffer, uint32_t Size)
     }
 
     if (Size >= 16) {
-        SPI_ReadBuf((uint8_t *)pBuffer, Size);
+        SPI_ReadBuf(pBuffer, Size);
     } else {
         for (uint32_t i = 0; i < Size; i++)
         {
-            ((uint8_t *)(pBuffer))[i] = SPI_WriteByte(0xff);
+            pBuffer[i] = SPI_WriteByte(0xff);
         }
     }
 
     CS_Release();
 }
 
-void PY25Q16_WriteBuffer(uint32_t Address, const void *pBuffer, uint32_t Size, bool Append)
+static void Overlay(uint32_t Address, uint8_t *pBuffer, uint32_t Size, uint32_t SrcAddr, const uint8_t *pSrc, uint32_t SrcSize)
 {
-#ifdef DEBUG
-    printf("spi flash write: %06x %ld %d\n", Address, Size, Append);
-#endif
+    const uint32_t From = MAX(Address, SrcAddr);
+    const uint32_t To = MIN(Address + Size, SrcAddr + SrcSize);
 
-    //#ifdef ENABLE_FEAT_F4HWN_DEBUG
-    //    gDebug++;
-    //#endif
+    if (From < To)
+    {
+        memcpy(pBuffer + (From - Address), pSrc + (From - SrcAddr), To - From);
+    }
+}
 
-    uint32_t SecIndex = Address / SECTOR_SIZE;
-    uint32_t SecAddr = SecIndex * SECTOR_SIZE;
-    uint32_t SecOffset = Address % SECTOR_SIZE;
-    uint32_t SecSize = SECTOR_SIZE - SecOffset;
+// Apply a write to the cache; the caller makes sure the cache is free to
+// switch ranges. Address..Address+Size must stay within one cache range.
+static void StageCache(uint32_t Address, const uint8_t *pBuffer, uint32_t Size, bool Append)
+{
+    const uint32_t ChunkAddr = Address - (Address % CACHE_SIZE);
+    const uint32_t Offset = Address % CACHE_SIZE;
 
-    while (Size)
+    if (ChunkAddr != CacheAddr)
     {
-        // CRITICAL FIX #1: Wait for flash ready before processing each sector
         WaitWIP();
+        ReadFlash(ChunkAddr, Cache, CACHE_SIZE);
+        CacheAddr = ChunkAddr;
+    }
+
+    if (0 == memcmp(pBuffer, Cache + Offset, Size))
+    {
+        return;
+    }
 
-        if (Size < SecSize)
+    for (uint32_t i = 0; i < Size; i++)
+    {
+        if (Cache[Offset + i] == pBuffer[i])
         {
-            SecSize = Size;
+            continue;
         }
 
-        if (SecAddr != SectorCacheAddr)
+        // programming can only clear bits
+        if ((Cache[Offset + i] & pBuffer[i]) != pBuffer[i])
         {
-            PY25Q16_ReadBuffer(SecAddr, SectorCache, SECTOR_SIZE);
-            SectorCacheAddr = SecAddr;
+            CommitErase = true;
         }
 
-        if (0 != memcmp(pBuffer, (char *)SectorCache + SecOffset, SecSize))
+        CommitPages |= 1u << ((Offset + i) / PAGE_SIZE);
+        CommitFrom = MIN(CommitFrom, Offset + i);
+        CommitTo = MAX(CommitTo, Offset + i + 1);
+    }
+
+    memcpy(Cache + Offset, pBuffer, Size);
+
+    if (Append)
+    {
+        CommitEnd = Address % SECTOR_SIZE + Size;
+    }
+
+    CommitState = COMMIT_STAGED;
+}
+
+static bool QueuePush(uint32_t Address, const uint8_t *pBuffer, uint32_t Size, bool Append)
+{
+    if (QueueLen + sizeof(QueueRecord_t) + Size > QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    const QueueRecord_t Rec = {Address, Size, Append};
+    memcpy(Queue + QueueLen, &Rec, sizeof(Rec));
+    memcpy(Queue + QueueLen + sizeof(Rec), pBuffer, Size);
+    QueueLen += sizeof(Rec) + Size;
+
+    return true;
+}
+
+// Move every queued write for the range of the oldest one into the cache
+static void QueueApply(void)
+{
+    uint32_t ChunkAddr = 0;
+    uint32_t Kept = 0;
+
+    for (uint32_t i = 0; i < QueueLen;)
+    {
+        QueueRecord_t Rec;
+        memcpy(&Rec, Queue + i, sizeof(Rec));
+
+        const uint32_t RecLen = sizeof(Rec) + Rec.Size;
+
+        if (i == 0)
         {
-            bool Erase = false;
-            for (uint32_t i = 0; i < SecSize; i++)
-            {
-                if (0xff != SectorCache[SecOffset + i])
-                {
-                    Erase = true;
-                    break;
-                }
-            }
+            ChunkAddr = Rec.Address - (Rec.Address % CACHE_SIZE);
+        }
 
-            memcpy(SectorCache + SecOffset, pBuffer, SecSize);
+        if (Rec.Address - (Rec.Address % CACHE_SIZE) == ChunkAddr)
+        {
+            StageCache(Rec.Address, Queue + i + sizeof(Rec), Rec.Size, Rec.Append);
+        }
+        else
+        {
+            memmove(Queue + Kept, Queue + i, RecLen);
+            Kept += RecLen;
+        }
 
-            if (Erase)
-            {
-                SectorErase(SecAddr);
+        i += RecLen;
+    }
 
-                // CRITICAL FIX #2: Erase takes ~300ms, must complete before program starts
-                WaitWIP();
+    QueueLen = Kept;
+}
 
-                if (Append)
-                {
-                    SectorProgram(SecAddr, SectorCache, SecOffset + SecSize);
-                    memset(SectorCache + SecOffset + SecSize, 0xff, SECTOR_SIZE - SecOffset - SecSize);
-                }
-                else
-                {
-                    SectorProgram(SecAddr, SectorCache, SECTOR_SIZE);
-                }
-            }
-            else
-            {
-                SectorProgram(Address, pBuffer, SecSize);
-            }
+#ifdef ENABLE_FLASH_SPARE_SECTOR
+
+static uint16_t Crc16(uint16_t Crc, const uint8_t *pData, uint32_t Size)
+{
+    for (uint32_t i = 0; i < Size; i++)
+    {
+        Crc ^= pData[i] << 8;
+        for (int j = 0; j < 8; j++)
+        {
+            Crc = (Crc & 0x8000) ? (Crc << 1) ^ 0x1021 : Crc << 1;
         }
+    }
 
-        Address += SecSize;
-        pBuffer += SecSize;
-        Size -= SecSize;
+    return Crc;
+}
 
-        SecAddr += SECTOR_SIZE;
-        SecOffset = 0;
-        SecSize = SECTOR_SIZE;
-    } // while
+static uint16_t SpareCrcSeed(uint32_t Target)
+{
+    return Crc16(0, (const uint8_t *)&Target, sizeof(Target));
+}
 
-    // CRITICAL FIX #3: Ensure all writes complete before function returns
+static bool IsBlank(const uint8_t *pData, uint32_t Size)
+{
+    for (uint32_t i = 0; i < Size; i++)
+    {
+        if (0xff != pData[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static void JournalRead(uint16_t Slot, JournalRecord_t *pRec)
+{
+    ReadFlash(JOURNAL_ADDR + Slot * sizeof(*pRec), (uint8_t *)pRec, sizeof(*pRec));
+}
+
+static void JournalMarkDone(void)
+{
+    static const uint8_t Zero = 0;
+
+    PageProgram(JOURNAL_ADDR + JournalSlot * sizeof(JournalRecord_t) + offsetof(JournalRecord_t, Done), &Zero, 1);
+    JournalSlot++;
+}
+
+// Pages of the target sector already in the spare are newer there, and
+// while the target is being erased and programmed back that is all of them
+static void SpareRead(uint32_t Address, uint8_t *pBuffer, uint32_t Size)
+{
+    ReadFlash(Address, pBuffer, Size);
+
+    if (CommitState < COMMIT_SPARE_COPY)
+    {
+        return;
+    }
+
+    for (uint32_t Page = 0; Page < SPARE_PAGES; Page++)
+    {
+        const uint32_t PageAddr = SpareTarget + Page * PAGE_SIZE;
+        const uint32_t From = MAX(Address, PageAddr);
+        const uint32_t To = MIN(Address + Size, PageAddr + PAGE_SIZE);
+
+        if (From < To && (SpareDone & (1u << Page)))
+        {
+            ReadFlash(SPARE_ADDR + (From - SpareTarget), pBuffer + (From - Address), To - From);
+        }
+    }
+}
+
+// Program the target sector from the spare, blocking; used on start up
+static void SpareRestoreNow(uint32_t Target)
+{
+    SectorErase(Target);
+
+    for (uint32_t Page = 0; Page < SPARE_PAGES; Page++)
+    {
+        WaitWIP();
+        ReadFlash(SPARE_ADDR + Page * PAGE_SIZE, PageBuf, PAGE_SIZE);
+        if (!IsBlank(PageBuf, PAGE_SIZE))
+        {
+            PageProgram(Target + Page * PAGE_SIZE, PageBuf, PAGE_SIZE);
+        }
+    }
+
+    WaitWIP();
+    JournalMarkDone();
     WaitWIP();
 }
 
-void PY25Q16_SectorErase(uint32_t Address)
+// Finish a sector rewrite a power cut interrupted. The last journal record
+// counts only if the spare still holds what it was written for: the spare is
+// erased again before the next record, so a stale one can never match.
+static void SpareRecover(void)
 {
-    Address -= (Address % SECTOR_SIZE);
-    SectorErase(Address);
-    if (SectorCacheAddr == Address)
+    JournalRecord_t Rec;
+
+    // records are used in order, find the first blank one
+    uint16_t Lo = 0;
+    uint16_t Hi = JOURNAL_RECORDS;
+    while (Lo < Hi)
+    {
+        const uint16_t Mid = (Lo + Hi) / 2;
+        JournalRead(Mid, &Rec);
+        if (0xffffffff == Rec.Target)
+        {
+            Hi = Mid;
+        }
+        else
+        {
+            Lo = Mid + 1;
+        }
+    }
+    JournalSlot = Lo;
+
+    if (0 == JournalSlot)
+    {
+        return;
+    }
+
+    JournalRead(JournalSlot - 1, &Rec);
+    if (0xff != Rec.Done || Rec.Target % SECTOR_SIZE || Rec.Target == SPARE_ADDR || Rec.Target == JOURNAL_ADDR)
+    {
+        return;
+    }
+
+    uint16_t Crc = SpareCrcSeed(Rec.Target);
+    for (uint32_t Page = 0; Page < SPARE_PAGES; Page++)
+    {
+        ReadFlash(SPARE_ADDR + Page * PAGE_SIZE, PageBuf, PAGE_SIZE);
+        Crc = Crc16(Crc, PageBuf, PAGE_SIZE);
+    }
+
+    if (Crc != Rec.Crc)
+    {
+        // the copy never completed, the target was not touched
+        return;
+    }
+
+    JournalSlot--;
+    SpareRestoreNow(Rec.Target);
+}
+
+// An Append write dropped the sector data past CommitEnd
+static void SpareTruncate(uint32_t PageAddr, uint8_t *pPage)
+{
+    const uint32_t Offset = PageAddr % SECTOR_SIZE;
+
+    if (CommitEnd < Offset + PAGE_SIZE)
+    {
+        const uint32_t From = MAX(CommitEnd, Offset) - Offset;
+        memset(pPage + From, 0xff, PAGE_SIZE - From);
+    }
+}
+
+// The staged page needs bits set: start copying its sector into the spare
+static void SpareBegin(void)
+{
+    SpareTarget = CacheAddr - (CacheAddr % SECTOR_SIZE);
+    SparePage = 0;
+    SpareDone = 0;
+
+    // the cache must read back what the sector will hold
+    SpareTruncate(CacheAddr, Cache);
+
+    // queued writes to the same sector go into the copy too, up to the first
+    // Append one: that truncates and has to stay after them
+    SpareQueueLen = 0;
+    for (uint32_t i = 0; i < QueueLen;)
+    {
+        QueueRecord_t Rec;
+        memcpy(&Rec, Queue + i, sizeof(Rec));
+
+        if (Rec.Append && Rec.Address - (Rec.Address % SECTOR_SIZE) == SpareTarget)
+        {
+            break;
+        }
+
+        i += sizeof(Rec) + Rec.Size;
+        SpareQueueLen = i;
+    }
+
+    SectorErase(SPARE_ADDR);
+    CommitState = COMMIT_SPARE_COPY;
+}
+
+// Drop the queued writes SpareBegin() merged, they are in the spare now
+static void SpareDropMerged(void)
+{
+    uint32_t Kept = 0;
+
+    for (uint32_t i = 0; i < QueueLen;)
+    {
+        QueueRecord_t Rec;
+        memcpy(&Rec, Queue + i, sizeof(Rec));
+
+        const uint32_t RecLen = sizeof(Rec) + Rec.Size;
+
+        if (i >= SpareQueueLen || Rec.Address - (Rec.Address % SECTOR_SIZE) != SpareTarget)
+        {
+            memmove(Queue + Kept, Queue + i, RecLen);
+            Kept += RecLen;
+        }
+
+        i += RecLen;
+    }
+
+    QueueLen = Kept;
+}
+
+// Build a page of the new sector contents and program it into the spare
+static void SpareCopyPage(uint32_t Page)
+{
+    const uint32_t PageAddr = SpareTarget + Page * PAGE_SIZE;
+
+    ReadFlash(PageAddr, PageBuf, PAGE_SIZE);
+    SpareTruncate(PageAddr, PageBuf);
+    Overlay(PageAddr, PageBuf, PAGE_SIZE, CacheAddr, Cache, CACHE_SIZE);
+
+    for (uint32_t i = 0; i < SpareQueueLen;)
+    {
+        QueueRecord_t Rec;
+        memcpy(&Rec, Queue + i, sizeof(Rec));
+        i += sizeof(Rec);
+        Overlay(PageAddr, PageBuf, PAGE_SIZE, Rec.Address, Queue + i, Rec.Size);
+        i += Rec.Size;
+    }
+
+    if (!IsBlank(PageBuf, PAGE_SIZE))
+    {
+        PageProgram(SPARE_ADDR + Page * PAGE_SIZE, PageBuf, PAGE_SIZE);
+    }
+    SpareDone |= 1u << Page;
+}
+
+// A write to another page of the sector being rewritten, too big for the
+// queue or arriving while the copy is open. The cached page goes into the
+// spare and the cache moves on to the written page, so that a bulk write
+// of a whole sector costs one spare cycle instead of one per page.
+static bool SpareStage(uint32_t Address, const uint8_t *pBuffer, uint32_t Size, bool Append)
+{
+    const uint32_t Sector = CacheAddr - (CacheAddr % SECTOR_SIZE);
+    const uint32_t ChunkAddr = Address - (Address % CACHE_SIZE);
+
+    if (Append || ChunkAddr - (ChunkAddr % SECTOR_SIZE) != Sector)
+    {
+        return false;
+    }
+
+    // queued writes to the sector are older and have to stay so: only take
+    // the write when they all sit in its page and can go into the cache first
+    for (uint32_t i = 0; i < QueueLen;)
+    {
+        QueueRecord_t Rec;
+        memcpy(&Rec, Queue + i, sizeof(Rec));
+
+        if (Rec.Address - (Rec.Address % SECTOR_SIZE) == Sector &&
+            (Rec.Append || Rec.Address - (Rec.Address % CACHE_SIZE) != ChunkAddr))
+        {
+            return false;
+        }
+
+        i += sizeof(Rec) + Rec.Size;
+    }
+
+    if (CommitState == COMMIT_STAGED)
+    {
+        // a write the queue can hold is cheaper than waiting on the spare erase
+        if (!CommitErase || ChunkAddr == CacheAddr || QueueLen + sizeof(QueueRecord_t) + Size <= QUEUE_SIZE)
+        {
+            return false;
+        }
+
+        SpareBegin();
+    }
+    else if (CommitState != COMMIT_SPARE_COPY || (SpareDone & (1u << ((ChunkAddr % SECTOR_SIZE) / PAGE_SIZE))))
+    {
+        return false;
+    }
+
+    if (ChunkAddr != CacheAddr)
+    {
+        const uint32_t CachePage = (CacheAddr % SECTOR_SIZE) / PAGE_SIZE;
+
+        if (!(SpareDone & (1u << CachePage)))
+        {
+            WaitWIP();
+            SpareCopyPage(CachePage);
+        }
+
+        WaitWIP();
+        ReadFlash(ChunkAddr, Cache, CACHE_SIZE);
+        SpareTruncate(ChunkAddr, Cache);
+        CacheAddr = ChunkAddr;
+    }
+
+    uint32_t Kept = 0;
+    for (uint32_t i = 0; i < QueueLen;)
     {
-        memset(SectorCache, 0xff, SECTOR_SIZE);
+        QueueRecord_t Rec;
+        memcpy(&Rec, Queue + i, sizeof(Rec));
+
+        const uint32_t RecLen = sizeof(Rec) + Rec.Size;
+
+        if (Rec.Address - (Rec.Address % SECTOR_SIZE) == Sector)
+        {
+            Overlay(CacheAddr, Cache, CACHE_SIZE, Rec.Address, Queue + i + sizeof(Rec), Rec.Size);
+        }
+        else
+        {
+            memmove(Queue + Kept, Queue + i, RecLen);
+            Kept += RecLen;
+        }
+
+        i += RecLen;
     }
+    QueueLen = Kept;
+
+    // what is left in the queue is for other sectors
+    SpareQueueLen = 0;
+
+    memcpy(Cache + (Address % CACHE_SIZE), pBuffer, Size);
+    CommitHoldoff = COMMIT_HOLDOFF_10ms;
+
+    return true;
 }
 
+static void SpareProcess(void)
+{
+    // issue the next step whenever the chip is free
+    while (!IsWIP())
+    {
+        const uint32_t PageAddr = SpareTarget + SparePage * PAGE_SIZE;
+
+        switch (CommitState)
+        {
+        case COMMIT_SPARE_COPY:
+            // more pages of the sector may still be on the way
+            if (CommitHoldoff)
+            {
+                return;
+            }
+
+            while (SparePage < SPARE_PAGES && (SpareDone & (1u << SparePage)))
+            {
+                SparePage++;
+            }
+
+            if (SparePage < SPARE_PAGES)
+            {
+                SpareCopyPage(SparePage);
+                SparePage++;
+                break;
+            }
+
+            // pages went in out of order, take the CRC from what is there
+            SpareCrc = SpareCrcSeed(SpareTarget);
+            for (uint32_t Page = 0; Page < SPARE_PAGES; Page++)
+            {
+                ReadFlash(SPARE_ADDR + Page * PAGE_SIZE, PageBuf, PAGE_SIZE);
+                SpareCrc = Crc16(SpareCrc, PageBuf, PAGE_SIZE);
+            }
+
+            SpareDropMerged();
+
+            // the cache keeps its page, now with the merged writes in it
+            ReadFlash(SPARE_ADDR + CacheAddr % SECTOR_SIZE, Cache, CACHE_SIZE);
+
+            if (JournalSlot < JOURNAL_RECORDS)
+            {
+                CommitState = COMMIT_SPARE_JOURNAL;
+                break;
+            }
+
+            SectorErase(JOURNAL_ADDR);
+            JournalSlot = 0;
+            CommitState = COMMIT_SPARE_JOURNAL;
+            break;
+
+        case COMMIT_SPARE_JOURNAL:
+        {
+            const JournalRecord_t Rec = {SpareTarget, SpareCrc, 0xff, 0xff};
+
+            PageProgram(JOURNAL_ADDR + JournalSlot * sizeof(Rec), (const uint8_t *)&Rec, sizeof(Rec));
+            CommitState = COMMIT_SPARE_MARK;
+            break;
+        }
+
+        case COMMIT_SPARE_MARK:
+            SectorErase(SpareTarget);
+            SparePage = 0;
+            CommitState = COMMIT_SPARE_RESTORE;
+            break;
+
+        case COMMIT_SPARE_RESTORE:
+            if (SparePage < SPARE_PAGES)
+            {
+                ReadFlash(SPARE_ADDR + SparePage * PAGE_SIZE, PageBuf, PAGE_SIZE);
+                if (!IsBlank(PageBuf, PAGE_SIZE))
+                {
+                    PageProgram(PageAddr, PageBuf, PAGE_SIZE);
+                }
+                SparePage++;
+                break;
+            }
+
+            JournalMarkDone();
+            CommitState = COMMIT_SPARE_DONE;
+            break;
+
+        default:
+            CommitState = COMMIT_IDLE;
+            CommitErase = false;
+            CommitPages = 0;
+            CommitEnd = SECTOR_SIZE;
+            CommitFrom = CACHE_SIZE;
+            CommitTo = 0;
+            return;
+        }
+    }
+}
+
+#endif
+
 static inline void WriteAddr(uint32_t Addr)
 {
     SPI_WriteByte(0xff & (Addr >> 16));
@@ -374,12 +1135,16 @@ static uint8_t ReadStatusReg(uint32_t Which)
     return Value;
 }
 
+static bool IsWIP()
+{
+    return 1 & ReadStatusReg(0);
+}
+
 static void WaitWIP()
 {
     for (int i = 0; i < 1000000; i++)
     {
-        uint8_t Status = ReadStatusReg(0);
-        if (1 & Status) // WIP
+        if (IsWIP())
         {
             SYSTICK_DelayUs(10);
             continue;
@@ -395,41 +1160,20 @@ static void WriteEnable()
     CS_Release();
 }
 
+// SectorErase() and PageProgram() only issue the command, callers poll WIP
+
 static void SectorErase(uint32_t Addr)
 {
 #ifdef DEBUG
     printf("spi flash sector erase: %06x\n", Addr);
 #endif
-    WriteEnable();
     WaitWIP();
+    WriteEnable();
 
     CS_Assert();
     SPI_WriteByte(0x20);
     WriteAddr(Addr);
     CS_Release();
-
-    WaitWIP();
-}
-
-static void SectorProgram(uint32_t Addr, const uint8_t *Buf, uint32_t Size)
-{
-    uint32_t Size1 = PAGE_SIZE - (Addr % PAGE_SIZE);
-
-    while (Size)
-    {
-        if (Size < Size1)
-        {
-            Size1 = Size;
-        }
-
-        PageProgram(Addr, Buf, Size1);
-
-        Addr += Size1;
-        Buf += Size1;
-        Size -= Size1;
-
-        Size1 = PAGE_SIZE;
-    }
 }
 
 static void PageProgram(uint32_t Addr, const uint8_t *Buf, uint32_t Size)
@@ -438,8 +1182,8 @@ static void PageProgram(uint32_t Addr, const uint8_t *Buf, uint32_t Size)
     printf("spi flash page program: %06x %ld\n", Addr, Size);
 #endif
 
+    WaitWIP();
     WriteEnable();
-    // WaitWIP();
 
     CS_Assert();
 
@@ -459,8 +1203,6 @@ static void PageProgram(uint32_t Addr, const uint8_t *Buf, uint32_t Size)
     }
 
     CS_Release();
-
-    WaitWIP();
 }
 
 void DMA1_Channel4_5_6_7_IRQHandler()
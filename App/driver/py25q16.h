@@ -24,5 +24,15 @@ void PY25Q16_Init();
 void PY25Q16_ReadBuffer(uint32_t Address, void *pBuffer, uint32_t Size);
 void PY25Q16_WriteBuffer(uint32_t Address, const void *pBuffer, uint32_t Size, bool Append);
 void PY25Q16_SectorErase(uint32_t Address);
+void PY25Q16_Prefetch(uint32_t Address);
+
+// Writes are buffered in RAM and committed in the background: call
+// PY25Q16_Process() from the main loop and PY25Q16_TimeSlice10ms() from the
+// 10 ms slice. PY25Q16_Flush() blocks until everything is on flash; use it
+// before a reset or when power is about to go.
+void PY25Q16_Process(void);
+void PY25Q16_TimeSlice10ms(void);
+void PY25Q16_Flush(void);
+bool PY25Q16_IsFlushPending(void);
 
 #endif
@@ -23,21 +23,35 @@
 #include "py32f071_ll_gpio.h"
 #include "py32f071_ll_usart.h"
 
+#include "driver/systick.h"
+#include "driver/uart.h"
+
 #ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
 #include "driver/keyboard.h"
 #endif
 
 #define USARTx USART1
 #define DMA_CHANNEL LL_DMA_CHANNEL_2
+#define DMA_CHANNEL_TX LL_DMA_CHANNEL_1
 
-// CRITICAL FIX: Define UART TX timeout
-// If UART TX buffer doesn't clear within this many iterations, skip byte and continue
-// Prevents permanent freeze if UART is stuck
-#define UART_TX_TIMEOUT_ITERATIONS 10000
+// If the TX ring stays full this long (in 10 us steps) the rest of the data
+// is dropped; prevents a permanent freeze if the UART is stuck
+#define UART_TX_TIMEOUT_10us 10000
 
 static bool UART_IsLogEnabled;
 uint8_t UART_DMA_Buffer[256];
 
+// TX ring, drained by DMA. The main loop only moves TxHead, the DMA
+// completion only moves TxTail; TxDmaLen is the size of the transfer in
+// flight (0 = idle). One slot stays empty to tell full from empty.
+static uint8_t TxRing[UART_TX_RING_SIZE];
+static volatile uint16_t TxHead;
+static volatile uint16_t TxTail;
+static volatile uint16_t TxDmaLen;
+
+static void TxStart(void);
+static void TxComplete(void);
+
 void UART_Init(void)
 {
     // PA9 TX
@@ -88,6 +102,41 @@ void UART_Init(void)
 
     } while (0);
 
+    // DMA TX, one transfer per contiguous run of the ring
+    do
+    {
+        LL_DMA_DisableChannel(DMA1, DMA_CHANNEL_TX);
+
+        LL_DMA_InitTypeDef DMA_InitStruct;
+        LL_DMA_StructInit(&DMA_InitStruct);
+
+        DMA_InitStruct.Direction = LL_DMA_DIRECTION_MEMORY_TO_PERIPH;
+        DMA_InitStruct.Mode = LL_DMA_MODE_NORMAL;
+        DMA_InitStruct.PeriphOrM2MSrcAddress = LL_USART_DMA_GetRegAddr(USARTx);
+        DMA_InitStruct.PeriphOrM2MSrcIncMode = LL_DMA_PERIPH_NOINCREMENT;
+        DMA_InitStruct.PeriphOrM2MSrcDataSize = LL_DMA_PDATAALIGN_BYTE;
+        DMA_InitStruct.MemoryOrM2MDstAddress = (uint32_t)TxRing;
+        DMA_InitStruct.MemoryOrM2MDstDataSize = LL_DMA_MDATAALIGN_BYTE;
+        DMA_InitStruct.MemoryOrM2MDstIncMode = LL_DMA_MEMORY_INCREMENT;
+        DMA_InitStruct.NbData = 0;
+        DMA_InitStruct.Priority = LL_DMA_PRIORITY_LOW;
+
+        LL_DMA_Init(DMA1, DMA_CHANNEL_TX, &DMA_InitStruct);
+
+        LL_SYSCFG_SetDMARemap(DMA1, DMA_CHANNEL_TX, LL_SYSCFG_DMA_MAP_USART1_WR);
+
+        LL_DMA_ClearFlag_TC1(DMA1);
+        LL_DMA_EnableIT_TC(DMA1, DMA_CHANNEL_TX);
+
+        NVIC_SetPriority(DMA1_Channel1_IRQn, 3);
+        NVIC_EnableIRQ(DMA1_Channel1_IRQn);
+
+        TxHead = 0;
+        TxTail = 0;
+        TxDmaLen = 0;
+
+    } while (0);
+
     LL_APB1_GRP2_ForceReset(LL_APB1_GRP2_PERIPH_USART1);
     LL_APB1_GRP2_ReleaseReset(LL_APB1_GRP2_PERIPH_USART1);
 
@@ -104,6 +153,7 @@ void UART_Init(void)
         LL_USART_Init(USARTx, &USART_InitStruct);
 
         LL_USART_EnableDMAReq_RX(USARTx);
+        LL_USART_EnableDMAReq_TX(USARTx);
 
     } while (0);
 
@@ -112,34 +162,99 @@ void UART_Init(void)
     LL_USART_TransmitData8(USARTx, 0);
 }
 
+uint32_t UART_SendAsync(const void *pBuffer, uint32_t Size)
+{
+    const uint8_t *pData = (const uint8_t *)pBuffer;
+    const uint16_t Tail = TxTail;
+    uint16_t Head = TxHead;
+    uint32_t Free = (Tail + UART_TX_RING_SIZE - Head - 1) % UART_TX_RING_SIZE;
+
+    if (Size > Free)
+    {
+        Size = Free;
+    }
+
+    for (uint32_t i = 0; i < Size; i++)
+    {
+        TxRing[Head] = pData[i];
+        Head = (Head + 1) % UART_TX_RING_SIZE;
+    }
+
+    TxHead = Head;
+
+    if (Size)
+    {
+        const uint32_t Primask = __get_PRIMASK();
+        __disable_irq();
+        if (!TxDmaLen)
+        {
+            TxStart();
+        }
+        __set_PRIMASK(Primask);
+    }
+
+    return Size;
+}
+
 void UART_Send(const void *pBuffer, uint32_t Size)
 {
     const uint8_t *pData = (const uint8_t *)pBuffer;
-    uint32_t i;
+    uint32_t Timeout = UART_TX_TIMEOUT_10us;
 
-    for (i = 0; i < Size; i++)
+    while (Size)
     {
-        // CRITICAL FIX: Add timeout to UART TX busy-wait
-        // Original: while (!LL_USART_IsActiveFlag_TXE(USARTx)) ;
-        // Problem: If UART TX stuck or disconnected, this is infinite loop
-        // Result: Radio freeze for 100ms+ while trying to send one character
-        //
-        // Solution: Add iteration counter timeout
-        // If TXE flag doesn't set within timeout iterations, skip byte and continue
-        // This caps maximum freeze at ~10ms per UART_Send() call
-        
-        uint32_t timeout = UART_TX_TIMEOUT_ITERATIONS;
-        while (!LL_USART_IsActiveFlag_TXE(USARTx) && timeout > 0)
+        const uint32_t Sent = UART_SendAsync(pData, Size);
+
+        pData += Sent;
+        Size -= Sent;
+
+        if (Sent)
         {
-            timeout--;
+            Timeout = UART_TX_TIMEOUT_10us;
+            continue;
         }
-        
-        // Send byte only if TXE flag is set
-        // If timeout occurred, skip this byte and continue
-        if (timeout > 0)
+
+        if (Timeout-- == 0)
+        {
+            break;
+        }
+
+        // Ring full. Also works with interrupts masked (e.g. a reply sent
+        // from inside a critical section), the completion is polled here.
+        const uint32_t Primask = __get_PRIMASK();
+        __disable_irq();
+        TxComplete();
+        __set_PRIMASK(Primask);
+
+        SYSTICK_DelayUs(10);
+    }
+}
+
+uint32_t UART_GetTxFree(void)
+{
+    return (TxTail + UART_TX_RING_SIZE - TxHead - 1) % UART_TX_RING_SIZE;
+}
+
+bool UART_IsTxIdle(void)
+{
+    return TxHead == TxTail;
+}
+
+void UART_Flush(void)
+{
+    for (uint32_t Timeout = UART_TX_TIMEOUT_10us; Timeout; Timeout--)
+    {
+        const uint32_t Primask = __get_PRIMASK();
+        __disable_irq();
+        TxComplete();
+        __set_PRIMASK(Primask);
+
+        if (TxHead == TxTail && LL_USART_IsActiveFlag_TC(USARTx))
         {
-            LL_USART_TransmitData8(USARTx, pData[i]);
+            break;
         }
+
+        SYSTICK_DelayUs(10);
     }
 }
 
@@ -174,4 +289,46 @@ void UART_LogSend(const void *pBuffer, uint32_t Size)
 
         return connected;
     }
-#endif
\ No newline at end of file
+#endif
+
+// Called with interrupts masked
+static void TxStart(void)
+{
+    const uint16_t Tail = TxTail;
+    const uint16_t Head = TxHead;
+
+    if (Head == Tail)
+    {
+        return;
+    }
+
+    // up to the end of the ring, the wrapped part follows on completion
+    TxDmaLen = (Head > Tail) ? (Head - Tail) : (UART_TX_RING_SIZE - Tail);
+
+    LL_DMA_DisableChannel(DMA1, DMA_CHANNEL_TX);
+    LL_DMA_SetMemoryAddress(DMA1, DMA_CHANNEL_TX, (uint32_t)(TxRing + Tail));
+    LL_DMA_SetDataLength(DMA1, DMA_CHANNEL_TX, TxDmaLen);
+    LL_DMA_EnableChannel(DMA1, DMA_CHANNEL_TX);
+}
+
+// Called with interrupts masked
+static void TxComplete(void)
+{
+    if (!LL_DMA_IsActiveFlag_TC1(DMA1))
+    {
+        return;
+    }
+
+    LL_DMA_ClearFlag_TC1(DMA1);
+    LL_DMA_DisableChannel(DMA1, DMA_CHANNEL_TX);
+
+    TxTail = (TxTail + TxDmaLen) % UART_TX_RING_SIZE;
+    TxDmaLen = 0;
+
+    TxStart();
+}
+
+void DMA1_Channel1_IRQHandler()
+{
+    TxComplete();
+}
@@ -21,10 +21,25 @@
 #include <stdint.h>
 #include <stdbool.h>
 
+#define UART_TX_RING_SIZE 512
+
 extern uint8_t UART_DMA_Buffer[256];
 
 void UART_Init(void);
+
+// Queue as much as fits in the TX ring without waiting, returns the number
+// of bytes taken
+uint32_t UART_SendAsync(const void *pBuffer, uint32_t Size);
+
+// Queue everything, waiting for the DMA only while the ring is full
 void UART_Send(const void *pBuffer, uint32_t Size);
+
+uint32_t UART_GetTxFree(void);
+bool UART_IsTxIdle(void);
+
+// Wait until the last queued byte has left the wire
+void UART_Flush(void);
+
 void UART_LogSend(const void *pBuffer, uint32_t Size);
 
 #ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
@@ -25,16 +25,32 @@
 uint8_t VCP_RxBuf[VCP_RX_BUF_SIZE];
 volatile uint32_t VCP_RxBufPointer = 0;
 
+#ifdef ENABLE_USB_DUAL_CDC
+#define CDC_LOG_LINE_SIZE 64
+
+uint8_t VCP_AuxRxBuf[VCP_AUX_RX_BUF_SIZE];
+volatile uint32_t VCP_AuxRxBufPointer = 0;
+#endif
+
 void VCP_Init()
 {
     LL_APB1_GRP2_EnableClock(LL_APB1_GRP2_PERIPH_SYSCFG);
     LL_IOP_GRP1_EnableClock(LL_IOP_GRP1_PERIPH_GPIOA); // PA12:11
     LL_APB1_GRP1_EnableClock(LL_APB1_GRP1_PERIPH_USBD);
 
-    cdc_acm_rx_buf_t rx_buf = {
-        .buf = VCP_RxBuf,
-        .size = sizeof(VCP_RxBuf),
-        .write_pointer = &VCP_RxBufPointer,
+    const cdc_acm_rx_buf_t rx_buf[CDC_ACM_PORT_COUNT] = {
+        [CDC_ACM_PORT_CPS] = {
+            .buf = VCP_RxBuf,
+            .size = sizeof(VCP_RxBuf),
+            .write_pointer = &VCP_RxBufPointer,
+        },
+#ifdef ENABLE_USB_DUAL_CDC
+        [CDC_ACM_PORT_AUX] = {
+            .buf = VCP_AuxRxBuf,
+            .size = sizeof(VCP_AuxRxBuf),
+            .write_pointer = &VCP_AuxRxBufPointer,
+        },
+#endif
     };
     cdc_acm_init(rx_buf);
 
@@ -63,23 +79,35 @@ bool VCP_ScreenshotPing(void)
     //   KEY_3  → <b>  → KEYBOARD_InjectKey(b, false), IDLE
     //   KEY_3L → <b>  → KEYBOARD_InjectKey(b, true), IDLE
 
-    static uint8_t      read_ptr = 0;
+    // With ENABLE_USB_DUAL_CDC the viewer talks to the aux port, so its
+    // keepalives no longer share a ring with CPS programming traffic.
+#ifdef ENABLE_USB_DUAL_CDC
+    uint8_t *const           rxBuf     = VCP_AuxRxBuf;
+    const uint32_t           rxBufSize = VCP_AUX_RX_BUF_SIZE;
+    volatile uint32_t *const pWritePtr = &VCP_AuxRxBufPointer;
+#else
+    uint8_t *const           rxBuf     = VCP_RxBuf;
+    const uint32_t           rxBufSize = VCP_RX_BUF_SIZE;
+    volatile uint32_t *const pWritePtr = &VCP_RxBufPointer;
+#endif
+
+    static uint32_t     read_ptr = 0;
     static ParseState_t state    = STATE_IDLE;
 
     bool     connected = false;
-    uint8_t  write_ptr = VCP_RxBufPointer;  // snapshot once — ISR may update concurrently
+    uint32_t write_ptr = *pWritePtr;  // snapshot once — ISR may update concurrently
 
-    // Cap bytes processed per call to VCP_RX_BUF_SIZE.
+    // Cap bytes processed per call to the ring size.
     // Prevents unbounded loop if the ISR write pointer laps read_ptr
     // (buffer overflow / corrupted state), which would freeze the firmware.
     uint32_t processed = 0;
 
-    while (read_ptr != write_ptr && processed < VCP_RX_BUF_SIZE)
+    while (read_ptr != write_ptr && processed < rxBufSize)
     {
-        uint8_t b = VCP_RxBuf[read_ptr];
+        uint8_t b = rxBuf[read_ptr];
 
         read_ptr++;
-        if (read_ptr >= VCP_RX_BUF_SIZE)
+        if (read_ptr >= rxBufSize)
             read_ptr = 0;
         processed++;
 
@@ -90,3 +118,43 @@ bool VCP_ScreenshotPing(void)
     return connected;
 }
 #endif // ENABLE_FEAT_F4HWN_SCREENSHOT
+
+#ifdef ENABLE_USB_DUAL_CDC
+// Line-buffered so printf output costs one USB transfer per line instead
+// of one per character. Dropped while no terminal is attached.
+static uint8_t LogLine[CDC_LOG_LINE_SIZE];
+static uint8_t LogLen = 0;
+static bool    LogReady = false;  // LogLine complete, waiting for ring space
+
+void VCP_LogFlush(void)
+{
+    if (LogReady && cdc_acm_data_send_with_dtr_async(CDC_ACM_PORT_AUX, LogLine, LogLen))
+    {
+        LogLen = 0;
+        LogReady = false;
+    }
+}
+
+void VCP_LogPutchar(char c)
+{
+    if (!cdc_acm_is_open(CDC_ACM_PORT_AUX))
+    {
+        LogLen = 0;
+        LogReady = false;
+        return;
+    }
+
+    // Host not reading: drop the character rather than wait for it
+    VCP_LogFlush();
+    if (LogReady)
+        return;
+
+    LogLine[LogLen++] = (uint8_t)c;
+
+    if (c == '\n' || LogLen == sizeof(LogLine))
+    {
+        LogReady = true;
+        VCP_LogFlush();
+    }
+}
+#endif
@@ -27,28 +27,72 @@
 extern uint8_t VCP_RxBuf[VCP_RX_BUF_SIZE];
 extern volatile uint32_t VCP_RxBufPointer;
 
+#ifdef ENABLE_USB_DUAL_CDC
+#define VCP_AUX_RX_BUF_SIZE 64
+
+extern uint8_t VCP_AuxRxBuf[VCP_AUX_RX_BUF_SIZE];
+extern volatile uint32_t VCP_AuxRxBufPointer;
+#endif
+
 void VCP_Init();
 
 #ifdef ENABLE_FEAT_F4HWN_SCREENSHOT
 bool VCP_ScreenshotPing(void);
 #endif
 
-static inline void VCP_Send(const uint8_t *Buf, uint32_t Size)
+// The send functions never wait: they return how many bytes were queued
+static inline uint32_t VCP_Send(const uint8_t *Buf, uint32_t Size)
 {
-    cdc_acm_data_send_with_dtr(Buf, Size);
+    return cdc_acm_data_send_with_dtr(CDC_ACM_PORT_CPS, Buf, Size);
 }
 
-static inline void VCP_SendStr(const char *Str)
+static inline uint32_t VCP_SendStr(const char *Str)
 {
     if (Str)
     {
-        cdc_acm_data_send_with_dtr((const uint8_t *)Str, strlen(Str));
+        return cdc_acm_data_send_with_dtr(CDC_ACM_PORT_CPS, (const uint8_t *)Str, strlen(Str));
     }
+
+    return 0;
+}
+
+static inline bool VCP_SendAsync(const uint8_t *Buf, uint32_t Size)
+{
+    return cdc_acm_data_send_with_dtr_async(CDC_ACM_PORT_CPS, Buf, Size);
+}
+
+static inline uint32_t VCP_GetTxFree(void)
+{
+    return cdc_acm_tx_free(CDC_ACM_PORT_CPS);
 }
 
-static inline void VCP_SendAsync(const uint8_t *Buf, uint32_t Size)
+// Port used for the screenshot stream and debug log: the dedicated aux ACM
+// function when the composite device is built, the CPS port otherwise.
+#ifdef ENABLE_USB_DUAL_CDC
+    #define VCP_PORT_STREAM CDC_ACM_PORT_AUX
+#else
+    #define VCP_PORT_STREAM CDC_ACM_PORT_CPS
+#endif
+
+static inline uint32_t VCP_StreamSend(const uint8_t *Buf, uint32_t Size)
+{
+    return cdc_acm_data_send_with_dtr(VCP_PORT_STREAM, Buf, Size);
+}
+
+static inline uint32_t VCP_StreamGetTxFree(void)
 {
-    cdc_acm_data_send_with_dtr_async(Buf, Size);
+    return cdc_acm_tx_free(VCP_PORT_STREAM);
 }
 
+static inline bool VCP_StreamIsTxIdle(void)
+{
+    return cdc_acm_tx_is_idle(VCP_PORT_STREAM);
+}
+
+#ifdef ENABLE_USB_DUAL_CDC
+void VCP_LogPutchar(char c);
+// Retries a log line the TX ring had no room for, call from the main loop
+void VCP_LogFlush(void);
+#endif
+
 #endif // _DRIVER_VCP_H
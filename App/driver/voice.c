@@ -27,10 +27,151 @@
 #define DAC_CHANNEL LL_DAC_CHANNEL_1
 #define DMA_CHANNEL LL_DMA_CHANNEL_3
 
-#define VOICE_BUF_SIZE (sizeof(uint16_t) * VOICE_BUF_LEN)
-
 static uint16_t DAC_Buf[VOICE_BUF_LEN * 2];
 
+// single producer (main loop) / single consumer (DMA interrupt) byte ring
+static struct
+{
+    uint8_t           Buf[VOICE_STREAM_SIZE];
+    volatile uint16_t Head;     // written by VOICE_StreamWrite()
+    volatile uint16_t Tail;     // advanced by the interrupt
+} Stream;
+
+static VOICE_Format_t Format;
+
+static struct
+{
+    int16_t Predictor;
+    uint8_t StepIndex;
+} Adpcm;
+
+static const uint16_t VOICE_SAMPLES[256] =
+{
+    0x06a8, 0x06b8, 0x0688, 0x0698, 0x06e8, 0x06f8, 0x06c8, 0x06d8, //
+    0x0628, 0x0638, 0x0608, 0x0618, 0x0668, 0x0678, 0x0648, 0x0658, //
+    0x0754, 0x075c, 0x0744, 0x074c, 0x0774, 0x077c, 0x0764, 0x076c, //
+    0x0714, 0x071c, 0x0704, 0x070c, 0x0734, 0x073c, 0x0724, 0x072c, //
+    0x02a0, 0x02e0, 0x0220, 0x0260, 0x03a0, 0x03e0, 0x0320, 0x0360, //
+    0x00a0, 0x00e0, 0x0020, 0x0060, 0x01a0, 0x01e0, 0x0120, 0x0160, //
+    0x0550, 0x0570, 0x0510, 0x0530, 0x05d0, 0x05f0, 0x0590, 0x05b0, //
+    0x0450, 0x0470, 0x0410, 0x0430, 0x04d0, 0x04f0, 0x0490, 0x04b0, //
+    0x07ea, 0x07eb, 0x07e8, 0x07e9, 0x07ee, 0x07ef, 0x07ec, 0x07ed, //
+    0x07e2, 0x07e3, 0x07e0, 0x07e1, 0x07e6, 0x07e7, 0x07e4, 0x07e5, //
+    0x07fa, 0x07fb, 0x07f8, 0x07f9, 0x07fe, 0x07ff, 0x07fc, 0x07fd, //
+    0x07f2, 0x07f3, 0x07f0, 0x07f1, 0x07f6, 0x07f7, 0x07f4, 0x07f5, //
+    0x07aa, 0x07ae, 0x07a2, 0x07a6, 0x07ba, 0x07be, 0x07b2, 0x07b6, //
+    0x078a, 0x078e, 0x0782, 0x0786, 0x079a, 0x079e, 0x0792, 0x0796, //
+    0x07d5, 0x07d7, 0x07d1, 0x07d3, 0x07dd, 0x07df, 0x07d9, 0x07db, //
+    0x07c5, 0x07c7, 0x07c1, 0x07c3, 0x07cd, 0x07cf, 0x07c9, 0x07cb, //
+    0x0958, 0x0948, 0x0978, 0x0968, 0x0918, 0x0908, 0x0938, 0x0928, //
+    0x09d8, 0x09c8, 0x09f8, 0x09e8, 0x0998, 0x0988, 0x09b8, 0x09a8, //
+    0x08ac, 0x08a4, 0x08bc, 0x08b4, 0x088c, 0x0884, 0x089c, 0x0894, //
+    0x08ec, 0x08e4, 0x08fc, 0x08f4, 0x08cc, 0x08c4, 0x08dc, 0x08d4, //
+    0x0d60, 0x0d20, 0x0de0, 0x0da0, 0x0c60, 0x0c20, 0x0ce0, 0x0ca0, //
+    0x0f60, 0x0f20, 0x0fe0, 0x0fa0, 0x0e60, 0x0e20, 0x0ee0, 0x0ea0, //
+    0x0ab0, 0x0a90, 0x0af0, 0x0ad0, 0x0a30, 0x0a10, 0x0a70, 0x0a50, //
+    0x0bb0, 0x0b90, 0x0bf0, 0x0bd0, 0x0b30, 0x0b10, 0x0b70, 0x0b50, //
+    0x0815, 0x0814, 0x0817, 0x0816, 0x0811, 0x0810, 0x0813, 0x0812, //
+    0x081d, 0x081c, 0x081f, 0x081e, 0x0819, 0x0818, 0x081b, 0x081a, //
+    0x0805, 0x0804, 0x0807, 0x0806, 0x0801, 0x0800, 0x0803, 0x0802, //
+    0x080d, 0x080c, 0x080f, 0x080e, 0x0809, 0x0808, 0x080b, 0x080a, //
+    0x0856, 0x0852, 0x085e, 0x085a, 0x0846, 0x0842, 0x084e, 0x084a, //
+    0x0876, 0x0872, 0x087e, 0x087a, 0x0866, 0x0862, 0x086e, 0x086a, //
+    0x082b, 0x0829, 0x082f, 0x082d, 0x0823, 0x0821, 0x0827, 0x0825, //
+    0x083b, 0x0839, 0x083f, 0x083d, 0x0833, 0x0831, 0x0837, 0x0835 //
+};
+
+static const uint16_t ADPCM_STEPS[89] =
+{
+        7,     8,     9,    10,    11,    12,    13,    14,    16,    17,
+       19,    21,    23,    25,    28,    31,    34,    37,    41,    45,
+       50,    55,    60,    66,    73,    80,    88,    97,   107,   118,
+      130,   143,   157,   173,   190,   209,   230,   253,   279,   307,
+      337,   371,   408,   449,   494,   544,   598,   658,   724,   796,
+      876,   963,  1060,  1166,  1282,  1411,  1552,  1707,  1878,  2066,
+     2272,  2499,  2749,  3024,  3327,  3660,  4026,  4428,  4871,  5358,
+     5894,  6484,  7132,  7845,  8630,  9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t ADPCM_INDEX[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+// one IMA ADPCM code to a 12-bit DAC value
+static uint16_t ADPCM_Decode(uint8_t Code)
+{
+    const int32_t Step = ADPCM_STEPS[Adpcm.StepIndex];
+    int32_t       Diff = Step >> 3;
+
+    if (Code & 4)
+        Diff += Step;
+    if (Code & 2)
+        Diff += Step >> 1;
+    if (Code & 1)
+        Diff += Step >> 2;
+
+    int32_t Sample = Adpcm.Predictor + ((Code & 8) ? -Diff : Diff);
+    if (Sample > 32767)
+        Sample = 32767;
+    else if (Sample < -32768)
+        Sample = -32768;
+    Adpcm.Predictor = Sample;
+
+    int32_t Index = Adpcm.StepIndex + ADPCM_INDEX[Code & 7];
+    if (Index < 0)
+        Index = 0;
+    else if (Index > 88)
+        Index = 88;
+    Adpcm.StepIndex = Index;
+
+    return (uint16_t)((Sample + 32768) >> 4);
+}
+
+// decode the next VOICE_BUF_LEN samples, silence once the stream runs dry
+static void VOICE_Fill(uint16_t *pOut)
+{
+    unsigned int i    = 0;
+    uint16_t     Tail = Stream.Tail;
+
+    while (i < VOICE_BUF_LEN && Tail != Stream.Head)
+    {
+        const uint8_t Byte = Stream.Buf[Tail];
+        Tail = (Tail + 1) % VOICE_STREAM_SIZE;
+
+        if (Format == VOICE_FORMAT_LAW8)
+        {
+            pOut[i++] = VOICE_SAMPLES[Byte];
+        }
+        else
+        {   // VOICE_BUF_LEN is even, both nibbles fit
+            pOut[i++] = ADPCM_Decode(Byte & 0x0F);
+            pOut[i++] = ADPCM_Decode(Byte >> 4);
+        }
+    }
+
+    Stream.Tail = Tail;
+
+    if (i < VOICE_BUF_LEN)
+        memset(pOut + i, 0, (VOICE_BUF_LEN - i) * sizeof(uint16_t));
+}
+
+uint16_t VOICE_StreamFree(void)
+{
+    return (Stream.Tail - Stream.Head - 1 + VOICE_STREAM_SIZE) % VOICE_STREAM_SIZE;
+}
+
+void VOICE_StreamWrite(const uint8_t *pData, uint16_t Size)
+{
+    uint16_t Head = Stream.Head;
+
+    while (Size--)
+    {
+        Stream.Buf[Head] = *pData++;
+        Head = (Head + 1) % VOICE_STREAM_SIZE;
+    }
+
+    Stream.Head = Head;
+}
+
 static inline void DMA_Init()
 {
     LL_AHB1_GRP1_EnableClock(LL_AHB1_GRP1_PERIPH_DMA1);
@@ -89,39 +230,24 @@ void VOICE_Init()
     LL_DAC_EnableTrigger(DAC1, DAC_CHANNEL);
 }
 
-void VOICE_Start()
+void VOICE_Start(VOICE_Format_t ClipFormat, int16_t Predictor, uint8_t StepIndex)
 {
     LL_DAC_Enable(DAC1, DAC_CHANNEL);
     LL_TIM_DisableCounter(TIMx);
 
-    if (gVoiceBufLen > 0)
-    {
-        memcpy(DAC_Buf, gVoiceBuf[gVoiceBufReadIndex], VOICE_BUF_SIZE);
-        VOICE_BUF_ForwardReadIndex();
-        gVoiceBufLen--;
-    }
-    else
-    {
-        memset(DAC_Buf, 0, VOICE_BUF_SIZE);
-    }
-    if (gVoiceBufLen > 0)
-    {
-        memcpy(DAC_Buf + VOICE_BUF_SIZE,      //
-               gVoiceBuf[gVoiceBufReadIndex], //
-               VOICE_BUF_SIZE                 //
-        );
-        VOICE_BUF_ForwardReadIndex();
-        gVoiceBufLen--;
-    }
-    else
-    {
-        memset(DAC_Buf + VOICE_BUF_SIZE, 0, VOICE_BUF_SIZE);
-    }
+    Format          = ClipFormat;
+    Adpcm.Predictor = Predictor;
+    Adpcm.StepIndex = (StepIndex > 88) ? 88 : StepIndex;
+
+    VOICE_Fill(DAC_Buf);
+    VOICE_Fill(DAC_Buf + VOICE_BUF_LEN);
 
-    LL_DMA_ConfigAddresses(DMA1, DMA_CHANNEL, DAC_Buf,                                                         //
+    LL_DMA_ConfigAddresses(DMA1, DMA_CHANNEL, (uint32_t)DAC_Buf,                                               //
                            LL_DAC_DMA_GetRegAddr(DAC1, DAC_CHANNEL, LL_DAC_DMA_REG_DATA_12BITS_RIGHT_ALIGNED), //
                            LL_DMA_DIRECTION_MEMORY_TO_PERIPH                                                   //
     );
+    // restart at the first half, a stopped clip may have left it anywhere
+    LL_DMA_SetDataLength(DMA1, DMA_CHANNEL, sizeof(DAC_Buf) / sizeof(uint16_t));
     LL_DMA_EnableChannel(DMA1, DMA_CHANNEL);
     LL_TIM_EnableCounter(TIMx);
 }
@@ -131,39 +257,23 @@ void VOICE_Stop()
     LL_TIM_DisableCounter(TIMx);
     LL_DMA_DisableChannel(DMA1, DMA_CHANNEL);
     LL_DAC_Disable(DAC1, DAC_CHANNEL);
+
+    // drop what is left of the clip
+    Stream.Tail = Stream.Head;
 }
 
+// the first half has been sent while the second one plays, and the other
+// way round: refill the one that just went out
 void DMA1_Channel2_3_IRQHandler()
 {
     if (LL_DMA_IsActiveFlag_HT3(DMA1))
     {
         LL_DMA_ClearFlag_HT3(DMA1);
-        if (gVoiceBufLen > 0)
-        {
-            memcpy(DAC_Buf, gVoiceBuf[gVoiceBufReadIndex], VOICE_BUF_SIZE);
-            VOICE_BUF_ForwardReadIndex();
-            gVoiceBufLen--;
-        }
-        else
-        {
-            memset(DAC_Buf, 0, VOICE_BUF_SIZE);
-        }
+        VOICE_Fill(DAC_Buf);
     }
     if (LL_DMA_IsActiveFlag_TC3(DMA1))
     {
         LL_DMA_ClearFlag_TC3(DMA1);
-        if (gVoiceBufLen > 0)
-        {
-            memcpy(DAC_Buf + VOICE_BUF_SIZE,      //
-                   gVoiceBuf[gVoiceBufReadIndex], //
-                   VOICE_BUF_SIZE                 //
-            );
-            VOICE_BUF_ForwardReadIndex();
-            gVoiceBufLen--;
-        }
-        else
-        {
-            memset(DAC_Buf + VOICE_BUF_SIZE, 0, VOICE_BUF_SIZE);
-        }
+        VOICE_Fill(DAC_Buf + VOICE_BUF_LEN);
     }
 }
@@ -18,26 +18,24 @@
 
 #include <stdint.h>
 
-#define VOICE_BUF_CAP 4
+// samples per DMA half transfer, 20ms at 8kHz
 #define VOICE_BUF_LEN 160
 
-extern uint16_t gVoiceBuf[VOICE_BUF_CAP][VOICE_BUF_LEN];
-extern uint8_t gVoiceBufReadIndex;
-extern uint8_t gVoiceBufWriteIndex;
-extern uint8_t gVoiceBufLen;
+// clip bytes read ahead from flash by the main loop, decoded by the DMA
+// interrupt; lasts 64ms (8-bit) .. 128ms (ADPCM)
+#define VOICE_STREAM_SIZE 512
 
-static inline void VOICE_BUF_ForwardReadIndex()
+typedef enum
 {
-    gVoiceBufReadIndex = (1 + gVoiceBufReadIndex) % VOICE_BUF_CAP;
-}
-
-static inline void VOICE_BUF_ForwardWriteIndex()
-{
-    gVoiceBufWriteIndex = (1 + gVoiceBufWriteIndex) % VOICE_BUF_CAP;
-}
+    VOICE_FORMAT_LAW8 = 0,  // one companded byte per sample, see VOICE_SAMPLES
+    VOICE_FORMAT_ADPCM4,    // IMA ADPCM, two samples per byte, low nibble first
+} VOICE_Format_t;
 
 void VOICE_Init();
-void VOICE_Start();
+void VOICE_Start(VOICE_Format_t Format, int16_t Predictor, uint8_t StepIndex);
 void VOICE_Stop();
 
+uint16_t VOICE_StreamFree(void);
+void     VOICE_StreamWrite(const uint8_t *pData, uint16_t Size);
+
 #endif // DRIVER_VOICE_H
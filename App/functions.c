@@ -139,6 +139,8 @@ void FUNCTION_PowerSave() {
         GUI_SelectNextDisplay(DISPLAY_MAIN);
 }
 
+static void FUNCTION_TransmitReady(void);
+
 void FUNCTION_Transmit()
 {
 #ifdef ENABLE_FEAT_F4HWN_RX_TX_TIMER
@@ -201,8 +203,13 @@ void FUNCTION_Transmit()
     // turn the RED LED on
     BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, true);
 
-    DTMF_Reply();
+    // PTT-ID/DTMF replies go out from the 10 ms time slice, the rest of
+    // the TX setup follows once they're done
+    DTMF_Reply(FUNCTION_TransmitReady);
+}
 
+static void FUNCTION_TransmitReady(void)
+{
     if (gCurrentVfo->DTMF_PTT_ID_TX_MODE == PTT_ID_APOLLO)
         BK4819_PlaySingleTone(2525, 250, 0, gEeprom.DTMF_SIDE_TONE);
 
@@ -250,8 +257,15 @@ void FUNCTION_Select(FUNCTION_Type_t Function)
     const FUNCTION_Type_t PreviousFunction = gCurrentFunction;
     const bool bWasPowerSave = PreviousFunction == FUNCTION_POWER_SAVE;
 
+    // TX, RX and power save all reconfigure the BK4819 under a beep
+    if (Function != FUNCTION_FOREGROUND)
+        AUDIO_BeepWait();
+
     gCurrentFunction = Function;
 
+    if (PreviousFunction == FUNCTION_TRANSMIT)
+        DTMF_ReplyCancel();     // TX ended before the PTT-ID was out
+
     if (bWasPowerSave && Function != FUNCTION_POWER_SAVE) {
         BK4819_Conditional_RX_TurnOn_and_GPIO6_Enable();
         gRxIdleMode = false;
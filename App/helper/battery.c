@@ -18,6 +18,7 @@
 
 #include "battery.h"
 #include "driver/backlight.h"
+#include "driver/py25q16.h"
 #include "driver/st7565.h"
 #include "functions.h"
 #include "misc.h"
@@ -258,6 +259,9 @@ void BATTERY_TimeSlice500ms(void)
     AUDIO_PlaySingleVoice(true);
 #endif
 
+    // the radio is about to shut down: get any pending settings onto flash
+    PY25Q16_Flush();
+
     gReducedService = true;
 
     FUNCTION_Select(FUNCTION_POWER_SAVE);
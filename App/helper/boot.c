@@ -23,6 +23,10 @@
 #include "driver/keyboard.h"
 #include "driver/gpio.h"
 #include "driver/system.h"
+#ifdef ENABLE_BOOT_PROFILE
+    #include "external/printf/printf.h"
+    #include "scheduler.h"
+#endif
 #include "helper/boot.h"
 #include "misc.h"
 #include "radio.h"
@@ -66,6 +70,11 @@ BOOT_Mode_t BOOT_GetMode(void)
                 return BOOT_MODE_AIRCOPY;
             }
         #endif
+
+        #ifdef ENABLE_USB_MSC
+            if (Keys[0] == KEY_F)
+                return BOOT_MODE_USB_DISK;
+        #endif
     }
 
     return BOOT_MODE_NORMAL;
@@ -119,6 +128,8 @@ void BOOT_ProcessMode(BOOT_Mode_t Mode)
                 gEeprom.CURRENT_STATE = 0; // Don't resume is active...
             #endif 
 
+            AIRCOPY_Init();
+
             GUI_SelectNextDisplay(DISPLAY_AIRCOPY);
         }
     #endif
@@ -127,3 +138,46 @@ void BOOT_ProcessMode(BOOT_Mode_t Mode)
         GUI_SelectNextDisplay(DISPLAY_MAIN);
     }
 }
+
+#ifdef ENABLE_BOOT_PROFILE
+
+typedef struct
+{
+    const char *Stage;
+    uint32_t    Cycles;
+} BOOT_ProfileEntry_t;
+
+static BOOT_ProfileEntry_t gBootProfile[20];
+static uint8_t             gBootProfileCount;
+
+// Record the end of a boot stage, in SysTick cycles since SYSTICK_Init()
+void BOOT_ProfileMark(const char *Stage)
+{
+    if (gBootProfileCount < ARRAY_SIZE(gBootProfile))
+    {
+        gBootProfile[gBootProfileCount].Stage  = Stage;
+        gBootProfile[gBootProfileCount].Cycles = SCHEDULER_GetCycles();
+        gBootProfileCount++;
+    }
+}
+
+// Print the stages as "boot <total us> <+stage us> <name>" on the log output
+void BOOT_ProfileReport(void)
+{
+    const uint32_t CyclesPerUs = SystemCoreClock / 1000000;
+    uint32_t       Previous    = 0;
+
+    for (unsigned int i = 0; i < gBootProfileCount; i++)
+    {
+        const BOOT_ProfileEntry_t *pEntry = &gBootProfile[i];
+
+        printf("boot %8lu +%7lu %s\n",
+            pEntry->Cycles / CyclesPerUs,
+            (pEntry->Cycles - Previous) / CyclesPerUs,
+            pEntry->Stage);
+
+        Previous = pEntry->Cycles;
+    }
+}
+
+#endif
@@ -28,7 +28,10 @@ enum BOOT_Mode_t
         BOOT_MODE_RESCUE_OPS,
     #endif
     #ifdef ENABLE_AIRCOPY
-        BOOT_MODE_AIRCOPY
+        BOOT_MODE_AIRCOPY,
+    #endif
+    #ifdef ENABLE_USB_MSC
+        BOOT_MODE_USB_DISK,
     #endif
 };
 
@@ -37,5 +40,13 @@ typedef enum BOOT_Mode_t BOOT_Mode_t;
 BOOT_Mode_t BOOT_GetMode(void);
 void BOOT_ProcessMode(BOOT_Mode_t Mode);
 
+#ifdef ENABLE_BOOT_PROFILE
+    void BOOT_ProfileMark(const char *Stage);
+    void BOOT_ProfileReport(void);
+#else
+    static inline void BOOT_ProfileMark(const char *Stage) { (void)Stage; }
+    static inline void BOOT_ProfileReport(void) {}
+#endif
+
 #endif
 
@@ -0,0 +1,107 @@
+#ifdef ENABLE_AM_FIX
+    #include "am_fix.h"
+#endif
+#include "driver/bk4819.h"
+#include "functions.h"
+#include "helper/rssi.h"
+#include "misc.h"
+#include "radio.h"
+#include "settings.h"
+
+enum {
+    RSSI_FRESH_RSSI   = 1u << 0,
+    RSSI_FRESH_NOISE  = 1u << 1,
+    RSSI_FRESH_GLITCH = 1u << 2,
+};
+
+static uint8_t  Fresh;          // RSSI_FRESH_* read since the tick started
+static uint16_t Rssi;
+static uint8_t  ExNoise;
+static uint8_t  Glitch;
+
+// moving average of the raw RSSI, 1/4 of the difference per tick, 1/16 step;
+// 0 until the first sample after a retune
+static uint16_t Smoothed_x16;
+
+void RSSI_TimeSlice10ms(void)
+{
+    Fresh = 0;
+
+    if (!FUNCTION_IsRx())
+    {
+        Smoothed_x16 = 0;
+        return;
+    }
+
+    // one read per tick while receiving, whoever asks next gets this one
+    const int32_t Sample_x16 = RSSI_GetRaw() * 16;
+
+    if (Smoothed_x16 == 0)
+        Smoothed_x16 = Sample_x16;
+    else
+        Smoothed_x16 += (Sample_x16 - Smoothed_x16) / 4;
+}
+
+void RSSI_Invalidate(void)
+{
+    Fresh        = 0;
+    Smoothed_x16 = 0;
+}
+
+uint16_t RSSI_GetRaw(void)
+{
+    if (!(Fresh & RSSI_FRESH_RSSI))
+    {
+        Rssi   = BK4819_GetRSSI();
+        Fresh |= RSSI_FRESH_RSSI;
+    }
+
+    return Rssi;
+}
+
+uint8_t RSSI_GetExNoise(void)
+{
+    if (!(Fresh & RSSI_FRESH_NOISE))
+    {
+        ExNoise = BK4819_GetExNoiceIndicator();
+        Fresh  |= RSSI_FRESH_NOISE;
+    }
+
+    return ExNoise;
+}
+
+uint8_t RSSI_GetGlitch(void)
+{
+    if (!(Fresh & RSSI_FRESH_GLITCH))
+    {
+        Glitch = BK4819_GetGlitchIndicator();
+        Fresh |= RSSI_FRESH_GLITCH;
+    }
+
+    return Glitch;
+}
+
+static int16_t RSSI_Calibrate(int16_t dBm)
+{
+#ifdef ENABLE_AM_FIX
+    if (gSetting_AM_fix && gRxVfo->Modulation == MODULATION_AM)
+        dBm += AM_fix_get_gain_diff();
+#endif
+#ifdef ENABLE_FEAT_F4HWN
+    dBm += dBmCorrTable[gRxVfo->Band];
+#endif
+    return dBm;
+}
+
+int16_t RSSI_GetdBm(void)
+{
+    return RSSI_Calibrate((int16_t)(RSSI_GetRaw() / 2) - 160);
+}
+
+int16_t RSSI_GetSmoothed_dBm(void)
+{
+    if (Smoothed_x16 == 0)
+        return RSSI_GetdBm();
+
+    return RSSI_Calibrate((int16_t)((Smoothed_x16 + 16) / 32) - 160);
+}
@@ -0,0 +1,19 @@
+#ifndef HELPER_RSSI_H
+#define HELPER_RSSI_H
+
+#include <stdint.h>
+
+// Signal quality read from the BK4819 at most once per 10 ms tick and shared
+// by everything that shows or acts on it. A retune drops the cached values.
+
+void     RSSI_TimeSlice10ms(void);
+void     RSSI_Invalidate(void);
+
+uint16_t RSSI_GetRaw(void);         // 0.5 dB/step, as REG_67
+uint8_t  RSSI_GetExNoise(void);
+uint8_t  RSSI_GetGlitch(void);
+
+int16_t  RSSI_GetdBm(void);         // calibrated for the band, AM fix gain included
+int16_t  RSSI_GetSmoothed_dBm(void);
+
+#endif
@@ -0,0 +1,70 @@
+#include <string.h>
+
+#ifdef ENABLE_SCRATCH_REPORT
+    #include "external/printf/printf.h"
+#endif
+#include "helper/scratch.h"
+
+static uint32_t        Region[(SCRATCH_SIZE + 3) / 4];
+static SCRATCH_Owner_t Owner;
+static uint16_t        Used;
+
+#ifdef ENABLE_SCRATCH_REPORT
+    static uint16_t    HighWater[SCRATCH_OWNER_N];
+    static uint8_t     Failed[SCRATCH_OWNER_N];
+#endif
+
+void *SCRATCH_Acquire(SCRATCH_Owner_t NewOwner, uint16_t Size)
+{
+    Size = (Size + 3u) & ~3u;
+
+    // another mode still holds it: never hand its memory out from under it
+    if ((Owner != SCRATCH_FREE && Owner != NewOwner) || Size > SCRATCH_SIZE - Used)
+    {
+#ifdef ENABLE_SCRATCH_REPORT
+        Failed[NewOwner]++;
+#endif
+        return NULL;
+    }
+
+    Owner = NewOwner;
+
+    uint8_t *p = (uint8_t *)Region + Used;
+    Used += Size;
+    memset(p, 0, Size);
+
+#ifdef ENABLE_SCRATCH_REPORT
+    if (Used > HighWater[NewOwner])
+        HighWater[NewOwner] = Used;
+#endif
+
+    return p;
+}
+
+void SCRATCH_Release(SCRATCH_Owner_t OldOwner)
+{
+    if (Owner != OldOwner)
+        return;
+
+    Owner = SCRATCH_FREE;
+    Used  = 0;
+
+    SCRATCH_Report();
+}
+
+#ifdef ENABLE_SCRATCH_REPORT
+
+// Print "scratch <owner> <high-water>/<size> <failed>" on the log output for
+// every owner that took the region so far
+void SCRATCH_Report(void)
+{
+    for (unsigned int i = SCRATCH_FREE + 1; i < SCRATCH_OWNER_N; i++)
+    {
+        if (HighWater[i] == 0 && Failed[i] == 0)
+            continue;
+
+        printf("scratch %u %u/%u %u\n", i, HighWater[i], SCRATCH_SIZE, Failed[i]);
+    }
+}
+
+#endif
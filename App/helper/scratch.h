@@ -0,0 +1,43 @@
+#ifndef HELPER_SCRATCH_H
+#define HELPER_SCRATCH_H
+
+#include <stdint.h>
+
+// One RAM region shared by the modes that never run at the same time. A mode
+// takes it on entry and gives it back on exit, what it held is gone then.
+// Anything that has to outlive the mode or runs alongside the others (flash
+// cache, screenshot stream) does not belong here.
+
+typedef enum {
+    SCRATCH_FREE = 0,
+    SCRATCH_SPECTRUM,
+    SCRATCH_BREAKOUT,
+    SCRATCH_AIRCOPY,
+    SCRATCH_OWNER_N
+} SCRATCH_Owner_t;
+
+// the biggest user built in sets it
+#if defined(ENABLE_SPECTRUM)
+    #define SCRATCH_SIZE 288    // RSSI history, peak blacklist
+#elif defined(ENABLE_FEAT_F4HWN_GAME)
+    #define SCRATCH_SIZE 108    // bricks
+#else
+    #define SCRATCH_SIZE 88     // AirCopy frame and block map
+#endif
+
+// checks at compile time that a user's layout fits
+#define SCRATCH_CHECK(Type) \
+    _Static_assert(sizeof(Type) <= SCRATCH_SIZE, #Type " does not fit the scratch region")
+
+// Size bytes, zeroed and 4 byte aligned, after what Owner already took; NULL
+// if that does not fit or another owner has not released the region yet.
+void *SCRATCH_Acquire(SCRATCH_Owner_t Owner, uint16_t Size);
+void  SCRATCH_Release(SCRATCH_Owner_t Owner);
+
+#ifdef ENABLE_SCRATCH_REPORT
+    void SCRATCH_Report(void);
+#else
+    static inline void SCRATCH_Report(void) {}
+#endif
+
+#endif
@@ -55,6 +55,9 @@
 #ifdef ENABLE_USB
 #include "driver/vcp.h"
 #endif
+#ifdef ENABLE_USB_MSC
+#include "app/usbdisk.h"
+#endif
 #include "helper/battery.h"
 #include "helper/boot.h"
 
@@ -70,6 +73,9 @@ void _putchar(__attribute__((unused)) char c)
 #ifdef ENABLE_UART
     UART_Send((uint8_t *)&c, 1);
 #endif
+#ifdef ENABLE_USB_DUAL_CDC
+    VCP_LogPutchar(c);
+#endif
 
 }
 
@@ -77,15 +83,14 @@ void Main(void)
 {
     SYSTICK_Init();
     BOARD_Init();
+    BOOT_ProfileMark("board");
 
     boot_counter_10ms = 250;   // 2.5 sec
 
 #ifdef ENABLE_UART
     UART_Init();
     UART_Send(UART_Version, strlen(UART_Version));
-#endif
-#ifdef ENABLE_USB
-    VCP_Init();
+    BOOT_ProfileMark("uart");
 #endif
 
     // Not implementing authentic device checks
@@ -94,10 +99,18 @@ void Main(void)
     gDTMF_String[sizeof(gDTMF_String) - 1] = 0;
 
     BK4819_Init();
+    BOOT_ProfileMark("bk4819");
 
     BOARD_ADC_GetBatteryInfo(&gBatteryCurrentVoltage, &gBatteryCurrent);
 
+#ifdef ENABLE_FAST_BOOT
+    // settings are read in many small pieces, get the sector in one go.
+    // With ENABLE_FLASH_SPARE_SECTOR the cache is one page and covers only
+    // 0xA000-0xA0FF; the rest of the 0x170-byte block is read from flash
+    PY25Q16_Prefetch(0x00A000);
+#endif
     SETTINGS_InitEEPROM();
+    BOOT_ProfileMark("settings");
 
     #ifdef ENABLE_FEAT_F4HWN
         gDW = gEeprom.DUAL_WATCH;
@@ -106,18 +119,22 @@ void Main(void)
 
     SETTINGS_WriteBuildOptions();
     SETTINGS_LoadCalibration();
+    BOOT_ProfileMark("calibration");
 
     RADIO_ConfigureChannel(0, VFO_CONFIGURE_RELOAD);
     RADIO_ConfigureChannel(1, VFO_CONFIGURE_RELOAD);
 
     RADIO_SelectVfos();
+    BOOT_ProfileMark("channels");
 
     RADIO_SetupRegisters(true);
+    BOOT_ProfileMark("registers");
 
     for (unsigned int i = 0; i < ARRAY_SIZE(gBatteryVoltages); i++)
         BOARD_ADC_GetBatteryInfo(&gBatteryVoltages[i], &gBatteryCurrent);
 
     BATTERY_GetReadings(false);
+    BOOT_ProfileMark("battery");
 
 #ifdef ENABLE_AM_FIX
     AM_fix_init();
@@ -193,6 +210,17 @@ void Main(void)
         gKeyReading1 = KEY_INVALID;
         gDebounceCounter = 0;
     }
+    BOOT_ProfileMark("boot mode");
+
+#ifdef ENABLE_USB
+    // the USB personality is picked by the boot mode, so enumerate only now
+    #ifdef ENABLE_USB_MSC
+        if (BootMode == BOOT_MODE_USB_DISK)
+            USBDISK_Run(); // does not return
+    #endif
+    VCP_Init();
+    BOOT_ProfileMark("usb");
+#endif
 
     if (!gChargingWithTypeC && gBatteryDisplayLevel == 0)
     {
@@ -225,7 +253,12 @@ void Main(void)
                     break;
                 }
             }
+            BOOT_ProfileMark("welcome");
+#ifndef ENABLE_FAST_BOOT
+            // fast boot skips this, nothing it depends on changed since the first pass
             RADIO_SetupRegisters(true);
+            BOOT_ProfileMark("registers");
+#endif
         }
 
 #ifdef ENABLE_PWRON_PASSWORD
@@ -277,6 +310,9 @@ void Main(void)
 #endif
     }
 
+    // boot is done with the blocking key reads, scan in the background from now on
+    KEYBOARD_StartScan();
+
     #ifdef ENABLE_FEAT_F4HWN_RESUME_STATE
         if (gEeprom.CURRENT_STATE == 2 || gEeprom.CURRENT_STATE == 5)
             CHFRSCANNER_ScanRange();
@@ -310,10 +346,19 @@ void Main(void)
                 break;
         }
     #endif
-        
+
+    BOOT_ProfileMark("ready");
+    BOOT_ProfileReport();
+
     while (true) {
         APP_Update();
 
+        // background flash writes, kept synchronous while the battery is low
+        if (gLowBattery)
+            PY25Q16_Flush();
+        else
+            PY25Q16_Process();
+
         if (gNextTimeslice) {
 
             APP_TimeSlice10ms();
@@ -22,6 +22,7 @@
 
 const uint8_t     fm_radio_countdown_500ms         =  2000 / 500;  // 2 seconds
 const uint16_t    fm_play_countdown_scan_10ms      =   100 / 10;   // 100ms
+const uint16_t    fm_probe_countdown_scan_10ms     =    30 / 10;   // 30ms
 const uint16_t    fm_play_countdown_noscan_10ms    =  1200 / 10;   // 1.2 seconds
 const uint16_t    fm_restore_countdown_10ms        =  5000 / 10;   // 5 seconds
 
@@ -140,8 +141,6 @@ enum BacklightOnRxTx_t gSetting_backlight_on_tx_rx;
     uint8_t       gDW = 0;
     uint8_t       gCB = 0;
     bool          gSaveRxMode = false;
-    uint8_t       crc[15] = { 0 };
-    uint8_t       lErrorsDuringAirCopy = 0;
     uint8_t       gAircopyStep = 0;
     uint8_t       gAircopyCurrentMapIndex = 0;
     bool          gAirCopyBootMode = 0;
@@ -393,6 +392,9 @@ unsigned long StrToUL(const char * str)
     static uint32_t cache_misses = 0;
 #endif
 
+// Scan exclusions, bit per MR channel
+static uint8_t gMR_ChannelExcluded[MR_CHANNELS_MAX / 8];
+
 // 
 // Internal Helper Functions
 // 
@@ -579,6 +581,28 @@ void MR_SetChannelAttributes(uint16_t channel_id, const ChannelAttributes_t* att
     }
 }
 
+bool MR_IsChannelExcluded(uint16_t channel_id)
+{
+    if (channel_id >= MR_CHANNELS_MAX) {
+        return false;
+    }
+
+    return gMR_ChannelExcluded[channel_id / 8] & (1u << (channel_id % 8));
+}
+
+void MR_SetChannelExcluded(uint16_t channel_id, bool exclude)
+{
+    if (channel_id >= MR_CHANNELS_MAX) {
+        return;
+    }
+
+    if (exclude) {
+        gMR_ChannelExcluded[channel_id / 8] |= 1u << (channel_id % 8);
+    } else {
+        gMR_ChannelExcluded[channel_id / 8] &= ~(1u << (channel_id % 8));
+    }
+}
+
 // Invalidate entire cache (call after loading Flash backup)
 void MR_InvalidateChannelAttributesCache(void)
 {
@@ -91,6 +91,7 @@ enum BacklightOnRxTx_t {
 
 extern const uint8_t         fm_radio_countdown_500ms;
 extern const uint16_t        fm_play_countdown_scan_10ms;
+extern const uint16_t        fm_probe_countdown_scan_10ms;
 extern const uint16_t        fm_play_countdown_noscan_10ms;
 extern const uint16_t        fm_restore_countdown_10ms;
 
@@ -202,8 +203,6 @@ extern enum BacklightOnRxTx_t gSetting_backlight_on_tx_rx;
     extern uint8_t            gDW;
     extern uint8_t            gCB;
     extern bool               gSaveRxMode;
-    extern uint8_t            crc[15];
-    extern uint8_t            lErrorsDuringAirCopy;
     extern uint8_t            gAircopyStep;
     extern uint8_t            gAircopyCurrentMapIndex;
     extern bool               gAirCopyBootMode;
@@ -240,7 +239,7 @@ typedef union {
             compander : 2,
             unused_1 :  1,
             unused_2 :  1,
-            exclude :   1,
+            exclude :   1,  // codeplug flag, scan exclusions live in RAM (MR_IsChannelExcluded)
             scanlist :  8;
     };
     uint16_t __val;
@@ -296,6 +295,11 @@ void MR_SaveChannelAttributesToFlash(uint16_t channel_id, const ChannelAttribute
 
 extern ChannelAttributes_t   gMR_ChannelAttributes_Current;  // Current VFO attributes (for speed)
 
+// Channels excluded while scanning, until the next start. Kept in RAM so
+// that excluding a channel never writes flash.
+bool MR_IsChannelExcluded(uint16_t channel_id);
+void MR_SetChannelExcluded(uint16_t channel_id, bool exclude);
+
 extern volatile uint16_t     gBatterySaveCountdown_10ms;
 
 extern volatile bool         gPowerSaveCountdownExpired;
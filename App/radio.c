@@ -22,6 +22,7 @@
 #ifdef ENABLE_FMRADIO
     #include "app/fm.h"
 #endif
+#include "app/sqlcal.h"
 #include "audio.h"
 #include "dcs.h"
 #include "driver/bk4819.h"
@@ -31,6 +32,7 @@
 #include "frequencies.h"
 #include "functions.h"
 #include "helper/battery.h"
+#include "helper/rssi.h"
 #include "misc.h"
 #include "radio.h"
 #include "settings.h"
@@ -94,7 +96,7 @@ bool RADIO_CheckValidList(uint8_t scanList)
 
     for (uint16_t i = 0; IS_MR_CHANNEL(i); i++) {
         const ChannelAttributes_t* att = MR_GetChannelAttributes(i);
-        if(att->scanlist == scanList && att->exclude == false)
+        if(att->scanlist == scanList && !MR_IsChannelExcluded(i))
         {
             return true;
         }
@@ -136,7 +138,7 @@ bool RADIO_CheckValidChannel(uint16_t channel, bool checkScanList, uint8_t scanL
     // return true if the channel appears valid
     if (!IS_MR_CHANNEL(channel))
         return false;
-    if (checkScanList && att->exclude == true)
+    if (checkScanList && MR_IsChannelExcluded(channel))
         return false;
     if (att->band > BAND7_470MHz)
         return false;
@@ -479,9 +481,29 @@ void RADIO_ConfigureChannel(const unsigned int VFO, const unsigned int configure
     RADIO_ConfigureSquelchAndOutputPower(pVfo);
 }
 
-void RADIO_ConfigureSquelchAndOutputPower(VFO_Info_t *pInfo)
+// the VFO dependent part of RADIO_SetupRegisters(), recorded per VFO for dual
+// watch and per priority channel for the look-back
+#ifdef ENABLE_PRIORITY_WATCH
+    static BK4819_Image_t gRxImage[4];      // VFO A, VFO B, priority 1, priority 2
+
+    static uint16_t gPriorityImageChannel[2];
+    static uint8_t  gPriorityOpenRssi[2];
+    static bool     gPriorityAM[2];
+    static bool     gOnPriority;                // tuned away from gRxVfo
+#else
+    static BK4819_Image_t gRxImage[2];
+#endif
+
+static void RADIO_DiscardRxImages(void)
 {
+    for (unsigned int i = 0; i < ARRAY_SIZE(gRxImage); i++)
+        gRxImage[i].Count = 0;
+}
 
+void RADIO_ConfigureSquelchAndOutputPower(VFO_Info_t *pInfo)
+{
+    // the squelch thresholds are part of the recorded images
+    RADIO_DiscardRxImages();
 
     // *******************************
     // squelch
@@ -544,6 +566,17 @@ void RADIO_ConfigureSquelchAndOutputPower(VFO_Info_t *pInfo)
 
         pInfo->SquelchOpenNoiseThresh   = (noise_open   > 127) ? 127 : noise_open;
         pInfo->SquelchCloseNoiseThresh  = (noise_close  > 127) ? 127 : noise_close;
+
+#ifdef ENABLE_SQUELCH_CAL
+        if (gEeprom.SQUELCH_CAL[Band] != SQLCAL_NONE)
+        {   // open 1dB per level (plus 1dB) above what the empty band reached
+            // when it was measured, close 2dB below that
+            const uint16_t rssi_open = gEeprom.SQUELCH_CAL[Band] + 2 + gEeprom.SQUELCH_LEVEL * 2;
+
+            pInfo->SquelchOpenRSSIThresh  = (rssi_open > 255) ? 255 : rssi_open;
+            pInfo->SquelchCloseRSSIThresh = pInfo->SquelchOpenRSSIThresh - 4;
+        }
+#endif
     }
 
     // *******************************
@@ -740,7 +773,23 @@ void RADIO_SelectVfos(void)
     RADIO_SelectCurrentVfo();
 }
 
-void RADIO_SetupRegisters(bool switchToForeground)
+static void RADIO_ClearInterrupts(void)
+{
+    while (1)
+    {
+        const uint16_t Status = BK4819_ReadRegister(BK4819_REG_0C);
+        if ((Status & 1u) == 0) // INTERRUPT REQUEST
+            break;
+
+        BK4819_WriteRegister(BK4819_REG_02, 0);
+        SYSTEM_DelayMs(1);
+    }
+    BK4819_WriteRegister(BK4819_REG_3F, 0);
+}
+
+// Everything RADIO_SetupRegisters() programs that depends on gRxVfo, other
+// than the AGC.
+static void RADIO_SetupRxRegisters(void)
 {
     BK4819_FilterBandwidth_t Bandwidth = gRxVfo->CHANNEL_BANDWIDTH;
 
@@ -751,12 +800,6 @@ void RADIO_SetupRegisters(bool switchToForeground)
         }
     #endif
 
-    AUDIO_AudioPathOff();
-
-    gEnableSpeaker = false;
-
-    BK4819_ToggleGpioOut(BK4819_GPIO6_PIN2_GREEN, false);
-
     if (gRxVfo->Modulation == MODULATION_AM)
         BK4819_SetFilterBandwidth(BK4819_FILTER_BW_AM, true);
     else
@@ -779,26 +822,6 @@ void RADIO_SetupRegisters(bool switchToForeground)
         }
     }
 
-    BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, false);
-
-    BK4819_SetupPowerAmplifier(0, 0);
-
-    BK4819_ToggleGpioOut(BK4819_GPIO1_PIN29_PA_ENABLE, false);
-
-    while (1)
-    {
-        const uint16_t Status = BK4819_ReadRegister(BK4819_REG_0C);
-        if ((Status & 1u) == 0) // INTERRUPT REQUEST
-            break;
-
-        BK4819_WriteRegister(BK4819_REG_02, 0);
-        SYSTEM_DelayMs(1);
-    }
-    BK4819_WriteRegister(BK4819_REG_3F, 0);
-
-    // mic gain 0.5dB/step 0 to 63
-    BK4819_WriteRegister(BK4819_REG_7D, 0xE940 | (gEeprom.MIC_SENSITIVITY_TUNING & 0x3f));
-
     uint32_t Frequency;
     #ifdef ENABLE_NOAA
         if (!IS_NOAA_CHANNEL(gRxVfo->CHANNEL_SAVE) || !gIsNoaaMode)
@@ -820,15 +843,6 @@ void RADIO_SetupRegisters(bool switchToForeground)
     // what does this in do ?
     BK4819_ToggleGpioOut(BK4819_GPIO0_PIN28_RX_ENABLE, true);
 
-    // AF RX Gain and DAC
-    //BK4819_WriteRegister(BK4819_REG_48, 0xB3A8);  // 1011 00 111010 1000
-    BK4819_WriteRegister(BK4819_REG_48,
-        (11u << 12)                 |     // ??? .. 0 ~ 15, doesn't seem to make any difference
-        ( 0u << 10)                 |     // AF Rx Gain-1
-        (gEeprom.VOLUME_GAIN << 4) |     // AF Rx Gain-2
-        (gEeprom.DAC_GAIN    << 0));     // AF DAC Gain (after Gain-1 and Gain-2)
-
-
     uint16_t InterruptMask = BK4819_REG_3F_SQUELCH_FOUND | BK4819_REG_3F_SQUELCH_LOST;
 
     #ifdef ENABLE_NOAA
@@ -926,11 +940,52 @@ void RADIO_SetupRegisters(bool switchToForeground)
     BK4819_EnableDTMF();
     InterruptMask |= BK4819_REG_3F_DTMF_5TONE_FOUND;
 
-    RADIO_SetupAGC(gRxVfo->Modulation == MODULATION_AM, false);
-    //RADIO_SetupAGC(false, false);
-
     // enable/disable BK4819 selected interrupts
     BK4819_WriteRegister(BK4819_REG_3F, InterruptMask);
+}
+
+void RADIO_SetupRegisters(bool switchToForeground)
+{
+    // the beep tone comes from the same chip
+    AUDIO_BeepWait();
+
+    // whatever went into them may have changed
+    RADIO_DiscardRxImages();
+
+#ifdef ENABLE_PRIORITY_WATCH
+    gOnPriority = false;
+#endif
+
+    AUDIO_AudioPathOff();
+
+    gEnableSpeaker = false;
+
+    BK4819_ToggleGpioOut(BK4819_GPIO6_PIN2_GREEN, false);
+
+    BK4819_ToggleGpioOut(BK4819_GPIO5_PIN1_RED, false);
+
+    BK4819_SetupPowerAmplifier(0, 0);
+
+    BK4819_ToggleGpioOut(BK4819_GPIO1_PIN29_PA_ENABLE, false);
+
+    RADIO_ClearInterrupts();
+
+    // mic gain 0.5dB/step 0 to 63
+    BK4819_WriteRegister(BK4819_REG_7D, 0xE940 | (gEeprom.MIC_SENSITIVITY_TUNING & 0x3f));
+
+    // AF RX Gain and DAC
+    //BK4819_WriteRegister(BK4819_REG_48, 0xB3A8);  // 1011 00 111010 1000
+    BK4819_WriteRegister(BK4819_REG_48,
+        (11u << 12)                 |     // ??? .. 0 ~ 15, doesn't seem to make any difference
+        ( 0u << 10)                 |     // AF Rx Gain-1
+        (gEeprom.VOLUME_GAIN << 4) |     // AF Rx Gain-2
+        (gEeprom.DAC_GAIN    << 0));     // AF DAC Gain (after Gain-1 and Gain-2)
+
+    RADIO_SetupRxRegisters();
+    RSSI_Invalidate();
+
+    RADIO_SetupAGC(gRxVfo->Modulation == MODULATION_AM, false);
+    //RADIO_SetupAGC(false, false);
 
     FUNCTION_Init();
 
@@ -938,6 +993,131 @@ void RADIO_SetupRegisters(bool switchToForeground)
         FUNCTION_Select(FUNCTION_FOREGROUND);
 }
 
+// Retune to gRxVfo from its image, recording it first if there is none.
+// Only the registers that differ from what the chip holds get written.
+static bool RADIO_TuneRxVfo(void)
+{
+    BK4819_Image_t *pImage = &gRxImage[(gRxVfo == &gEeprom.VfoInfo[0]) ? 0 : 1];
+
+    if (pImage->Count == 0)
+    {
+        BK4819_ImageBegin(pImage);
+        RADIO_SetupRxRegisters();
+        if (!BK4819_ImageEnd())
+            return false;
+    }
+
+    RADIO_ClearInterrupts();
+
+    BK4819_ImageApply(pImage);
+    RSSI_Invalidate();
+
+    RADIO_SetupAGC(gRxVfo->Modulation == MODULATION_AM, false);
+
+#ifdef ENABLE_PRIORITY_WATCH
+    gOnPriority = false;
+#endif
+
+    return true;
+}
+
+// Dual watch retune to gRxVfo. Mic and AF gains are the same for both VFOs and
+// are left alone.
+void RADIO_SwitchRxVfo(void)
+{
+    AUDIO_AudioPathOff();
+
+    gEnableSpeaker = false;
+
+    if (!RADIO_TuneRxVfo())
+    {
+        RADIO_SetupRegisters(false);
+        return;
+    }
+
+    FUNCTION_Init();
+}
+
+#ifdef ENABLE_PRIORITY_WATCH
+    // Load Channel into gRxVfo just long enough to record its image. Nothing
+    // the other images were built from changes, so they are kept.
+    static bool RADIO_RecordPriority(unsigned int Index, uint16_t Channel)
+    {
+        BK4819_Image_t   *pImage = &gRxImage[2 + Index];
+        const unsigned int Vfo   = (gRxVfo == &gEeprom.VfoInfo[0]) ? 0 : 1;
+        const VFO_Info_t   Saved = *gRxVfo;
+        const uint16_t     ScreenChannel = gEeprom.ScreenChannel[Vfo];
+        const uint16_t     MrChannel     = gEeprom.MrChannel[Vfo];
+        uint8_t            Count[ARRAY_SIZE(gRxImage)];
+        bool               Ok;
+
+        for (unsigned int i = 0; i < ARRAY_SIZE(gRxImage); i++)
+            Count[i] = gRxImage[i].Count;
+
+        gEeprom.ScreenChannel[Vfo] = Channel;
+        RADIO_ConfigureChannel(Vfo, VFO_CONFIGURE_RELOAD);
+
+        for (unsigned int i = 0; i < ARRAY_SIZE(gRxImage); i++)
+            gRxImage[i].Count = Count[i];
+
+        // an empty channel loads as something else
+        Ok = gRxVfo->CHANNEL_SAVE == Channel;
+        if (Ok)
+        {
+            BK4819_ImageBegin(pImage);
+            RADIO_SetupRxRegisters();
+            Ok = BK4819_ImageEnd();
+
+            gPriorityImageChannel[Index] = Channel;
+            gPriorityOpenRssi[Index]     = gRxVfo->SquelchOpenRSSIThresh;
+            gPriorityAM[Index]           = gRxVfo->Modulation == MODULATION_AM;
+        }
+
+        *gRxVfo                    = Saved;
+        gEeprom.ScreenChannel[Vfo] = ScreenChannel;
+        gEeprom.MrChannel[Vfo]     = MrChannel;
+
+        return Ok;
+    }
+
+    // Priority look-back: tune the receiver to memory channel Channel without
+    // touching the VFOs. Its squelch is left to the caller, which compares the
+    // RSSI against *pOpenRssi; no interrupts are raised while away.
+    bool RADIO_TuneToPriority(unsigned int Index, uint16_t Channel, uint8_t *pOpenRssi)
+    {
+        BK4819_Image_t *pImage = &gRxImage[2 + Index];
+
+        if (pImage->Count == 0 || gPriorityImageChannel[Index] != Channel)
+            if (!RADIO_RecordPriority(Index, Channel))
+                return false;
+
+        RADIO_ClearInterrupts();
+
+        BK4819_ImageApply(pImage);
+        BK4819_WriteRegister(BK4819_REG_3F, 0);
+        RSSI_Invalidate();
+
+        RADIO_SetupAGC(gPriorityAM[Index], false);
+
+        *pOpenRssi  = gPriorityOpenRssi[Index];
+        gOnPriority = true;
+
+        return true;
+    }
+
+    bool RADIO_IsOnPriority(void)
+    {
+        return gOnPriority;
+    }
+
+    // and back to gRxVfo, leaving the current function as it is
+    void RADIO_TuneBackToRxVfo(void)
+    {
+        if (!RADIO_TuneRxVfo())
+            RADIO_SetupRegisters(true);
+    }
+#endif
+
 #ifdef ENABLE_NOAA
     void RADIO_ConfigureNOAA(void)
     {
@@ -1341,6 +1521,10 @@ void RADIO_SendCssTail(void)
 
 void RADIO_SendEndOfTransmission(void)
 {
+    // a PTT-ID still going out at the start of the over has to finish
+    // before the roger reprograms the tone generator
+    BK4819_ToneSeq_Wait();
+
     BK4819_PlayRoger();
     DTMF_SendEndOfTransmission();
 
@@ -158,6 +158,12 @@ void     RADIO_ConfigureSquelchAndOutputPower(VFO_Info_t *pInfo);
 void     RADIO_ApplyOffset(VFO_Info_t *pInfo);
 void     RADIO_SelectVfos(void);
 void     RADIO_SetupRegisters(bool switchToForeground);
+void     RADIO_SwitchRxVfo(void);
+#ifdef ENABLE_PRIORITY_WATCH
+    bool RADIO_TuneToPriority(unsigned int Index, uint16_t Channel, uint8_t *pOpenRssi);
+    void RADIO_TuneBackToRxVfo(void);
+    bool RADIO_IsOnPriority(void);
+#endif
 #ifdef ENABLE_NOAA
     void RADIO_ConfigureNOAA(void);
 #endif
@@ -44,6 +44,20 @@
 
 static volatile uint32_t gGlobalSysTickCounter;
 
+// SysTick cycles since SYSTICK_Init(), wraps after ~89 s at 48 MHz
+uint32_t SCHEDULER_GetCycles(void)
+{
+    uint32_t Ticks;
+    uint32_t Value;
+
+    do {
+        Ticks = gGlobalSysTickCounter;
+        Value = SysTick->VAL;
+    } while (Ticks != gGlobalSysTickCounter);
+
+    return Ticks * (SysTick->LOAD + 1) + (SysTick->LOAD - Value);
+}
+
 // we come here every 10ms
 void SysTick_Handler(void)
 {
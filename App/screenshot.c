@@ -19,16 +19,29 @@
 #include "screenshot.h"
 #include "misc.h"
 #include "driver/vcp.h"
+#include "driver/crc.h"
 #include "driver/keyboard.h"
 #include "ui/ui.h"
 
 // SRAM optimization: minimize static allocations
-// - previousFrame: 1024 bytes (REQUIRED - need to compare for delta)
-// - No currentFrame or deltaFrame static buffers
-static uint8_t previousFrame[1024] = {0};
+// - previousCrc: 256 bytes, a CRC of each chunk as last sent instead of a
+//   1 KiB copy of the frame. A change the CRC misses is sent again when
+//   forcedBlock comes round to its chunk.
+// - No currentFrame or deltaFrame buffers, static or on the stack: chunks
+//   are rebuilt from the LCD buffers when needed (see SCREENSHOT_Chunk())
+// The scratch region cannot hold any of it, the stream runs alongside the
+// modes that take the region.
+static uint16_t previousCrc[128] = {0};
 static uint8_t forcedBlock = 0;
 static uint8_t keepAlive = 3;
 
+// Frame being sent: chunks selected by the first pass and not yet queued
+static uint8_t pendingChunks[128 / 8];
+static uint8_t nextChunk;
+static bool    framePending = false;
+
+static bool SCREENSHOT_Continue(void);
+
 void SCREENSHOT_ParseInput(void)
 {
     if (SCREENSHOT_IsLocked())
@@ -42,35 +55,95 @@ void SCREENSHOT_ParseInput(void)
         keepAlive = 15;
         gUSB_ScreenshotEnabled = true;
     }
+
+    // Called on every pass of the main loop and of the mode loops: finish a
+    // frame that did not fit into the TX ring
+    SCREENSHOT_Continue();
 }
 
 static void SCREENSHOT_Send(const uint8_t *buf, uint16_t len)
 {
     if (gUSB_ScreenshotEnabled) {
-        cdc_acm_data_send_with_dtr(buf, len);
+        VCP_StreamSend(buf, len);
     } else {
         UART_Send(buf, len);
     }
 }
 
-void SCREENSHOT_Line(uint8_t *src, uint8_t *dest, uint16_t *idx) {
-    for (uint8_t b = 0; b < 8; b++) {
-        for (uint8_t i = 0; i < 128; i += 8) {
-            uint8_t acc = 0;
-            for (uint8_t k = 0; k < 8; k++) {
-                if (src[i + k] & (1 << b)) acc |= (1 << k);
-            }
-            dest[(*idx)++] = gSetting_set_inv ? ~acc : acc;
+static uint32_t SCREENSHOT_GetTxFree(void)
+{
+    if (gUSB_ScreenshotEnabled)
+        return VCP_StreamGetTxFree();
+
+    return UART_GetTxFree();
+}
+
+// Bytes Chunk * 8 .. Chunk * 8 + 7 of the frame as the viewer expects it:
+// display line Chunk / 16, pixel row (Chunk % 16) / 2, one byte per 8 columns
+// from column 64 * (Chunk % 2) on. Built straight from the LCD buffers so no
+// copy of the whole frame is needed.
+static void SCREENSHOT_Chunk(uint8_t Chunk, bool dualTightTop, uint8_t *dest)
+{
+    const uint8_t  l = Chunk / 16;
+    const uint8_t  b = (Chunk % 16) / 2;
+    const uint8_t *src;
+
+    // Dual VFO tight-top: full screen in gFrameBuffer[0..7]. Else: gStatusLine + gFrameBuffer[0..6].
+    if (dualTightTop)
+        src = gFrameBuffer[l];
+    else
+        src = (l == 0) ? gStatusLine : gFrameBuffer[l - 1];
+
+    src += (Chunk % 2) * 64;
+
+    for (uint8_t j = 0; j < 8; j++, src += 8) {
+        uint8_t acc = 0;
+        for (uint8_t k = 0; k < 8; k++) {
+            if (src[k] & (1 << b)) acc |= (1 << k);
         }
+        dest[j] = gSetting_set_inv ? ~acc : acc;
+    }
+}
+
+// Sends the chunks still marked in pendingChunks for as long as the TX
+// ring has room, then the end marker. Whatever does not fit is left for
+// the next call, so the sender never waits for the host.
+static bool SCREENSHOT_Continue(void)
+{
+    if (!framePending)
+        return true;
+
+    const bool dualTightTop = UI_IsDualVfoMainScreen();
+    uint8_t chunk[9];
+
+    for (; nextChunk < 128; nextChunk++) {
+        if (!(pendingChunks[nextChunk / 8] & (1u << (nextChunk % 8))))
+            continue;
+
+        if (SCREENSHOT_GetTxFree() < sizeof(chunk))
+            return false;
+
+        chunk[0] = nextChunk;
+        SCREENSHOT_Chunk(nextChunk, dualTightTop, &chunk[1]);
+
+        SCREENSHOT_Send(chunk, 9);
+
+        // Update previousCrc for next comparison
+        previousCrc[nextChunk] = CRC_Calculate(&chunk[1], 8);
     }
+
+    if (SCREENSHOT_GetTxFree() < 1)
+        return false;
+
+    uint8_t end = 0x0A;
+    SCREENSHOT_Send(&end, 1);
+
+    framePending = false;
+    return true;
 }
 
 void SCREENSHOT_Update(bool force)
 {
-    // Build frame in a temporary stack buffer
-    // This is 1024 bytes but it's temporary and gets freed after the function
-    uint8_t frameBuffer[1024];
-    uint16_t index = 0;
     static bool wasConnected = false;
 
     if (SCREENSHOT_IsLocked())
@@ -80,49 +153,40 @@ void SCREENSHOT_Update(bool force)
         if (--keepAlive == 0) {
             // Connection just lost → reset state for next reconnection
             wasConnected = false;
+            framePending = false;
             return;
         }
     } else {
         return;
     }
 
+    // Previous frame still draining: previousCrc only holds what was sent,
+    // so the changes made meanwhile go out with the next frame
+    if (!SCREENSHOT_Continue())
+        return;
+
     // Connection is alive — detect reconnection and force full frame
     if (!wasConnected) {
         force = true;
         wasConnected = true;
     }
 
-    // ==== BUILD FRAME ONCE ====
-    // Dual VFO tight-top: full screen in gFrameBuffer[0..7]. Else: gStatusLine + gFrameBuffer[0..6].
     const bool dualTightTop = UI_IsDualVfoMainScreen();
 
-    if (dualTightTop) {
-        for (uint8_t l = 0; l < 8; l++)
-            SCREENSHOT_Line(gFrameBuffer[l], frameBuffer, &index);
-    } else {
-        SCREENSHOT_Line(gStatusLine, frameBuffer, &index);
-        for (uint8_t l = 0; l < 7; l++)
-            SCREENSHOT_Line(gFrameBuffer[l], frameBuffer, &index);
-    }
-
-    if (index != 1024)
-        return;
-
-    // ==== FIRST PASS: Count changed chunks ====
+    // ==== FIRST PASS: Select changed chunks ====
     uint16_t deltaLen = 0;
-    uint8_t changedChunks[128];  // List of changed chunk indices
-    uint8_t changedCount = 0;
+    uint8_t cur[8];
+
+    memset(pendingChunks, 0, sizeof(pendingChunks));
 
     for (uint8_t chunk = 0; chunk < 128; chunk++) {
-        uint8_t *cur = &frameBuffer[chunk * 8];
-        uint8_t *prev = &previousFrame[chunk * 8];
+        SCREENSHOT_Chunk(chunk, dualTightTop, cur);
 
-        bool changed = memcmp(cur, prev, 8) != 0;
+        bool changed = CRC_Calculate(cur, 8) != previousCrc[chunk];
         bool isForced = (chunk == forcedBlock);
-        bool fullUpdate = force;
 
-        if (changed || isForced || fullUpdate) {
-            changedChunks[changedCount++] = chunk;
+        if (changed || isForced || force) {
+            pendingChunks[chunk / 8] |= 1u << (chunk % 8);
             deltaLen += 9;
         }
     }
@@ -133,10 +197,13 @@ void SCREENSHOT_Update(bool force)
         return;
 
     // Skip transmission if a key is currently pressed
-    // UART_Send is blocking - would freeze the main loop and lose keypresses
     if (gKeyReading0 != KEY_INVALID)
         return;
 
+    // Marker and header go out together, the chunks as the ring drains
+    if (SCREENSHOT_GetTxFree() < 6)
+        return;
+
     // ==== Send version marker (for backward compatibility detection) ====
     // New format: sends 0xFF before header
     // Old format: doesn't exist, so viewers can differentiate
@@ -152,23 +219,9 @@ void SCREENSHOT_Update(bool force)
 
     SCREENSHOT_Send(header, 5);
 
-    // ==== SECOND PASS: Send only changed chunks ====
-    uint8_t chunk[9];
-    
-    for (uint8_t i = 0; i < changedCount; i++) {
-        uint8_t chunkIdx = changedChunks[i];
-        uint8_t *cur = &frameBuffer[chunkIdx * 8];
-        uint8_t *prev = &previousFrame[chunkIdx * 8];
-
-        chunk[0] = chunkIdx;
-        memcpy(&chunk[1], cur, 8);
-        
-        SCREENSHOT_Send(chunk, 9);
-        
-        // Update previousFrame for next comparison
-        memcpy(prev, cur, 8);
-    }
-
-    uint8_t end = 0x0A;
-    SCREENSHOT_Send(&end, 1);
-}
\ No newline at end of file
+    // ==== SECOND PASS: Send the selected chunks ====
+    // Contents are taken from the LCD buffers at send time
+    nextChunk = 0;
+    framePending = true;
+    SCREENSHOT_Continue();
+}
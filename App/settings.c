@@ -26,14 +26,21 @@
 #include "driver/py25q16.h"
 #include "misc.h"
 #include "settings.h"
+#include "settings_fields.h"
 #include "ui/menu.h"
 
 EEPROM_Config_t gEeprom = { 0 };
 
-void SETTINGS_InitEEPROM(void)
+static void SETTINGS_DecodeDtmfCode(char *pCode, unsigned int Size, uint8_t *pData, const char *pDefault)
 {
-    uint8_t Data[16] = {0};
+    if (DTMF_ValidateCodes((char *)pData, Size))
+        memcpy(pCode, pData, Size);
+    else
+        strcpy(pCode, pDefault);
+}
 
+void SETTINGS_InitEEPROM(void)
+{
     //
     // Version check
     // Read stored version from EEPROM and compare with VERSION_STRING_2
@@ -118,85 +125,33 @@ void SETTINGS_InitEEPROM(void)
         }
     }
 
-    // 0E70..0E77
-    PY25Q16_ReadBuffer(0x00A000, Data, 8);
-    #ifdef ENABLE_FEAT_F4HWN_AUDIO
-        gSetting_set_audio = (Data[0] < 5) ? Data[0] : 0;
-    #endif
-    gEeprom.SQUELCH_LEVEL        = (Data[1] < 10) ? Data[1] : 1;
-    gEeprom.TX_TIMEOUT_TIMER     = (Data[2] > 4 && Data[2] < 180) ? Data[2] : 11;
-    #ifdef ENABLE_NOAA
-        gEeprom.NOAA_AUTO_SCAN   = (Data[3] <  2) ? Data[3] : false;
-    #endif
-    #ifdef ENABLE_FEAT_F4HWN_RESCUE_OPS
-        gEeprom.KEY_LOCK = (Data[4] & 0x01) != 0;
-        gEeprom.MENU_LOCK = (Data[4] & 0x02) != 0;
-        gEeprom.SET_KEY = ((Data[4] >> 2) & 0x0F) > 4 ? 0 : (Data[4] >> 2) & 0x0F;
-        gEeprom.SET_NAV = (Data[4] & 0x40) != 0;
-    #else
-        gEeprom.KEY_LOCK             = (Data[4] <  2) ? Data[4] : false;
-    #endif
-    #ifdef ENABLE_VOX
-        gEeprom.VOX_SWITCH       = (Data[5] <  2) ? Data[5] : false;
-        gEeprom.VOX_LEVEL        = (Data[6] < 10) ? Data[6] : 1;
-    #endif
-    gEeprom.MIC_SENSITIVITY      = (Data[7] <  9) ? Data[7] : 4;
+    uint8_t Block[SETTINGS_BLOCK_SIZE];
+
+    // one read for the whole block, everything below is decoded from RAM
+    PY25Q16_ReadBuffer(SETTINGS_BLOCK_ADDR, Block, sizeof(Block));
 
-    // 0E78..0E7F
-    PY25Q16_ReadBuffer(0x00A008, Data, 8);
-    gEeprom.BACKLIGHT_MAX         = (Data[0] & 0xF) <= 10 ? (Data[0] & 0xF) : 10;
-    gEeprom.BACKLIGHT_MIN         = (Data[0] >> 4) < gEeprom.BACKLIGHT_MAX ? (Data[0] >> 4) : 0;
+    SETTINGS_DecodeFields(Block);
+
+    // 0x00A008
+    if (gEeprom.BACKLIGHT_MIN >= gEeprom.BACKLIGHT_MAX)
+        gEeprom.BACKLIGHT_MIN = 0;
 #ifdef ENABLE_BLMIN_TMP_OFF
     gEeprom.BACKLIGHT_MIN_STAT    = BLMIN_STAT_ON;
 #endif
-    gEeprom.CHANNEL_DISPLAY_MODE  = (Data[1] < 4) ? Data[1] : MDF_FREQUENCY;    // 4 instead of 3 - extra display mode
-    gEeprom.CROSS_BAND_RX_TX      = (Data[2] < 3) ? Data[2] : CROSS_BAND_OFF;
-    gEeprom.BATTERY_SAVE          = (Data[3] < 6) ? Data[3] : 4;
-    gEeprom.DUAL_WATCH            = (Data[4] < 3) ? Data[4] : DUAL_WATCH_CHAN_A;
-    gEeprom.BACKLIGHT_TIME        = (Data[5] < 62) ? Data[5] : 12;
-    #ifdef ENABLE_FEAT_F4HWN_NARROWER
-        gEeprom.TAIL_TONE_ELIMINATION = Data[6] & 0x01;
-        gSetting_set_nfm = (Data[6] >> 1) & 0x01;
-        #ifdef ENABLE_FEAT_F4HWN_RESUME_STATE
-            gEeprom.VFO_OPEN = ((Data[6] >> 2) & 0x01) != 0 ? true : true;
-        #endif
-    #else
-        gEeprom.TAIL_TONE_ELIMINATION = (Data[6] < 2) ? Data[6] : false;
-    #endif
-
-    #ifdef ENABLE_FEAT_F4HWN_RESUME_STATE
-        gEeprom.CURRENT_STATE =  Data[7]        & 0x07;   // bits 0..2
-        gEeprom.CURRENT_LIST  = (Data[7] >> 3)  & 0x1F;   // bits 3..7
-    #else
-        gEeprom.VFO_OPEN              = (Data[7] < 2) ? Data[7] : true;
-    #endif
-
-    // 0E80..0E87
-    /*    
-    PY25Q16_ReadBuffer(0x00A010, Data, 8);
-    gEeprom.ScreenChannel[0]   = IS_VALID_CHANNEL(Data[0]) ? Data[0] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
-    gEeprom.ScreenChannel[1]   = IS_VALID_CHANNEL(Data[3]) ? Data[3] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
-    gEeprom.MrChannel[0]       = IS_MR_CHANNEL(Data[1])    ? Data[1] : MR_CHANNEL_FIRST;
-    gEeprom.MrChannel[1]       = IS_MR_CHANNEL(Data[4])    ? Data[4] : MR_CHANNEL_FIRST;
-    gEeprom.FreqChannel[0]     = IS_FREQ_CHANNEL(Data[2])  ? Data[2] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
-    gEeprom.FreqChannel[1]     = IS_FREQ_CHANNEL(Data[5])  ? Data[5] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
-#ifdef ENABLE_NOAA
-    gEeprom.NoaaChannel[0] = IS_NOAA_CHANNEL(Data[6])  ? Data[6] : NOAA_CHANNEL_FIRST;
-    gEeprom.NoaaChannel[1] = IS_NOAA_CHANNEL(Data[7])  ? Data[7] : NOAA_CHANNEL_FIRST;
+#if defined(ENABLE_FEAT_F4HWN_NARROWER) && defined(ENABLE_FEAT_F4HWN_RESUME_STATE)
+    gEeprom.VFO_OPEN = true;    // stored, but always on
 #endif
-    */
-
-// 0x00A010 .. 0x00A01F
-uint16_t Data16[8];
 
-PY25Q16_ReadBuffer(0x00A010, Data16, sizeof(Data16));
+    // 0x00A010 .. 0x00A01F
+    uint16_t Data16[8];
+    memcpy(Data16, Block + 0x010, sizeof(Data16));
 
-gEeprom.ScreenChannel[0] = IS_VALID_CHANNEL(Data16[0]) ? Data16[0] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
-gEeprom.MrChannel[0]     = IS_MR_CHANNEL(Data16[1]) ? Data16[1] : MR_CHANNEL_FIRST;
-gEeprom.FreqChannel[0]   = IS_FREQ_CHANNEL(Data16[2]) ? Data16[2] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
-gEeprom.ScreenChannel[1] = IS_VALID_CHANNEL(Data16[3]) ? Data16[3] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
-gEeprom.MrChannel[1]     = IS_MR_CHANNEL(Data16[4]) ? Data16[4] : MR_CHANNEL_FIRST;
-gEeprom.FreqChannel[1]   = IS_FREQ_CHANNEL(Data16[5]) ? Data16[5] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
+    gEeprom.ScreenChannel[0] = IS_VALID_CHANNEL(Data16[0]) ? Data16[0] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
+    gEeprom.MrChannel[0]     = IS_MR_CHANNEL(Data16[1]) ? Data16[1] : MR_CHANNEL_FIRST;
+    gEeprom.FreqChannel[0]   = IS_FREQ_CHANNEL(Data16[2]) ? Data16[2] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
+    gEeprom.ScreenChannel[1] = IS_VALID_CHANNEL(Data16[3]) ? Data16[3] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
+    gEeprom.MrChannel[1]     = IS_MR_CHANNEL(Data16[4]) ? Data16[4] : MR_CHANNEL_FIRST;
+    gEeprom.FreqChannel[1]   = IS_FREQ_CHANNEL(Data16[5]) ? Data16[5] : (FREQ_CHANNEL_FIRST + BAND6_400MHz);
 
 #ifdef ENABLE_NOAA
     gEeprom.NoaaChannel[0]   = IS_NOAA_CHANNEL(Data16[6]) ? Data16[6] : NOAA_CHANNEL_FIRST;
@@ -204,7 +159,7 @@ gEeprom.FreqChannel[1]   = IS_FREQ_CHANNEL(Data16[5]) ? Data16[5] : (FREQ_CHANNE
 #endif
 
 #ifdef ENABLE_FMRADIO
-    {   // 0E88..0E8F
+    {   // 0x00A020
         struct
         {
             uint16_t selFreq;
@@ -213,192 +168,87 @@ gEeprom.FreqChannel[1]   = IS_FREQ_CHANNEL(Data16[5]) ? Data16[5] : (FREQ_CHANNE
             uint8_t  band:2;
             //uint8_t  space:2;
         } __attribute__((packed)) fmCfg;
-        PY25Q16_ReadBuffer(0x00A020, &fmCfg, 4);
+        memcpy(&fmCfg, Block + 0x020, 4);
 
         gEeprom.FM_Band = fmCfg.band;
         //gEeprom.FM_Space = fmCfg.space;
-        gEeprom.FM_SelectedFrequency = 
-            (fmCfg.selFreq >= BK1080_GetFreqLoLimit(gEeprom.FM_Band) && fmCfg.selFreq <= BK1080_GetFreqHiLimit(gEeprom.FM_Band)) ? 
+        gEeprom.FM_SelectedFrequency =
+            (fmCfg.selFreq >= BK1080_GetFreqLoLimit(gEeprom.FM_Band) && fmCfg.selFreq <= BK1080_GetFreqHiLimit(gEeprom.FM_Band)) ?
                 fmCfg.selFreq : BK1080_GetFreqLoLimit(gEeprom.FM_Band);
-            
+
         gEeprom.FM_SelectedChannel = fmCfg.selChn;
         gEeprom.FM_IsMrMode        = fmCfg.isMrMode;
     }
 
-    // 0E40..0E67
-    PY25Q16_ReadBuffer(0x00A028, gFM_Channels, sizeof(gFM_Channels));
+    // 0x00A028
+    memcpy(gFM_Channels, Block + 0x028, sizeof(gFM_Channels));
     FM_ConfigureChannelState();
 #endif
 
-    // 0E90..0E97
-    PY25Q16_ReadBuffer(0x00A0A8, Data, 8);
-    gEeprom.BEEP_CONTROL                 = Data[0] & 1;
-    gEeprom.KEY_M_LONG_PRESS_ACTION      = ((Data[0] >> 1) < ACTION_OPT_LEN) ? (Data[0] >> 1) : ACTION_OPT_NONE;
-    gEeprom.KEY_1_SHORT_PRESS_ACTION     = (Data[1] < ACTION_OPT_LEN) ? Data[1] : ACTION_OPT_MONITOR;
-    gEeprom.KEY_1_LONG_PRESS_ACTION      = (Data[2] < ACTION_OPT_LEN) ? Data[2] : ACTION_OPT_NONE;
-    gEeprom.KEY_2_SHORT_PRESS_ACTION     = (Data[3] < ACTION_OPT_LEN) ? Data[3] : ACTION_OPT_SCAN;
-    gEeprom.KEY_2_LONG_PRESS_ACTION      = (Data[4] < ACTION_OPT_LEN) ? Data[4] : ACTION_OPT_NONE;
-    gEeprom.SCAN_RESUME_MODE             = (Data[5] < 105)            ? Data[5] : 14;
-    gEeprom.AUTO_KEYPAD_LOCK             = (Data[6] < 41)             ? Data[6] : 0;
-#ifdef ENABLE_FEAT_F4HWN
-    gEeprom.POWER_ON_DISPLAY_MODE        = (Data[7] < 6)              ? Data[7] : POWER_ON_DISPLAY_MODE_VOLTAGE;
-#else
-    gEeprom.POWER_ON_DISPLAY_MODE        = (Data[7] < 4)              ? Data[7] : POWER_ON_DISPLAY_MODE_VOLTAGE;
-#endif
-
-    // 0E98..0E9F
+    // 0x00A0B0
     #ifdef ENABLE_PWRON_PASSWORD
-        PY25Q16_ReadBuffer(0x00A0A8 + 0x8, Data, 8);
-        memcpy(&gEeprom.POWER_ON_PASSWORD, Data, 4);
+        memcpy(&gEeprom.POWER_ON_PASSWORD, Block + 0x0B0, 4);
     #endif
 
-    // 0EA0..0EA7
-    PY25Q16_ReadBuffer(0x00A0A8 + 0x10, Data, 8);
-    #ifdef ENABLE_VOICE
-    gEeprom.VOICE_PROMPT = (Data[0] < 3) ? Data[0] : VOICE_PROMPT_ENGLISH;
-    #endif
+    // 0x00A0B9
     #ifdef ENABLE_RSSI_BAR
         for (uint8_t i = 0; i < 7; i++) {
-            int8_t val = (int8_t)Data[i + 1];
+            int8_t val = (int8_t)Block[0x0B9 + i];
             if (val >= -64 && val <= 64)
                 dBmCorrTable[i] = val;
         }
     #endif
 
-    // 0EA8..0EAF
-    PY25Q16_ReadBuffer(0x00A0A8 + 0x18, Data, 8);
-    #ifdef ENABLE_ALARM
-        gEeprom.ALARM_MODE                 = (Data[0] <  2) ? Data[0] : true;
-    #endif
-    gEeprom.ROGER                          = (Data[1] <  3) ? Data[1] : ROGER_MODE_OFF;
-    gEeprom.REPEATER_TAIL_TONE_ELIMINATION = (Data[2] < 11) ? Data[2] : 0;
-    gEeprom.TX_VFO                         = (Data[3] <  2) ? Data[3] : 0;
-    gEeprom.BATTERY_TYPE                   = (Data[4] < BATTERY_TYPE_UNKNOWN) ? Data[4] : BATTERY_TYPE_1600_MAH;
-
-    // 0ED0..0ED7
-    PY25Q16_ReadBuffer(0x00A0A8 + 0x40, Data, 8);
-    gEeprom.DTMF_SIDE_TONE               = (Data[0] <   2) ? Data[0] : true;
-
+    // 0x00A0E8
 #ifdef ENABLE_DTMF_CALLING
-    gEeprom.DTMF_SEPARATE_CODE           = DTMF_ValidateCodes((char *)(Data + 1), 1) ? Data[1] : '*';
-    gEeprom.DTMF_GROUP_CALL_CODE         = DTMF_ValidateCodes((char *)(Data + 2), 1) ? Data[2] : '#';
-    gEeprom.DTMF_DECODE_RESPONSE         = (Data[3] <   4) ? Data[3] : 0;
-    gEeprom.DTMF_auto_reset_time         = (Data[4] <  61) ? Data[4] : (Data[4] >= 5) ? Data[4] : 10;
+    gEeprom.DTMF_SEPARATE_CODE           = DTMF_ValidateCodes((char *)(Block + 0x0E9), 1) ? Block[0x0E9] : '*';
+    gEeprom.DTMF_GROUP_CALL_CODE         = DTMF_ValidateCodes((char *)(Block + 0x0EA), 1) ? Block[0x0EA] : '#';
 #endif
-    gEeprom.DTMF_PRELOAD_TIME            = (Data[5] < 101) ? Data[5] * 10 : 300;
-    gEeprom.DTMF_FIRST_CODE_PERSIST_TIME = (Data[6] < 101) ? Data[6] * 10 : 100;
-    gEeprom.DTMF_HASH_CODE_PERSIST_TIME  = (Data[7] < 101) ? Data[7] * 10 : 100;
-
-    // 0ED8..0EDF
-    PY25Q16_ReadBuffer(0x00A0A8 + 0x48, Data, 8);
-    gEeprom.DTMF_CODE_PERSIST_TIME  = (Data[0] < 101) ? Data[0] * 10 : 100;
-    gEeprom.DTMF_CODE_INTERVAL_TIME = (Data[1] < 101) ? Data[1] * 10 : 100;
-#ifdef ENABLE_DTMF_CALLING
-    gEeprom.PERMIT_REMOTE_KILL      = (Data[2] <   2) ? Data[2] : true;
+    gEeprom.DTMF_PRELOAD_TIME            = (Block[0x0ED] < 101) ? Block[0x0ED] * 10 : 300;
+    gEeprom.DTMF_FIRST_CODE_PERSIST_TIME = (Block[0x0EE] < 101) ? Block[0x0EE] * 10 : 100;
+    gEeprom.DTMF_HASH_CODE_PERSIST_TIME  = (Block[0x0EF] < 101) ? Block[0x0EF] * 10 : 100;
+    gEeprom.DTMF_CODE_PERSIST_TIME       = (Block[0x0F0] < 101) ? Block[0x0F0] * 10 : 100;
+    gEeprom.DTMF_CODE_INTERVAL_TIME      = (Block[0x0F1] < 101) ? Block[0x0F1] * 10 : 100;
 
-    // 0EE0..0EE7
-
-    PY25Q16_ReadBuffer(0x00A0F8, Data, sizeof(gEeprom.ANI_DTMF_ID));
-    if (DTMF_ValidateCodes((char *)Data, sizeof(gEeprom.ANI_DTMF_ID))) {
-        memcpy(gEeprom.ANI_DTMF_ID, Data, sizeof(gEeprom.ANI_DTMF_ID));
-    } else {
-        strcpy(gEeprom.ANI_DTMF_ID, "123");
-    }
-
-
-    // 0EE8..0EEF
-    PY25Q16_ReadBuffer(0x00A0F8 + 0x8, Data, sizeof(gEeprom.KILL_CODE));
-    if (DTMF_ValidateCodes((char *)Data, sizeof(gEeprom.KILL_CODE))) {
-        memcpy(gEeprom.KILL_CODE, Data, sizeof(gEeprom.KILL_CODE));
-    } else {
-        strcpy(gEeprom.KILL_CODE, "ABCD9");
-    }
-
-    // 0EF0..0EF7
-    PY25Q16_ReadBuffer(0x00A0F8 + 0x10, Data, sizeof(gEeprom.REVIVE_CODE));
-    if (DTMF_ValidateCodes((char *)Data, sizeof(gEeprom.REVIVE_CODE))) {
-        memcpy(gEeprom.REVIVE_CODE, Data, sizeof(gEeprom.REVIVE_CODE));
-    } else {
-        strcpy(gEeprom.REVIVE_CODE, "9DCBA");
-    }
+    // 0x00A0F8
+#ifdef ENABLE_DTMF_CALLING
+    SETTINGS_DecodeDtmfCode(gEeprom.ANI_DTMF_ID, sizeof(gEeprom.ANI_DTMF_ID), Block + 0x0F8, "123");
+    SETTINGS_DecodeDtmfCode(gEeprom.KILL_CODE, sizeof(gEeprom.KILL_CODE), Block + 0x100, "ABCD9");
+    SETTINGS_DecodeDtmfCode(gEeprom.REVIVE_CODE, sizeof(gEeprom.REVIVE_CODE), Block + 0x108, "9DCBA");
 #endif
+    SETTINGS_DecodeDtmfCode(gEeprom.DTMF_UP_CODE, sizeof(gEeprom.DTMF_UP_CODE), Block + 0x110, "12345");
+    SETTINGS_DecodeDtmfCode(gEeprom.DTMF_DOWN_CODE, sizeof(gEeprom.DTMF_DOWN_CODE), Block + 0x120, "54321");
 
-    // 0EF8..0F07
-    PY25Q16_ReadBuffer(0x00A0F8 + 0x18, Data, sizeof(gEeprom.DTMF_UP_CODE));
-    if (DTMF_ValidateCodes((char *)Data, sizeof(gEeprom.DTMF_UP_CODE))) {
-        memcpy(gEeprom.DTMF_UP_CODE, Data, sizeof(gEeprom.DTMF_UP_CODE));
-    } else {
-        strcpy(gEeprom.DTMF_UP_CODE, "12345");
-    }
+    // 0x00A130
+    gEeprom.SCANLIST_PRIORITY_CH[0] = Block[0x131] | (Block[0x132] << 8);
+    gEeprom.SCANLIST_PRIORITY_CH[1] = Block[0x133] | (Block[0x134] << 8);
+    gEeprom.CHAN_1_CALL             = Block[0x135] | (Block[0x136] << 8);
 
-    // 0F08..0F17
-    PY25Q16_ReadBuffer(0x00A0F8 + 0x28, Data, sizeof(gEeprom.DTMF_DOWN_CODE));
-    if (DTMF_ValidateCodes((char *)Data, sizeof(gEeprom.DTMF_DOWN_CODE))) {
-        memcpy(gEeprom.DTMF_DOWN_CODE, Data, sizeof(gEeprom.DTMF_DOWN_CODE));
-    } else {
-        strcpy(gEeprom.DTMF_DOWN_CODE, "54321");
-    }
-
-    // 0F18..0F1F
-    PY25Q16_ReadBuffer(0x00A130, Data, 8);
-
-    gEeprom.SCAN_LIST_DEFAULT =
-            (((Data[0] & 0x7F) >= 1) && ((Data[0] & 0x7F) <= (MR_CHANNELS_LIST + 1)))
-                ? (Data[0] & 0x7F)
-                : 1;
-    gEeprom.SCAN_LIST_ENABLED = (Data[0] >> 7) & 0x01;
-
-    gEeprom.SCANLIST_PRIORITY_CH[0] =
-            (uint16_t)Data[1] |
-            ((uint16_t)Data[2] << 8);
-
-    gEeprom.SCANLIST_PRIORITY_CH[1] =
-            (uint16_t)Data[3] |
-            ((uint16_t)Data[4] << 8);
-
-    gEeprom.CHAN_1_CALL =
-            (uint16_t)Data[5] |
-            ((uint16_t)Data[6] << 8);
-
-    // 0F40..0F47
-    PY25Q16_ReadBuffer(0x00A150, Data, 8);
-    gSetting_F_LOCK            = (Data[0] < F_LOCK_LEN) ? Data[0] : F_LOCK_DEF;
-#ifndef ENABLE_FEAT_F4HWN
-    gSetting_350TX             = (Data[1] < 2) ? Data[1] : false;  // was true
-#endif
-#ifdef ENABLE_DTMF_CALLING
-    gSetting_KILLED            = (Data[2] < 2) ? Data[2] : false;
-#endif
-#ifndef ENABLE_FEAT_F4HWN
-    gSetting_200TX             = (Data[3] < 2) ? Data[3] : false;
-    gSetting_500TX             = (Data[4] < 2) ? Data[4] : false;
-#endif
-    gSetting_350EN             = (Data[5] < 2) ? Data[5] : true;
+    // 0x00A150
 #ifdef ENABLE_FEAT_F4HWN
     gSetting_ScrambleEnable    = false;
-#else
-    gSetting_ScrambleEnable    = (Data[6] < 2) ? Data[6] : true;
 #endif
 
-    //gSetting_TX_EN             = (Data[7] & (1u << 0)) ? true : false;
-    gSetting_live_DTMF_decoder = !!(Data[7] & (1u << 1));
-    gSetting_battery_text      = (((Data[7] >> 2) & 3u) <= 2) ? (Data[7] >> 2) & 3 : 2;
-    #ifdef ENABLE_AUDIO_BAR
-        gSetting_mic_bar       = !!(Data[7] & (1u << 4));
-    #endif
-    #ifndef ENABLE_FEAT_F4HWN
-        #ifdef ENABLE_AM_FIX
-            gSetting_AM_fix        = !!(Data[7] & (1u << 5));
-        #endif
-    #endif
-    gSetting_backlight_on_tx_rx = (Data[7] >> 6) & 3u;
-
     if (!gEeprom.VFO_OPEN)
     {
         gEeprom.ScreenChannel[0] = gEeprom.MrChannel[0];
         gEeprom.ScreenChannel[1] = gEeprom.MrChannel[1];
     }
 
+    // 0x00A158
+    #ifdef ENABLE_FEAT_F4HWN
+        #ifndef ENABLE_FEAT_F4HWN_INV
+            gSetting_set_inv = 0;
+        #endif
+        #ifndef ENABLE_FEAT_F4HWN_CTR
+            gSetting_set_ctr = 10;
+        #endif
+
+        // And set special session settings for actions
+        gSetting_set_ptt_session = gSetting_set_ptt;
+        gEeprom.KEY_LOCK_PTT = gSetting_set_lck;
+    #endif
+
     // 0D60..0E27
     /*
     PY25Q16_ReadBuffer(0x008000, gMR_ChannelAttributes, sizeof(gMR_ChannelAttributes));
@@ -424,7 +274,8 @@ gEeprom.FreqChannel[1]   = IS_FREQ_CHANNEL(Data16[5]) ? Data16[5] : (FREQ_CHANNE
     // Init attr cache
     MR_InitChannelAttributesCache();
 
-    // Load and check channel
+    // Load and check channel, only slots left erased are written; scan
+    // exclusions are RAM only and start out clear
     for (uint16_t i = 0; i < MR_CHANNELS_MAX + 7; i++) {
         ChannelAttributes_t *att = MR_GetChannelAttributes(i);
         
@@ -434,15 +285,11 @@ gEeprom.FreqChannel[1]   = IS_FREQ_CHANNEL(Data16[5]) ? Data16[5] : (FREQ_CHANNE
                 att->band = 0x7;
                 MR_SetChannelAttributes(i, att);  // ⭐ IMPORTANT: Sauvegarder!
             }
-            else {
-                att->exclude = 0;
-                MR_SetChannelAttributes(i, att);  // ⭐ IMPORTANT: Sauvegarder!
-            }
         }
     }
 
-    // 0F30..0F3F
-    PY25Q16_ReadBuffer(0x00A138, gCustomAesKey, sizeof(gCustomAesKey));
+    // 0x00A138
+    memcpy(gCustomAesKey, Block + 0x138, sizeof(gCustomAesKey));
     bHasCustomAesKey = false;
     #ifndef ENABLE_FEAT_F4HWN
         for (unsigned int i = 0; i < ARRAY_SIZE(gCustomAesKey); i++)
@@ -454,60 +301,6 @@ gEeprom.FreqChannel[1]   = IS_FREQ_CHANNEL(Data16[5]) ? Data16[5] : (FREQ_CHANNE
             }
         }
     #endif
-
-    #ifdef ENABLE_FEAT_F4HWN
-        // 1FF0..0x1FF7
-        // TODO: address TBD
-        PY25Q16_ReadBuffer(0x00A158, Data, 8);
-        gSetting_set_pwr = (((Data[7] & 0xF0) >> 4) < 7) ? ((Data[7] & 0xF0) >> 4) : 0;
-        gSetting_set_ptt = (((Data[7] & 0x0F)) < 2) ? ((Data[7] & 0x0F)) : 0;
-
-        gSetting_set_tot = (((Data[6] & 0xF0) >> 4) < 4) ? ((Data[6] & 0xF0) >> 4) : 0;
-        gSetting_set_eot = (((Data[6] & 0x0F)) < 4) ? ((Data[6] & 0x0F)) : 0;
-
-        /*
-        int tmp = ((Data[5] & 0xF0) >> 4);
-
-        gSetting_set_inv = (((tmp >> 0) & 0x01) < 2) ? ((tmp >> 0) & 0x01): 0;
-        gSetting_set_lck = (((tmp >> 1) & 0x01) < 2) ? ((tmp >> 1) & 0x01): 0;
-        gSetting_set_met = (((tmp >> 2) & 0x01) < 2) ? ((tmp >> 2) & 0x01): 0;
-        gSetting_set_gui = (((tmp >> 3) & 0x01) < 2) ? ((tmp >> 3) & 0x01): 0;
-        gSetting_set_ctr = (((Data[5] & 0x0F)) > 00 && ((Data[5] & 0x0F)) < 16) ? ((Data[5] & 0x0F)) : 10;
-
-        gSetting_set_tmr = ((Data[4] & 1) < 2) ? (Data[4] & 1): 0;
-        */
-
-        int tmp = (Data[5] & 0xF0) >> 4;
-
-#ifdef ENABLE_FEAT_F4HWN_INV
-        gSetting_set_inv = (tmp >> 0) & 0x01;
-#else
-        gSetting_set_inv = 0;
-#endif
-        gSetting_set_lck = (tmp >> 1) & 0x01;
-        gSetting_set_met = (tmp >> 2) & 0x01;
-        gSetting_set_gui = (tmp >> 3) & 0x01;
-
-#ifdef ENABLE_FEAT_F4HWN_CTR
-        int ctr_value = Data[5] & 0x0F;
-        gSetting_set_ctr = (ctr_value > 0 && ctr_value < 16) ? ctr_value : 10;
-#else
-        gSetting_set_ctr = 10;
-#endif
-
-        gSetting_set_tmr = Data[4] & 0x01;
-#ifdef ENABLE_FEAT_F4HWN_SLEEP
-        gSetting_set_off = (Data[4] >> 1) > 120 ? 60 : (Data[4] >> 1); 
-#endif
-
-        // Warning
-        // Be aware, Data[3] is use by Spectrum
-        // Warning
-
-        // And set special session settings for actions
-        gSetting_set_ptt_session = gSetting_set_ptt;
-        gEeprom.KEY_LOCK_PTT = gSetting_set_lck;
-    #endif
 }
 
 void SETTINGS_LoadCalibration(void)
@@ -752,277 +545,74 @@ void SETTINGS_SaveVfoIndicesFlush(void)
 
 void SETTINGS_SaveSettings(void)
 {
-    uint8_t *State;
-    uint8_t tmp = 0;
-    uint8_t SecBuf[0x50];
+    uint8_t Block[SETTINGS_BLOCK_SIZE];
 
-    // ----------------------
-    // 0e70 - 0e80
+    // bytes without a field keep whatever is stored
+    PY25Q16_ReadBuffer(SETTINGS_BLOCK_ADDR, Block, sizeof(Block));
 
-    memset(SecBuf, 0xff, 0x10);
+    const uint8_t Squelch = Block[0x001];
 
-    // 0x0E70
-    State = SecBuf;
-    #ifdef ENABLE_FEAT_F4HWN_AUDIO
-        State[0] = gSetting_set_audio;
-    #endif
-    if (gRequestSaveSquelch)
-    {
-        State[1] = gEeprom.SQUELCH_LEVEL;
-    }
-    State[2] = gEeprom.TX_TIMEOUT_TIMER;
-    #ifdef ENABLE_NOAA
-        State[3] = gEeprom.NOAA_AUTO_SCAN;
-    #else
-        State[3] = false;
-    #endif
-
-    #ifdef ENABLE_FEAT_F4HWN_RESCUE_OPS
-        State[4] =
-            (gEeprom.KEY_LOCK        ? 0x01 : 0) |
-            (gEeprom.MENU_LOCK       ? 0x02 : 0) |
-            ((gEeprom.SET_KEY & 0x0F) << 2)      |
-            (gEeprom.SET_NAV  ? 0x40 : 0);
-    #else
-        State[4] = gEeprom.KEY_LOCK;
-    #endif
+    SETTINGS_EncodeFields(Block);
 
-    #ifdef ENABLE_VOX
-        State[5] = gEeprom.VOX_SWITCH;
-        State[6] = gEeprom.VOX_LEVEL;
-    #else
-        State[5] = false;
-        State[6] = 0;
-    #endif
-    State[7] = gEeprom.MIC_SENSITIVITY;
-
-    // 0x0E78
-    State = SecBuf + 0x8;
-    State[0] = (gEeprom.BACKLIGHT_MIN << 4) + gEeprom.BACKLIGHT_MAX;
-    State[1] = gEeprom.CHANNEL_DISPLAY_MODE;
-    State[2] = gEeprom.CROSS_BAND_RX_TX;
-    State[3] = gEeprom.BATTERY_SAVE;
-    State[4] = gEeprom.DUAL_WATCH;
+    // 0x00A000
+    if (!gRequestSaveSquelch)
+        Block[0x001] = Squelch;
 
+    // 0x00A008
     #ifdef ENABLE_FEAT_F4HWN
         if(!gSaveRxMode)
         {
-            State[2] = gCB;
-            State[4] = gDW;
+            Block[0x00A] = gCB;
+            Block[0x00C] = gDW;
         }
         if(gBackLight)
         {
-            State[5] = gBacklightTimeOriginal;
+            Block[0x00D] = gBacklightTimeOriginal;
         }
-        else
-        {
-            State[5] = gEeprom.BACKLIGHT_TIME;
-        }
-    #else
-        State[5] = gEeprom.BACKLIGHT_TIME;
-    #endif
-
-    #ifdef ENABLE_FEAT_F4HWN_NARROWER
-        State[6] =
-            (gEeprom.TAIL_TONE_ELIMINATION & 0x01) |
-            ((gSetting_set_nfm & 0x01) << 1)
-        #ifdef ENABLE_FEAT_F4HWN_RESUME_STATE
-          | ((gEeprom.VFO_OPEN & 0x01) << 2)
-        #endif
-    ;
-    #else
-        State[6] = gEeprom.TAIL_TONE_ELIMINATION;
     #endif
 
     #ifdef ENABLE_FEAT_F4HWN_RESUME_STATE
-        State[7] = (gEeprom.CURRENT_STATE & 0x07) | ((gEeprom.SCAN_LIST_DEFAULT & 0x1F) << 3);
-    #else
-        State[7] = gEeprom.VFO_OPEN;
+        // the list to resume goes where CURRENT_LIST is read back from
+        Block[0x00F] = (gEeprom.CURRENT_STATE & 0x07) | ((gEeprom.SCAN_LIST_DEFAULT & 0x1F) << 3);
     #endif
 
-    PY25Q16_WriteBuffer(0x00A000, SecBuf, 0x10, false);
-
-    // -------------------------
-    //  0e90 - 0ee0
-
-    // memset(SecBuf, 0xff, 0x50);
-    PY25Q16_ReadBuffer(0x00A0A8, SecBuf, 0x50);
-
-    // 0x0E90
-    State = SecBuf;
-    State[0] = gEeprom.BEEP_CONTROL;
-    State[0] |= gEeprom.KEY_M_LONG_PRESS_ACTION << 1;
-    State[1] = gEeprom.KEY_1_SHORT_PRESS_ACTION;
-    State[2] = gEeprom.KEY_1_LONG_PRESS_ACTION;
-    State[3] = gEeprom.KEY_2_SHORT_PRESS_ACTION;
-    State[4] = gEeprom.KEY_2_LONG_PRESS_ACTION;
-    State[5] = gEeprom.SCAN_RESUME_MODE;
-    State[6] = gEeprom.AUTO_KEYPAD_LOCK;
-    State[7] = gEeprom.POWER_ON_DISPLAY_MODE;
-
-    // 0x0E98
+    // 0x00A0B0
     #ifdef ENABLE_PWRON_PASSWORD
-        State = SecBuf + 0x8;
-        State[0] = gEeprom.POWER_ON_PASSWORD;
+        memcpy(Block + 0x0B0, &gEeprom.POWER_ON_PASSWORD, 4);
     #endif
 
-    // 0x0EA0
-    State = SecBuf + 0x10;
-#ifdef ENABLE_VOICE
-    State[0] = gEeprom.VOICE_PROMPT;
-#endif
-#ifdef ENABLE_RSSI_BAR
-    State[1] = gEeprom.S0_LEVEL;
-    State[2] = gEeprom.S9_LEVEL;
-#endif
-
-    // 0x0EA8
-    State = SecBuf + 0x18;
-    #if defined(ENABLE_ALARM) || defined(ENABLE_TX1750)
-        State[0] = gEeprom.ALARM_MODE;
-    #else
-        State[0] = false;
-    #endif
-    State[1] = gEeprom.ROGER;
-    State[2] = gEeprom.REPEATER_TAIL_TONE_ELIMINATION;
-    State[3] = gEeprom.TX_VFO;
-    State[4] = gEeprom.BATTERY_TYPE;
-
-    // 0x0ED0
-    State = SecBuf + 0x40;
-    State[0] = gEeprom.DTMF_SIDE_TONE;
-#ifdef ENABLE_DTMF_CALLING
-    State[1] = gEeprom.DTMF_SEPARATE_CODE;
-    State[2] = gEeprom.DTMF_GROUP_CALL_CODE;
-    State[3] = gEeprom.DTMF_DECODE_RESPONSE;
-    State[4] = gEeprom.DTMF_auto_reset_time;
-#endif
-    State[5] = gEeprom.DTMF_PRELOAD_TIME / 10U;
-    State[6] = gEeprom.DTMF_FIRST_CODE_PERSIST_TIME / 10U;
-    State[7] = gEeprom.DTMF_HASH_CODE_PERSIST_TIME / 10U;
-
-    // 0x0ED8
-    State = SecBuf + 0x48;
-    State[0] = gEeprom.DTMF_CODE_PERSIST_TIME / 10U;
-    State[1] = gEeprom.DTMF_CODE_INTERVAL_TIME / 10U;
+    // 0x00A0E8
 #ifdef ENABLE_DTMF_CALLING
-    State[2] = gEeprom.PERMIT_REMOTE_KILL;
-#endif
-
-    PY25Q16_WriteBuffer(0x00A0A8, SecBuf, 0x50, false);
-
-    // -------------------------
-    // 0f18 - 0f20
-
-    memset(SecBuf, 0xff, 0x08);
-
-    // 0x0F18
-    State = SecBuf;
-
-    State[0] = (gEeprom.SCAN_LIST_DEFAULT & 0x7F)
-        | ((gEeprom.SCAN_LIST_ENABLED & 0x01) << 7);
-
-    State[1] = (uint8_t)(gEeprom.SCANLIST_PRIORITY_CH[0] & 0xFF);
-    State[2] = (uint8_t)(gEeprom.SCANLIST_PRIORITY_CH[0] >> 8);
-
-    State[3] = (uint8_t)(gEeprom.SCANLIST_PRIORITY_CH[1] & 0xFF);
-    State[4] = (uint8_t)(gEeprom.SCANLIST_PRIORITY_CH[1] >> 8);
-
-    State[5] = (uint8_t)(gEeprom.CHAN_1_CALL & 0xFF);
-    State[6] = (uint8_t)(gEeprom.CHAN_1_CALL >> 8);
-
-    PY25Q16_WriteBuffer(0x00A130, SecBuf, 0x08, false);
-
-    // ---------------------
-    // 0f40 - 0f48
-
-    memset(SecBuf, 0xff, 8);
-
-    // 0x0F40
-    State = SecBuf;
-    State[0]  = gSetting_F_LOCK;
-#ifndef ENABLE_FEAT_F4HWN
-    State[1]  = gSetting_350TX;
-#endif
-#ifdef ENABLE_DTMF_CALLING
-    State[2]  = gSetting_KILLED;
-#endif
-#ifndef ENABLE_FEAT_F4HWN
-    State[3]  = gSetting_200TX;
-    State[4]  = gSetting_500TX;
-#endif
-    State[5]  = gSetting_350EN;
+    Block[0x0E9] = gEeprom.DTMF_SEPARATE_CODE;
+    Block[0x0EA] = gEeprom.DTMF_GROUP_CALL_CODE;
+#endif
+    Block[0x0ED] = gEeprom.DTMF_PRELOAD_TIME / 10U;
+    Block[0x0EE] = gEeprom.DTMF_FIRST_CODE_PERSIST_TIME / 10U;
+    Block[0x0EF] = gEeprom.DTMF_HASH_CODE_PERSIST_TIME / 10U;
+    Block[0x0F0] = gEeprom.DTMF_CODE_PERSIST_TIME / 10U;
+    Block[0x0F1] = gEeprom.DTMF_CODE_INTERVAL_TIME / 10U;
+
+    // 0x00A130
+    Block[0x131] = (uint8_t)(gEeprom.SCANLIST_PRIORITY_CH[0] & 0xFF);
+    Block[0x132] = (uint8_t)(gEeprom.SCANLIST_PRIORITY_CH[0] >> 8);
+    Block[0x133] = (uint8_t)(gEeprom.SCANLIST_PRIORITY_CH[1] & 0xFF);
+    Block[0x134] = (uint8_t)(gEeprom.SCANLIST_PRIORITY_CH[1] >> 8);
+    Block[0x135] = (uint8_t)(gEeprom.CHAN_1_CALL & 0xFF);
+    Block[0x136] = (uint8_t)(gEeprom.CHAN_1_CALL >> 8);
+
+    // 0x00A150
 #ifdef ENABLE_FEAT_F4HWN
-    State[6]  = false;
-#else
-    State[6]  = gSetting_ScrambleEnable;
+    Block[0x156] = false;
 #endif
 
-    //if (!gSetting_TX_EN)             State[7] &= ~(1u << 0);
-    if (!gSetting_live_DTMF_decoder) State[7] &= ~(1u << 1);
-    State[7] = (State[7] & ~(3u << 2)) | ((gSetting_battery_text & 3u) << 2);
-    #ifdef ENABLE_AUDIO_BAR
-        if (!gSetting_mic_bar)           State[7] &= ~(1u << 4);
-    #endif
-    #ifndef ENABLE_FEAT_F4HWN
-        #ifdef ENABLE_AM_FIX
-            if (!gSetting_AM_fix)            State[7] &= ~(1u << 5);
-        #endif
-    #endif
-    State[7] = (State[7] & ~(3u << 6)) | ((gSetting_backlight_on_tx_rx & 3u) << 6);
-
-    PY25Q16_WriteBuffer(0x00A150, SecBuf, 8, false);
-
-    // ------------------
-
+    // 0x00A158
 #ifdef ENABLE_FEAT_F4HWN
-    // 0x1FF0
-    State = SecBuf;
-    // TODO: TBD
-    PY25Q16_ReadBuffer(0x00A158, State, 8);
-
-    //memset(State, 0xFF, sizeof(State));
-
-    /*
-    tmp = 0;
-
-    if(gSetting_set_tmr == 1)
-        tmp = tmp | (1 << 0);
-
-    State[4] = tmp;
-
-    tmp = 0;
-
-    if(gSetting_set_inv == 1)
-        tmp = tmp | (1 << 0);
-    if (gSetting_set_lck == 1)
-        tmp = tmp | (1 << 1);
-    if (gSetting_set_met == 1)
-        tmp = tmp | (1 << 2);
-    if (gSetting_set_gui == 1)
-        tmp = tmp | (1 << 3);
-    */
-
-#ifdef ENABLE_FEAT_F4HWN_SLEEP 
-    State[4] = (gSetting_set_off << 1) | (gSetting_set_tmr & 0x01);
-#else
-    State[4] = gSetting_set_tmr ? (1 << 0) : 0;
-#endif
-
-    tmp =   (gSetting_set_inv << 0) |
-            (gSetting_set_lck << 1) |
-            (gSetting_set_met << 2) |
-            (gSetting_set_gui << 3);
-
-    State[5] = ((tmp << 4) | (gSetting_set_ctr & 0x0F));
-    State[6] = ((gSetting_set_tot << 4) | (gSetting_set_eot & 0x0F));
-    State[7] = ((gSetting_set_pwr << 4) | (gSetting_set_ptt & 0x0F));
-
     gEeprom.KEY_LOCK_PTT = gSetting_set_lck;
-
-    PY25Q16_WriteBuffer(0x00A158, SecBuf, 8, false);
 #endif
 
+    // unchanged bytes are skipped by the flash driver
+    PY25Q16_WriteBuffer(SETTINGS_BLOCK_ADDR, Block, sizeof(Block), false);
+
 #ifdef ENABLE_FEAT_F4HWN_VOL
     SETTINGS_WriteCurrentVol();
 #endif
@@ -1151,10 +741,7 @@ void SETTINGS_UpdateChannel(uint16_t channel, const VFO_Info_t *pVFO, bool keep,
 #endif
         if(save)
         {
-            uint16_t buf[MR_CHANNELS_MAX + 24];
-            PY25Q16_ReadBuffer(0x008000, buf, sizeof(buf));
-            buf[channel] = state.__val;
-            PY25Q16_WriteBuffer(0x008000, buf, sizeof(buf), false);
+            PY25Q16_WriteBuffer(0x008000 + (channel * 2), &state, 2, false);
         }
 
         MR_SetChannelAttributes(channel, &att);
@@ -218,6 +218,12 @@ typedef struct {
     uint8_t               SCAN_LIST_DEFAULT;
     bool                  SCAN_LIST_ENABLED;
     uint16_t              SCANLIST_PRIORITY_CH[6];
+#ifdef ENABLE_PRIORITY_WATCH
+    uint8_t               PRIORITY_WATCH;       // look-back interval in s, 0 = off
+#endif
+#ifdef ENABLE_SQUELCH_CAL
+    uint8_t               SQUELCH_CAL[7];       // RSSI noise ceiling per band, 0xFF = not measured
+#endif
 //#ifdef ENABLE_FEAT_F4HWN_RESUME_STATE // Fix me !!! What the hell is this?
     uint8_t               CURRENT_STATE;
     uint8_t               CURRENT_LIST;
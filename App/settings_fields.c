@@ -0,0 +1,234 @@
+#ifdef ENABLE_SQUELCH_CAL
+    #include "app/sqlcal.h"
+#endif
+#include "misc.h"
+#include "settings.h"
+#include "settings_fields.h"
+
+// only the variable sizes SETTINGS_DecodeFields/EncodeFields handle
+#define FIELD_SIZE(Var) \
+    (sizeof(Var) + 0 * sizeof(struct { \
+        _Static_assert(sizeof(Var) == 1 || sizeof(Var) == 2 || sizeof(Var) == 4, "unsupported settings field size"); \
+        char Dummy; }))
+
+#define FIELD(Offset, Shift, Width, Min, Max, Default, Var) \
+    { Offset, Shift, Width, Min, Max, Default, FIELD_SIZE(Var), &(Var) }
+#define BYTE(Offset, Min, Max, Default, Var) \
+    FIELD(Offset, 0, 8, Min, Max, Default, Var)
+#define FLAG(Offset, Bit, Default, Var) \
+    FIELD(Offset, Bit, 1, 0, 1, Default, Var)
+
+const SettingsField_t SETTINGS_FIELDS[] =
+{
+    // 0x00A000
+#ifdef ENABLE_FEAT_F4HWN_AUDIO
+    BYTE(0x000, 0, 4, 0, gSetting_set_audio),
+#endif
+    BYTE(0x001, 0, 9, 1, gEeprom.SQUELCH_LEVEL),
+    BYTE(0x002, 5, 179, 11, gEeprom.TX_TIMEOUT_TIMER),
+#ifdef ENABLE_NOAA
+    BYTE(0x003, 0, 1, false, gEeprom.NOAA_AUTO_SCAN),
+#endif
+#ifdef ENABLE_FEAT_F4HWN_RESCUE_OPS
+    FLAG(0x004, 0, false, gEeprom.KEY_LOCK),
+    FLAG(0x004, 1, false, gEeprom.MENU_LOCK),
+    FIELD(0x004, 2, 4, 0, 4, 0, gEeprom.SET_KEY),
+    FLAG(0x004, 6, false, gEeprom.SET_NAV),
+#else
+    BYTE(0x004, 0, 1, false, gEeprom.KEY_LOCK),
+#endif
+#ifdef ENABLE_VOX
+    BYTE(0x005, 0, 1, false, gEeprom.VOX_SWITCH),
+    BYTE(0x006, 0, 9, 1, gEeprom.VOX_LEVEL),
+#endif
+    BYTE(0x007, 0, 8, 4, gEeprom.MIC_SENSITIVITY),
+
+    // 0x00A008
+    FIELD(0x008, 0, 4, 0, 10, 10, gEeprom.BACKLIGHT_MAX),
+    FIELD(0x008, 4, 4, 0, 15, 0, gEeprom.BACKLIGHT_MIN),
+    BYTE(0x009, 0, 3, MDF_FREQUENCY, gEeprom.CHANNEL_DISPLAY_MODE), // 4 instead of 3 - extra display mode
+    BYTE(0x00A, 0, 2, CROSS_BAND_OFF, gEeprom.CROSS_BAND_RX_TX),
+    BYTE(0x00B, 0, 5, 4, gEeprom.BATTERY_SAVE),
+    BYTE(0x00C, 0, 2, DUAL_WATCH_CHAN_A, gEeprom.DUAL_WATCH),
+    BYTE(0x00D, 0, 61, 12, gEeprom.BACKLIGHT_TIME),
+#ifdef ENABLE_FEAT_F4HWN_NARROWER
+    FLAG(0x00E, 0, false, gEeprom.TAIL_TONE_ELIMINATION),
+    FLAG(0x00E, 1, false, gSetting_set_nfm),
+    #ifdef ENABLE_FEAT_F4HWN_RESUME_STATE
+        FLAG(0x00E, 2, true, gEeprom.VFO_OPEN),
+    #endif
+#else
+    BYTE(0x00E, 0, 1, false, gEeprom.TAIL_TONE_ELIMINATION),
+#endif
+#ifdef ENABLE_FEAT_F4HWN_RESUME_STATE
+    FIELD(0x00F, 0, 3, 0, 7, 0, gEeprom.CURRENT_STATE),
+    FIELD(0x00F, 3, 5, 0, 31, 0, gEeprom.CURRENT_LIST),
+#else
+    BYTE(0x00F, 0, 1, true, gEeprom.VFO_OPEN),
+#endif
+
+    // 0x00A0A8
+    FLAG(0x0A8, 0, false, gEeprom.BEEP_CONTROL),
+    FIELD(0x0A8, 1, 7, 0, ACTION_OPT_LEN - 1, ACTION_OPT_NONE, gEeprom.KEY_M_LONG_PRESS_ACTION),
+    BYTE(0x0A9, 0, ACTION_OPT_LEN - 1, ACTION_OPT_MONITOR, gEeprom.KEY_1_SHORT_PRESS_ACTION),
+    BYTE(0x0AA, 0, ACTION_OPT_LEN - 1, ACTION_OPT_NONE, gEeprom.KEY_1_LONG_PRESS_ACTION),
+    BYTE(0x0AB, 0, ACTION_OPT_LEN - 1, ACTION_OPT_SCAN, gEeprom.KEY_2_SHORT_PRESS_ACTION),
+    BYTE(0x0AC, 0, ACTION_OPT_LEN - 1, ACTION_OPT_NONE, gEeprom.KEY_2_LONG_PRESS_ACTION),
+    BYTE(0x0AD, 0, 104, 14, gEeprom.SCAN_RESUME_MODE),
+    BYTE(0x0AE, 0, 40, 0, gEeprom.AUTO_KEYPAD_LOCK),
+#ifdef ENABLE_FEAT_F4HWN
+    BYTE(0x0AF, 0, 5, POWER_ON_DISPLAY_MODE_VOLTAGE, gEeprom.POWER_ON_DISPLAY_MODE),
+#else
+    BYTE(0x0AF, 0, 3, POWER_ON_DISPLAY_MODE_VOLTAGE, gEeprom.POWER_ON_DISPLAY_MODE),
+#endif
+
+    // 0x00A0B8
+#ifdef ENABLE_VOICE
+    BYTE(0x0B8, 0, 2, VOICE_PROMPT_ENGLISH, gEeprom.VOICE_PROMPT),
+#endif
+
+    // 0x00A0C0
+#ifdef ENABLE_ALARM
+    BYTE(0x0C0, 0, 1, true, gEeprom.ALARM_MODE),
+#endif
+    BYTE(0x0C1, 0, 2, ROGER_MODE_OFF, gEeprom.ROGER),
+    BYTE(0x0C2, 0, 10, 0, gEeprom.REPEATER_TAIL_TONE_ELIMINATION),
+    BYTE(0x0C3, 0, 1, 0, gEeprom.TX_VFO),
+    BYTE(0x0C4, 0, BATTERY_TYPE_UNKNOWN - 1, BATTERY_TYPE_1600_MAH, gEeprom.BATTERY_TYPE),
+#ifdef ENABLE_SQUELCH_CAL
+    // noise ceilings of the last two bands, see 0x00A0F3
+    BYTE(0x0C5, SQLCAL_CEILING_MIN, SQLCAL_CEILING_MAX, SQLCAL_NONE, gEeprom.SQUELCH_CAL[5]),
+    BYTE(0x0C6, SQLCAL_CEILING_MIN, SQLCAL_CEILING_MAX, SQLCAL_NONE, gEeprom.SQUELCH_CAL[6]),
+#endif
+
+    // 0x00A0E8
+    BYTE(0x0E8, 0, 1, true, gEeprom.DTMF_SIDE_TONE),
+#ifdef ENABLE_DTMF_CALLING
+    BYTE(0x0EB, 0, 3, 0, gEeprom.DTMF_DECODE_RESPONSE),
+    BYTE(0x0EC, 0, 255, 10, gEeprom.DTMF_auto_reset_time),
+    BYTE(0x0F2, 0, 1, true, gEeprom.PERMIT_REMOTE_KILL),
+#endif
+
+    // 0x00A0F3, one noise ceiling per band. The squelch calibration lives in
+    // the two gaps the stock layout leaves unused (0x0F3-0x0F7 after the
+    // DTMF settings, 0x0C5-0x0C7 after the battery type); nothing else in
+    // this firmware reads or writes them
+#ifdef ENABLE_SQUELCH_CAL
+    BYTE(0x0F3, SQLCAL_CEILING_MIN, SQLCAL_CEILING_MAX, SQLCAL_NONE, gEeprom.SQUELCH_CAL[0]),
+    BYTE(0x0F4, SQLCAL_CEILING_MIN, SQLCAL_CEILING_MAX, SQLCAL_NONE, gEeprom.SQUELCH_CAL[1]),
+    BYTE(0x0F5, SQLCAL_CEILING_MIN, SQLCAL_CEILING_MAX, SQLCAL_NONE, gEeprom.SQUELCH_CAL[2]),
+    BYTE(0x0F6, SQLCAL_CEILING_MIN, SQLCAL_CEILING_MAX, SQLCAL_NONE, gEeprom.SQUELCH_CAL[3]),
+    BYTE(0x0F7, SQLCAL_CEILING_MIN, SQLCAL_CEILING_MAX, SQLCAL_NONE, gEeprom.SQUELCH_CAL[4]),
+#endif
+
+    // 0x00A130
+    FIELD(0x130, 0, 7, 1, MR_CHANNELS_LIST + 1, 1, gEeprom.SCAN_LIST_DEFAULT),
+    FLAG(0x130, 7, false, gEeprom.SCAN_LIST_ENABLED),
+#ifdef ENABLE_PRIORITY_WATCH
+    BYTE(0x137, 0, 10, 0, gEeprom.PRIORITY_WATCH),
+#endif
+
+    // 0x00A150
+    BYTE(0x150, 0, F_LOCK_LEN - 1, F_LOCK_DEF, gSetting_F_LOCK),
+#ifndef ENABLE_FEAT_F4HWN
+    BYTE(0x151, 0, 1, false, gSetting_350TX),  // was true
+#endif
+#ifdef ENABLE_DTMF_CALLING
+    BYTE(0x152, 0, 1, false, gSetting_KILLED),
+#endif
+#ifndef ENABLE_FEAT_F4HWN
+    BYTE(0x153, 0, 1, false, gSetting_200TX),
+    BYTE(0x154, 0, 1, false, gSetting_500TX),
+#endif
+    BYTE(0x155, 0, 1, true, gSetting_350EN),
+#ifndef ENABLE_FEAT_F4HWN
+    BYTE(0x156, 0, 1, true, gSetting_ScrambleEnable),
+#endif
+    FLAG(0x157, 1, false, gSetting_live_DTMF_decoder),
+    FIELD(0x157, 2, 2, 0, 2, 2, gSetting_battery_text),
+#ifdef ENABLE_AUDIO_BAR
+    FLAG(0x157, 4, false, gSetting_mic_bar),
+#endif
+#if !defined(ENABLE_FEAT_F4HWN) && defined(ENABLE_AM_FIX)
+    FLAG(0x157, 5, false, gSetting_AM_fix),
+#endif
+    FIELD(0x157, 6, 2, 0, 3, 0, gSetting_backlight_on_tx_rx),
+
+    // 0x00A158, byte 3 belongs to the spectrum
+#ifdef ENABLE_FEAT_F4HWN
+    FLAG(0x15C, 0, 0, gSetting_set_tmr),
+    #ifdef ENABLE_FEAT_F4HWN_SLEEP
+        FIELD(0x15C, 1, 7, 0, 120, 60, gSetting_set_off),
+    #endif
+    #ifdef ENABLE_FEAT_F4HWN_CTR
+        FIELD(0x15D, 0, 4, 1, 15, 10, gSetting_set_ctr),
+    #endif
+    #ifdef ENABLE_FEAT_F4HWN_INV
+        FLAG(0x15D, 4, 0, gSetting_set_inv),
+    #endif
+    FLAG(0x15D, 5, 0, gSetting_set_lck),
+    FLAG(0x15D, 6, 0, gSetting_set_met),
+    FLAG(0x15D, 7, 0, gSetting_set_gui),
+    FIELD(0x15E, 0, 4, 0, 3, 0, gSetting_set_eot),
+    FIELD(0x15E, 4, 4, 0, 3, 0, gSetting_set_tot),
+    FIELD(0x15F, 0, 4, 0, 1, 0, gSetting_set_ptt),
+    FIELD(0x15F, 4, 4, 0, 6, 0, gSetting_set_pwr),
+#endif
+};
+
+const unsigned int SETTINGS_FIELD_COUNT = ARRAY_SIZE(SETTINGS_FIELDS);
+
+#ifdef ENABLE_SQUELCH_CAL
+_Static_assert(ARRAY_SIZE(gEeprom.SQUELCH_CAL) == 7, "one SQUELCH_CAL entry per band");
+#endif
+
+void SETTINGS_DecodeFields(const uint8_t *pBlock)
+{
+    for (unsigned int i = 0; i < ARRAY_SIZE(SETTINGS_FIELDS); i++)
+    {
+        const SettingsField_t *pField = &SETTINGS_FIELDS[i];
+        const uint8_t          Mask   = (1u << pField->Width) - 1;
+        uint8_t                Value  = (pBlock[pField->Offset] >> pField->Shift) & Mask;
+
+        if (Value < pField->Min || Value > pField->Max)
+            Value = pField->Default;
+
+        switch (pField->Size)
+        {
+            case 1:
+                *(uint8_t *)pField->pValue = Value;
+                break;
+            case 2:
+                *(uint16_t *)pField->pValue = Value;
+                break;
+            default:
+                *(uint32_t *)pField->pValue = Value;
+                break;
+        }
+    }
+}
+
+void SETTINGS_EncodeFields(uint8_t *pBlock)
+{
+    for (unsigned int i = 0; i < ARRAY_SIZE(SETTINGS_FIELDS); i++)
+    {
+        const SettingsField_t *pField = &SETTINGS_FIELDS[i];
+        const uint8_t          Mask   = (1u << pField->Width) - 1;
+        uint8_t                Value;
+
+        switch (pField->Size)
+        {
+            case 1:
+                Value = *(const uint8_t *)pField->pValue;
+                break;
+            case 2:
+                Value = *(const uint16_t *)pField->pValue;
+                break;
+            default:
+                Value = *(const uint32_t *)pField->pValue;
+                break;
+        }
+
+        pBlock[pField->Offset] = (pBlock[pField->Offset] & ~(Mask << pField->Shift)) | ((Value & Mask) << pField->Shift);
+    }
+}
@@ -0,0 +1,33 @@
+#ifndef SETTINGS_FIELDS_H
+#define SETTINGS_FIELDS_H
+
+#include <stdint.h>
+
+// Settings block 0x00A000..0x00A16F (ex EEPROM 0x0E70..), read and written
+// as a whole. Plain byte/bit fields are described by SETTINGS_FIELDS and
+// shared by SETTINGS_InitEEPROM (decode) and SETTINGS_SaveSettings (encode);
+// anything with a scale, a multi-byte value or a dependency on another field
+// is still packed by hand next to the table calls.
+#define SETTINGS_BLOCK_ADDR 0x00A000
+#define SETTINGS_BLOCK_SIZE 0x170
+
+typedef struct
+{
+    uint16_t Offset;  // from SETTINGS_BLOCK_ADDR
+    uint8_t  Shift;   // bits Shift .. Shift + Width - 1 of the byte
+    uint8_t  Width;
+    uint8_t  Min;     // stored values outside Min..Max load as Default
+    uint8_t  Max;
+    uint8_t  Default;
+    uint8_t  Size;    // of the variable: 1 (uint8_t, bool, char), 2 or 4 (enum)
+    void    *pValue;
+} SettingsField_t;
+
+// kept apart from settings.c so that the layout can be checked on a host
+extern const SettingsField_t SETTINGS_FIELDS[];
+extern const unsigned int    SETTINGS_FIELD_COUNT;
+
+void SETTINGS_DecodeFields(const uint8_t *pBlock);
+void SETTINGS_EncodeFields(uint8_t *pBlock);
+
+#endif
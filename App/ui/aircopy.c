@@ -27,14 +27,6 @@
 #include "ui/helper.h"
 #include "ui/inputbox.h"
 
-static void set_bit(uint8_t* array, int bit_index) {
-    array[bit_index / 8] |= (1 << (bit_index % 8));
-}
-
-static int get_bit(uint8_t* array, int bit_index) {
-    return (array[bit_index / 8] >> (bit_index % 8)) & 1;
-}
-
 void UI_DisplayAircopy(void)
 {
     char String[16] = { 0 };
@@ -73,7 +65,7 @@ void UI_DisplayAircopy(void)
     // Get the current map and calculate percentage based on its total blocks
     const AIRCOPY_TransferMap_t *currentMap = AIRCOPY_GetCurrentMap();
 
-    uint16_t doneBlocks = gAirCopyBlockNumber + gErrorsDuringAirCopy;
+    uint16_t doneBlocks = gAirCopyBlockNumber;
 
     if (doneBlocks > currentMap->total_blocks)
         doneBlocks = currentMap->total_blocks;
@@ -123,35 +115,17 @@ void UI_DisplayAircopy(void)
 
     if (doneBlocks > 0)
     {
-        // Track CRC errors per real block index
-        if (gErrorsDuringAirCopy != lErrorsDuringAirCopy)
-        {
-            // Mark the last processed block as faulty
-            set_bit(crc, doneBlocks - 1);
-            lErrorsDuringAirCopy = gErrorsDuringAirCopy;
-        }
-
-        const AIRCOPY_TransferMap_t *currentMap = AIRCOPY_GetCurrentMap();
-
-        uint16_t total = currentMap->total_blocks;
-        uint16_t done  = gAirCopyBlockNumber + gErrorsDuringAirCopy;
-        
-        if (done > total) done = total;
+        const uint16_t total = currentMap->total_blocks;
 
         for (uint8_t col = 0; col < AIRCOPY_BAR_WIDTH; col++)
         {
             /* Map column [0..BAR_WIDTH-1] to block [0..total-1] */
             uint16_t b = (uint16_t)((col * (uint32_t)total) / AIRCOPY_BAR_WIDTH);
 
-            bool processed = (b < done);
-            bool error     = processed && get_bit(crc, b);
-
-            if (!processed)
-                gFrameBuffer[4][col + 4] = 0x81;   // not yet processed
-            else if (error)
-                gFrameBuffer[4][col + 4] = 0x81;   // error gap (intentional hole)
-            else
+            if (AIRCOPY_IsBlockDone(b))
                 gFrameBuffer[4][col + 4] = 0xBD;   // ok filled
+            else
+                gFrameBuffer[4][col + 4] = 0x81;   // missing, not yet sent or lost
         }
 
     }
@@ -21,6 +21,7 @@
 #include "ARMCM0.h"
 #include "app/uart.h"
 #include "audio.h"
+#include "driver/bk4819.h"
 #include "driver/keyboard.h"
 #include "driver/st7565.h"
 #include "misc.h"
@@ -64,6 +65,8 @@ void UI_DisplayLock(void)
 
         gNextTimeslice = false;
 
+        BK4819_ToneSeq_TimeSlice10ms();     // key beeps
+
         Key = KEYBOARD_Poll();
 
         if (gKeyReading0 == Key)
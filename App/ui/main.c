@@ -30,6 +30,7 @@
 #include "external/printf/printf.h"
 #include "functions.h"
 #include "helper/battery.h"
+#include "helper/rssi.h"
 #include "misc.h"
 #include "radio.h"
 #include "settings.h"
@@ -780,11 +781,7 @@ static void DualVfoDrawBottomSMeterAndBattery(void)
 
         if (rxActive)
         {
-            rssi_dBm = BK4819_GetRSSI_dBm() + dBmCorrTable[gRxVfo->Band];
-#ifdef ENABLE_AM_FIX
-            if (gSetting_AM_fix && gRxVfo->Modulation == MODULATION_AM)
-                rssi_dBm = (int16_t)(rssi_dBm + AM_fix_get_gain_diff());
-#endif
+            rssi_dBm = RSSI_GetSmoothed_dBm();
             const int16_t s9_dBm = -93;
             const int16_t s0_dBm = -141;
             /* 横条右缘对齐 9 条竖线刻度；最强（>S9）拉满条宽 */
@@ -1312,12 +1309,7 @@ void DisplayRSSIBar(const bool now)
         memset(p_line, 0, LCD_WIDTH);
 
 #ifdef ENABLE_FEAT_F4HWN
-    int16_t rssi_dBm =
-        BK4819_GetRSSI_dBm()
-#ifdef ENABLE_AM_FIX
-        + ((gSetting_AM_fix && gRxVfo->Modulation == MODULATION_AM) ? AM_fix_get_gain_diff() : 0)
-#endif
-        + dBmCorrTable[gRxVfo->Band];
+    int16_t rssi_dBm = RSSI_GetSmoothed_dBm();
 
     // S9 = -93 dBm, S0 = -141 dBm (IARU standard)
     const int16_t s9_dBm = -93;
@@ -1349,12 +1341,7 @@ void DisplayRSSIBar(const bool now)
     }
 #else
     const int16_t s0_dBm   = -gEeprom.S0_LEVEL;                  // S0 .. base level
-    const int16_t rssi_dBm =
-        BK4819_GetRSSI_dBm()
-#ifdef ENABLE_AM_FIX
-        + ((gSetting_AM_fix && gRxVfo->Modulation == MODULATION_AM) ? AM_fix_get_gain_diff() : 0)
-#endif
-        + dBmCorrTable[gRxVfo->Band];
+    const int16_t rssi_dBm = RSSI_GetSmoothed_dBm();
 
     int s0_9 = gEeprom.S0_LEVEL - gEeprom.S9_LEVEL;
     const uint8_t s_level = MIN(MAX((int32_t)(rssi_dBm - s0_dBm)*100 / (s0_9*100/9), 0), 9); // S0 - S9
@@ -1411,7 +1398,7 @@ void DisplayRSSIBar(const bool now)
             gVFO_RSSI_bar_level[gEeprom.RX_VFO] = 6u;
     }
 #else
-    int16_t rssi = BK4819_GetRSSI();
+    int16_t rssi = RSSI_GetRaw();
     uint8_t Level;
 
     if (rssi >= gEEPROM_RSSI_CALIB[gRxVfo->Band][3]) {
@@ -1473,7 +1460,7 @@ void UI_MAIN_PrintAGC(bool now)
     int8_t pgaTab[] = {-33, -27, -21, -15, -9, -6, -3, 0};
     int16_t agcGain = lnaShortTab[agcGainReg.lnaS] + lnaTab[agcGainReg.lna] + mixerTab[agcGainReg.mixer] + pgaTab[agcGainReg.pga];
 
-    sprintf(buf, "%d%2d %2d %2d %3d", reg7e.agcEnab, reg7e.gainIdx, -agcGain, reg7e.agcSigStrength, BK4819_GetRSSI());
+    sprintf(buf, "%d%2d %2d %2d %3d", reg7e.agcEnab, reg7e.gainIdx, -agcGain, reg7e.agcSigStrength, RSSI_GetRaw());
     UI_PrintStringSmallNormal(buf, 2, 0, 3);
     if(now)
         ST7565_BlitLine(3);
@@ -1627,12 +1614,7 @@ void UI_DisplayMain(void)
             const int rightEdge = (int)(LCD_WIDTH - 1);
             if (FUNCTION_IsRx()) {
                 char dBmStr[12];
-                int16_t rssi_dBm =
-                    BK4819_GetRSSI_dBm()
-#ifdef ENABLE_AM_FIX
-                    + ((gSetting_AM_fix && gRxVfo->Modulation == MODULATION_AM) ? AM_fix_get_gain_diff() : 0)
-#endif
-                    + dBmCorrTable[gRxVfo->Band];
+                int16_t rssi_dBm = RSSI_GetSmoothed_dBm();
                 rssi_dBm = -rssi_dBm;
                 if (rssi_dBm > 141) rssi_dBm = 141;
                 if (rssi_dBm < 53) rssi_dBm = 53;
@@ -2138,10 +2120,7 @@ void UI_DisplayMain(void)
                     if(gEeprom.MENU_LOCK == false) {
                 #endif
 
-                const ChannelAttributes_t* att = MR_GetChannelAttributes(gEeprom.ScreenChannel[vfo_num]);
-
-
-                if(att->exclude == false)
+                if(!MR_IsChannelExcluded(gEeprom.ScreenChannel[vfo_num]))
                 {
                     // show the scan list assigment symbols
                     const ChannelAttributes_t* att = MR_GetChannelAttributes(gEeprom.ScreenChannel[vfo_num]);
@@ -72,6 +72,9 @@ const t_menu_item MenuList[] =
     {"ScPri",        MENU_S_PRI        },
     {"PriCh1",       MENU_S_PRI_CH_1   },
     {"PriCh2",       MENU_S_PRI_CH_2   },
+#ifdef ENABLE_PRIORITY_WATCH
+    {"PriWch",       MENU_S_PRI_WATCH  },
+#endif
     {"ScnRev",      MENU_SC_REV        },
 #ifndef ENABLE_FEAT_F4HWN
     #ifdef ENABLE_NOAA
@@ -137,6 +140,9 @@ const t_menu_item MenuList[] =
 #endif
     {"RxMode",      MENU_TDR           },
     {"Sql",         MENU_SQL           },
+#ifdef ENABLE_SQUELCH_CAL
+    {"SqlCal",      MENU_SQL_CAL       },
+#endif
 #ifdef ENABLE_FEAT_F4HWN
     {"SetPwr",      MENU_SET_PWR       },
     {"SetPTT",      MENU_SET_PTT       },
@@ -306,6 +312,14 @@ const char gSubMenu_RESET[][4] =
     "ALL"
 };
 
+#ifdef ENABLE_SQUELCH_CAL
+const char gSubMenu_SQL_CAL[][6] =
+{
+    "CLEAR",
+    "RUN"
+};
+#endif
+
 const char * const gSubMenu_F_LOCK[] =
 {
     "DEFAULT+\n137-174\n400-470",
@@ -967,6 +981,12 @@ void UI_DisplayMenu(void)
             sprintf(String, gSubMenuSelection == 0 ? gSubMenu_OFF_ON[0] : "%u*100ms", gSubMenuSelection);
             break;
 
+#ifdef ENABLE_PRIORITY_WATCH
+        case MENU_S_PRI_WATCH:
+            sprintf(String, gSubMenuSelection == 0 ? gSubMenu_OFF_ON[0] : "every\n%us", gSubMenuSelection);
+            break;
+#endif
+
         case MENU_LIST_CH:
             if (gSubMenuSelection == MR_CHANNELS_LIST + 1)
                 strcpy(String, "ALL");
@@ -1071,6 +1091,12 @@ void UI_DisplayMenu(void)
             strcpy(String, gSubMenu_RESET[gSubMenuSelection]);
             break;
 
+#ifdef ENABLE_SQUELCH_CAL
+        case MENU_SQL_CAL:
+            strcpy(String, gSubMenu_SQL_CAL[gSubMenuSelection]);
+            break;
+#endif
+
         case MENU_F_LOCK:
 #ifdef ENABLE_FEAT_F4HWN
             if(!gIsInSubMenu && gUnlockAllTxConfCnt>0 && gUnlockAllTxConfCnt<3)
@@ -31,6 +31,9 @@ typedef struct {
 enum
 {
     MENU_SQL = 0,
+#ifdef ENABLE_SQUELCH_CAL
+    MENU_SQL_CAL,
+#endif
     MENU_STEP,
     MENU_TXP,
     MENU_R_DCS,
@@ -76,6 +79,9 @@ enum
     MENU_S_PRI,
     MENU_S_PRI_CH_1,
     MENU_S_PRI_CH_2,    
+#ifdef ENABLE_PRIORITY_WATCH
+    MENU_S_PRI_WATCH,
+#endif
 #ifdef ENABLE_ALARM
     MENU_AL_MOD,
 #endif
@@ -210,6 +216,9 @@ extern const char* const gSubMenu_PTT_ID[5];
 #endif
 extern const char        gSubMenu_ROGER[3][6];
 extern const char        gSubMenu_RESET[2][4];
+#ifdef ENABLE_SQUELCH_CAL
+extern const char        gSubMenu_SQL_CAL[2][6];
+#endif
 extern const char* const gSubMenu_F_LOCK[F_LOCK_LEN];
 extern const char        gSubMenu_RX_TX[4][6];
 extern const char        gSubMenu_BAT_TXT[3][8];
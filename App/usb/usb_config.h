@@ -47,11 +47,11 @@
 #endif
 
 #ifndef CONFIG_USBDEV_MSC_MANUFACTURER_STRING
-#define CONFIG_USBDEV_MSC_MANUFACTURER_STRING ""
+#define CONFIG_USBDEV_MSC_MANUFACTURER_STRING "PUYA"
 #endif
 
 #ifndef CONFIG_USBDEV_MSC_PRODUCT_STRING
-#define CONFIG_USBDEV_MSC_PRODUCT_STRING ""
+#define CONFIG_USBDEV_MSC_PRODUCT_STRING "UV-K5 CODEPLUG"
 #endif
 
 #ifndef CONFIG_USBDEV_MSC_VERSION_STRING
@@ -80,12 +80,25 @@
 
 
 /* ================ USB Device Port Configuration ================*/
+#include <stdbool.h>
 #include "py32f0xx.h"
 
 #define USBD_IRQn       USB_IRQn
 
 #define USBD_IRQHandler USB_IRQHandler
 
+// ACM functions exposed by the composite device. CPS programming always owns
+// the first port so existing tools keep working; the optional second port
+// carries the screenshot stream and debug log so neither has to wait for
+// (or lock out) a programming session.
+#define CDC_ACM_PORT_CPS 0
+#ifdef ENABLE_USB_DUAL_CDC
+    #define CDC_ACM_PORT_AUX   1
+    #define CDC_ACM_PORT_COUNT 2
+#else
+    #define CDC_ACM_PORT_COUNT 1
+#endif
+
 typedef struct
 {
     uint8_t *buf;
@@ -93,8 +106,21 @@ typedef struct
     volatile uint32_t *write_pointer;
 } cdc_acm_rx_buf_t;
 
-void cdc_acm_init(cdc_acm_rx_buf_t rx_buf);
-void cdc_acm_data_send_with_dtr(const uint8_t *buf, uint32_t size);
-void cdc_acm_data_send_with_dtr_async(const uint8_t *buf, uint32_t size);
+void cdc_acm_init(const cdc_acm_rx_buf_t rx_buf[CDC_ACM_PORT_COUNT]);
+bool cdc_acm_is_open(uint8_t port);
+// IN data goes through a per-port ring. Neither variant waits for the host:
+// the plain one queues what fits and returns the byte count (all of it when
+// no terminal is open, so callers do not retry into the void); the async
+// variant queues all of buf or nothing.
+#define CDC_TX_RING_SIZE 512
+
+uint32_t cdc_acm_data_send_with_dtr(uint8_t port, const uint8_t *buf, uint32_t size);
+bool cdc_acm_data_send_with_dtr_async(uint8_t port, const uint8_t *buf, uint32_t size);
+uint32_t cdc_acm_tx_free(uint8_t port);
+bool cdc_acm_tx_is_idle(uint8_t port);
+
+#ifdef ENABLE_USB_MSC
+void msc_disk_init(void);
+#endif
 
 #endif
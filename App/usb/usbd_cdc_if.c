@@ -6,13 +6,20 @@
 #define CDC_OUT_EP 0x02
 #define CDC_INT_EP 0x83
 
+#ifdef ENABLE_USB_DUAL_CDC
+    // second ACM function: screenshot stream + debug log
+    #define CDC_AUX_IN_EP  0x85
+    #define CDC_AUX_OUT_EP 0x05
+    #define CDC_AUX_INT_EP 0x84
+#endif
+
 #define USBD_VID           0x36b7
 #define USBD_PID           0xFFFF
 #define USBD_MAX_POWER     100
 #define USBD_LANGID_STRING 1033
 
 /*!< config descriptor size */
-#define USB_CONFIG_SIZE (9 + CDC_ACM_DESCRIPTOR_LEN)
+#define USB_CONFIG_SIZE (9 + CDC_ACM_DESCRIPTOR_LEN * CDC_ACM_PORT_COUNT)
 
 uint8_t dma_in_ep_idx  = (CDC_IN_EP & 0x7f);
 uint8_t dma_out_ep_idx = CDC_OUT_EP;
@@ -20,8 +27,11 @@ uint8_t dma_out_ep_idx = CDC_OUT_EP;
 /*!< global descriptor */
 static const uint8_t cdc_descriptor[] = {
     USB_DEVICE_DESCRIPTOR_INIT(USB_2_0, 0xEF, 0x02, 0x01, USBD_VID, USBD_PID, 0x0100, 0x01),
-    USB_CONFIG_DESCRIPTOR_INIT(USB_CONFIG_SIZE, 0x02, 0x01, USB_CONFIG_BUS_POWERED, USBD_MAX_POWER),
+    USB_CONFIG_DESCRIPTOR_INIT(USB_CONFIG_SIZE, 0x02 * CDC_ACM_PORT_COUNT, 0x01, USB_CONFIG_BUS_POWERED, USBD_MAX_POWER),
     CDC_ACM_DESCRIPTOR_INIT(0x00, CDC_INT_EP, CDC_OUT_EP, CDC_IN_EP, 0x02),
+#ifdef ENABLE_USB_DUAL_CDC
+    CDC_ACM_DESCRIPTOR_INIT(0x02, CDC_AUX_INT_EP, CDC_AUX_OUT_EP, CDC_AUX_IN_EP, 0x02),
+#endif
     ///////////////////////////////////////
     /// string0 descriptor
     ///////////////////////////////////////
@@ -86,31 +96,85 @@ static const uint8_t cdc_descriptor[] = {
     0x00
 };
 
-USB_MEM_ALIGNX uint8_t read_buffer[128];
-// USB_MEM_ALIGNX uint8_t write_buffer[4];
-
-static cdc_acm_rx_buf_t client_rx_buf = {0};
-
-volatile bool ep_tx_busy_flag = false;
-
 #ifdef CONFIG_USB_HS
 #define CDC_MAX_MPS 512
 #else
 #define CDC_MAX_MPS 64
 #endif
 
+typedef struct
+{
+    uint8_t out_ep;
+    uint8_t in_ep;
+} cdc_acm_port_eps_t;
+
+static const cdc_acm_port_eps_t port_eps[CDC_ACM_PORT_COUNT] = {
+    [CDC_ACM_PORT_CPS] = { CDC_OUT_EP, CDC_IN_EP },
+#ifdef ENABLE_USB_DUAL_CDC
+    [CDC_ACM_PORT_AUX] = { CDC_AUX_OUT_EP, CDC_AUX_IN_EP },
+#endif
+};
+
+USB_MEM_ALIGNX uint8_t read_buffer[CDC_ACM_PORT_COUNT][128];
+// USB_MEM_ALIGNX uint8_t write_buffer[4];
+
+static cdc_acm_rx_buf_t client_rx_buf[CDC_ACM_PORT_COUNT];
+
+/* IN data is queued here and sent from the ring itself: every completed
+ * transfer chains the next one, so writes made meanwhile go out together
+ * as full packets. Only the main loop moves head, only the endpoint
+ * callback moves tail. One slot stays empty to tell full from empty. */
+typedef struct
+{
+    uint8_t buf[CDC_TX_RING_SIZE];
+    volatile uint16_t head;
+    volatile uint16_t tail;
+    volatile uint16_t xfer_len; /* bytes of the transfer on the endpoint */
+} cdc_acm_tx_ring_t;
+
+static cdc_acm_tx_ring_t tx_ring[CDC_ACM_PORT_COUNT];
+
+volatile bool ep_tx_busy_flag[CDC_ACM_PORT_COUNT];
+volatile uint8_t dtr_enable[CDC_ACM_PORT_COUNT];
+
+static void cdc_acm_tx_start(uint8_t port);
+
+static uint8_t cdc_acm_port_from_ep(uint8_t ep)
+{
+#ifdef ENABLE_USB_DUAL_CDC
+    if ((ep & 0x7f) == (CDC_AUX_OUT_EP & 0x7f) || ep == CDC_AUX_IN_EP)
+        return CDC_ACM_PORT_AUX;
+#endif
+    (void)ep;
+    return CDC_ACM_PORT_CPS;
+}
+
 void usbd_configure_done_callback(void)
 {
-    /* setup first out ep read transfer */
-    usbd_ep_start_read(CDC_OUT_EP, read_buffer, sizeof(read_buffer));
+    /* the USB disk personality shares the core but has no ACM ports */
+    if (!client_rx_buf[CDC_ACM_PORT_CPS].buf)
+        return;
+
+    /* setup first out ep read transfer on every port, anything queued
+     * before the (re)configuration is stale */
+    for (uint8_t port = 0; port < CDC_ACM_PORT_COUNT; port++)
+    {
+        tx_ring[port].head = 0;
+        tx_ring[port].tail = 0;
+        tx_ring[port].xfer_len = 0;
+        ep_tx_busy_flag[port] = false;
+
+        usbd_ep_start_read(port_eps[port].out_ep, read_buffer[port], sizeof(read_buffer[port]));
+    }
 }
 
 void usbd_cdc_acm_bulk_out(uint8_t ep, uint32_t nbytes)
 {
-    cdc_acm_rx_buf_t *rx_buf = &client_rx_buf;
+    const uint8_t port = cdc_acm_port_from_ep(ep);
+    cdc_acm_rx_buf_t *rx_buf = &client_rx_buf[port];
     if (nbytes && rx_buf->buf)
     {
-        const uint8_t *buf = read_buffer;
+        const uint8_t *buf = read_buffer[port];
         uint32_t pointer = *rx_buf->write_pointer;
         while (nbytes)
         {
@@ -132,16 +196,23 @@ void usbd_cdc_acm_bulk_out(uint8_t ep, uint32_t nbytes)
     }
 
     /* setup next out ep read transfer */
-    usbd_ep_start_read(CDC_OUT_EP, read_buffer, sizeof(read_buffer));
+    usbd_ep_start_read(port_eps[port].out_ep, read_buffer[port], sizeof(read_buffer[port]));
 }
 
 void usbd_cdc_acm_bulk_in(uint8_t ep, uint32_t nbytes)
 {
-    if ((nbytes % CDC_MAX_MPS) == 0 && nbytes) {
-        /* send zlp */
-        usbd_ep_start_write(CDC_IN_EP, NULL, 0);
+    const uint8_t port = cdc_acm_port_from_ep(ep);
+    cdc_acm_tx_ring_t *ring = &tx_ring[port];
+
+    ring->tail = (ring->tail + ring->xfer_len) % CDC_TX_RING_SIZE;
+    ring->xfer_len = 0;
+
+    if (ring->head == ring->tail && (nbytes % CDC_MAX_MPS) == 0 && nbytes) {
+        /* nothing follows, send zlp */
+        usbd_ep_start_write(port_eps[port].in_ep, NULL, 0);
     } else {
-        ep_tx_busy_flag = false;
+        ep_tx_busy_flag[port] = false;
+        cdc_acm_tx_start(port);
     }
 }
 
@@ -159,51 +230,137 @@ struct usbd_endpoint cdc_in_ep = {
 struct usbd_interface intf0;
 struct usbd_interface intf1;
 
-void cdc_acm_init(cdc_acm_rx_buf_t rx_buf)
+#ifdef ENABLE_USB_DUAL_CDC
+struct usbd_endpoint cdc_aux_out_ep = {
+    .ep_addr = CDC_AUX_OUT_EP,
+    .ep_cb = usbd_cdc_acm_bulk_out
+};
+
+struct usbd_endpoint cdc_aux_in_ep = {
+    .ep_addr = CDC_AUX_IN_EP,
+    .ep_cb = usbd_cdc_acm_bulk_in
+};
+
+struct usbd_interface intf2;
+struct usbd_interface intf3;
+#endif
+
+void cdc_acm_init(const cdc_acm_rx_buf_t rx_buf[CDC_ACM_PORT_COUNT])
 {
-    // client_rx_buf = rx_buf;
-    memcpy(&client_rx_buf, &rx_buf, sizeof(cdc_acm_rx_buf_t));
-    *client_rx_buf.write_pointer = 0;
+    memcpy(client_rx_buf, rx_buf, sizeof(client_rx_buf));
+    for (uint8_t port = 0; port < CDC_ACM_PORT_COUNT; port++)
+        *client_rx_buf[port].write_pointer = 0;
 
     usbd_desc_register(cdc_descriptor);
     usbd_add_interface(usbd_cdc_acm_init_intf(&intf0));
     usbd_add_interface(usbd_cdc_acm_init_intf(&intf1));
     usbd_add_endpoint(&cdc_out_ep);
     usbd_add_endpoint(&cdc_in_ep);
+#ifdef ENABLE_USB_DUAL_CDC
+    usbd_add_interface(usbd_cdc_acm_init_intf(&intf2));
+    usbd_add_interface(usbd_cdc_acm_init_intf(&intf3));
+    usbd_add_endpoint(&cdc_aux_out_ep);
+    usbd_add_endpoint(&cdc_aux_in_ep);
+#endif
     usbd_initialize();
 }
 
-volatile uint8_t dtr_enable = 0;
-
 void usbd_cdc_acm_set_dtr(uint8_t intf, bool dtr)
 {
+    // each ACM function owns two interfaces (comm + data)
+    const uint8_t port = intf / 2;
+
+    if (port >= CDC_ACM_PORT_COUNT)
+        return;
+
     if (dtr) {
-        dtr_enable = 1;
+        dtr_enable[port] = 1;
     } else {
-        dtr_enable = 0;
+        dtr_enable[port] = 0;
     }
 }
 
-void cdc_acm_data_send_with_dtr(const uint8_t *buf, uint32_t size)
+bool cdc_acm_is_open(uint8_t port)
+{
+    return port < CDC_ACM_PORT_COUNT && dtr_enable[port];
+}
+
+/* Called from the endpoint callback or with interrupts masked */
+static void cdc_acm_tx_start(uint8_t port)
 {
-    if (dtr_enable && 0 != size)
+    cdc_acm_tx_ring_t *ring = &tx_ring[port];
+    const uint16_t head = ring->head;
+    const uint16_t tail = ring->tail;
+
+    if (ep_tx_busy_flag[port] || head == tail)
+        return;
+
+    /* up to the end of the ring, the wrapped part follows on completion */
+    ring->xfer_len = (head > tail) ? (head - tail) : (CDC_TX_RING_SIZE - tail);
+    ep_tx_busy_flag[port] = true;
+
+    if (usbd_ep_start_write(port_eps[port].in_ep, ring->buf + tail, ring->xfer_len) < 0)
     {
-        ep_tx_busy_flag = true;
-        usbd_ep_start_write(CDC_IN_EP, buf, size);
-        uint32_t timeout = 100000;
-        while (ep_tx_busy_flag && --timeout)
-            ;
-        if (!timeout) {
-            ep_tx_busy_flag = false;
-            dtr_enable = 0;  // Consider USB disconnected
-        }
+        /* not configured (yet), keep the data for the next attempt */
+        ring->xfer_len = 0;
+        ep_tx_busy_flag[port] = false;
     }
 }
 
-void cdc_acm_data_send_with_dtr_async(const uint8_t *buf, uint32_t size)
+static uint32_t cdc_acm_tx_push(uint8_t port, const uint8_t *buf, uint32_t size)
 {
-    if (0 != size)
+    cdc_acm_tx_ring_t *ring = &tx_ring[port];
+    uint16_t head = ring->head;
+    const uint32_t free = cdc_acm_tx_free(port);
+
+    if (size > free)
+        size = free;
+
+    for (uint32_t i = 0; i < size; i++)
     {
-        usbd_ep_start_write(CDC_IN_EP, buf, size);
+        ring->buf[head] = buf[i];
+        head = (head + 1) % CDC_TX_RING_SIZE;
     }
+
+    ring->head = head;
+
+    if (size)
+    {
+        const uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        cdc_acm_tx_start(port);
+        __set_PRIMASK(primask);
+    }
+
+    return size;
+}
+
+uint32_t cdc_acm_tx_free(uint8_t port)
+{
+    const cdc_acm_tx_ring_t *ring = &tx_ring[port];
+    return (ring->tail + CDC_TX_RING_SIZE - ring->head - 1) % CDC_TX_RING_SIZE;
+}
+
+bool cdc_acm_tx_is_idle(uint8_t port)
+{
+    return tx_ring[port].head == tx_ring[port].tail && !ep_tx_busy_flag[port];
+}
+
+uint32_t cdc_acm_data_send_with_dtr(uint8_t port, const uint8_t *buf, uint32_t size)
+{
+    /* never waits: queues what fits, the caller retries the rest later */
+    if (!dtr_enable[port])
+        return size;
+
+    return cdc_acm_tx_push(port, buf, size);
+}
+
+bool cdc_acm_data_send_with_dtr_async(uint8_t port, const uint8_t *buf, uint32_t size)
+{
+    /* all or nothing, a partial reply is worse than none */
+    if (size > cdc_acm_tx_free(port))
+        return false;
+
+    cdc_acm_tx_push(port, buf, size);
+    return true;
 }
@@ -0,0 +1,239 @@
+#include "usbd_core.h"
+#include "usbd_msc.h"
+#include "driver/eeprom.h"
+
+/*!< endpoint address */
+#define MSC_IN_EP  0x81
+#define MSC_OUT_EP 0x02
+
+#define USBD_VID           0x36b7
+#define USBD_PID           0xFFFE
+#define USBD_MAX_POWER     100
+#define USBD_LANGID_STRING 1033
+
+/*!< config descriptor size */
+#define USB_CONFIG_SIZE (9 + MSC_DESCRIPTOR_LEN)
+
+/*
+ * Synthesized FAT12 volume exposing the EEPROM-compatible address space
+ * (see ADDR_MAPPINGS in driver/eeprom_compat.c) as two files:
+ *
+ *   CODEPLUG.BIN  0x0000 - 0xB000  channels, names, attributes, VFOs, settings
+ *   CALIB.BIN     0xB000 - 0xB200  calibration, read-only
+ *
+ *   LBA 0      boot sector
+ *   LBA 1      FAT (single copy)
+ *   LBA 2      root directory
+ *   LBA 3..    data, one 512 byte sector per cluster, files stored contiguously
+ *
+ * Nothing is stored: every sector is generated on read. The volume is read
+ * only. A host copying a file onto it truncates and reallocates clusters and
+ * adds metadata files, and the FAT and directory updates that say where the
+ * data went can come after the data itself. Following that would take a
+ * staging copy of the whole file, and there is neither RAM nor known-free
+ * flash for one. Restore a codeplug with tools/serialtool instead.
+ */
+#define BLOCK_SIZE          512
+#define LBA_FAT             1
+#define LBA_ROOT_DIR        2
+#define LBA_DATA            3
+
+#define CODEPLUG_SIZE       0xB000
+#define CALIB_ADDR          0xB000
+#define CALIB_SIZE          0x0200
+
+#define CODEPLUG_CLUSTERS   (CODEPLUG_SIZE / BLOCK_SIZE)
+#define CALIB_CLUSTERS      (CALIB_SIZE / BLOCK_SIZE)
+#define CLUSTER_COUNT       (CODEPLUG_CLUSTERS + CALIB_CLUSTERS)
+#define BLOCK_COUNT         (LBA_DATA + CLUSTER_COUNT)
+
+#define FIRST_CLUSTER       2
+#define CALIB_FIRST_CLUSTER (FIRST_CLUSTER + CODEPLUG_CLUSTERS)
+
+#define FAT_DATE ((2025 - 1980) << 9 | 1 << 5 | 1)
+
+_Static_assert((CLUSTER_COUNT + FIRST_CLUSTER) * 3 / 2 <= BLOCK_SIZE, "FAT must fit one sector");
+
+static const uint8_t msc_descriptor[] = {
+    USB_DEVICE_DESCRIPTOR_INIT(USB_2_0, 0x00, 0x00, 0x00, USBD_VID, USBD_PID, 0x0100, 0x01),
+    USB_CONFIG_DESCRIPTOR_INIT(USB_CONFIG_SIZE, 0x01, 0x01, USB_CONFIG_BUS_POWERED, USBD_MAX_POWER),
+    MSC_DESCRIPTOR_INIT(0x00, MSC_OUT_EP, MSC_IN_EP, 0x02),
+    ///////////////////////////////////////
+    /// string0 descriptor
+    ///////////////////////////////////////
+    USB_LANGID_INIT(USBD_LANGID_STRING),
+    ///////////////////////////////////////
+    /// string1 descriptor
+    ///////////////////////////////////////
+    0x0A,                       /* bLength */
+    USB_DESCRIPTOR_TYPE_STRING, /* bDescriptorType */
+    'P', 0x00,                  /* wcChar0 */
+    'U', 0x00,                  /* wcChar1 */
+    'Y', 0x00,                  /* wcChar2 */
+    'A', 0x00,                  /* wcChar3 */
+    ///////////////////////////////////////
+    /// string2 descriptor
+    ///////////////////////////////////////
+    0x16,                       /* bLength */
+    USB_DESCRIPTOR_TYPE_STRING, /* bDescriptorType */
+    'P', 0x00,                  /* wcChar0 */
+    'U', 0x00,                  /* wcChar1 */
+    'Y', 0x00,                  /* wcChar2 */
+    'A', 0x00,                  /* wcChar3 */
+    ' ', 0x00,                  /* wcChar4 */
+    'D', 0x00,                  /* wcChar5 */
+    'I', 0x00,                  /* wcChar6 */
+    'S', 0x00,                  /* wcChar7 */
+    'K', 0x00,                  /* wcChar8 */
+    ' ', 0x00,                  /* wcChar9 */
+    ///////////////////////////////////////
+    /// string3 descriptor
+    ///////////////////////////////////////
+    0x16,                       /* bLength */
+    USB_DESCRIPTOR_TYPE_STRING, /* bDescriptorType */
+    '2', 0x00,                  /* wcChar0 */
+    '0', 0x00,                  /* wcChar1 */
+    '2', 0x00,                  /* wcChar2 */
+    '2', 0x00,                  /* wcChar3 */
+    '1', 0x00,                  /* wcChar4 */
+    '2', 0x00,                  /* wcChar5 */
+    '3', 0x00,                  /* wcChar6 */
+    '4', 0x00,                  /* wcChar7 */
+    '5', 0x00,                  /* wcChar8 */
+    '7', 0x00,                  /* wcChar9 */
+    0x00
+};
+
+static struct usbd_interface intf0;
+
+static inline void put_le16(uint8_t *p, uint16_t v)
+{
+    p[0] = v & 0xff;
+    p[1] = v >> 8;
+}
+
+static inline void put_le32(uint8_t *p, uint32_t v)
+{
+    put_le16(p, v & 0xffff);
+    put_le16(p + 2, v >> 16);
+}
+
+static void build_boot_sector(uint8_t *buf)
+{
+    static const uint8_t jump_oem[] = {0xEB, 0x3C, 0x90, 'M', 'S', 'D', 'O', 'S', '5', '.', '0'};
+
+    memcpy(buf, jump_oem, sizeof(jump_oem));
+    put_le16(buf + 11, BLOCK_SIZE);  // bytes per sector
+    buf[13] = 1;                     // sectors per cluster
+    put_le16(buf + 14, LBA_FAT);     // reserved sectors
+    buf[16] = 1;                     // number of FATs
+    put_le16(buf + 17, BLOCK_SIZE / 32); // root directory entries
+    put_le16(buf + 19, BLOCK_COUNT); // total sectors
+    buf[21] = 0xF8;                  // media descriptor
+    put_le16(buf + 22, 1);           // sectors per FAT
+    put_le16(buf + 24, 1);           // sectors per track
+    put_le16(buf + 26, 1);           // heads
+    buf[36] = 0x80;                  // drive number
+    buf[38] = 0x29;                  // extended boot signature
+    put_le32(buf + 39, 0x4B350001);  // volume serial
+    memcpy(buf + 43, "UV-K5      ", 11);
+    memcpy(buf + 54, "FAT12   ", 8);
+    buf[510] = 0x55;
+    buf[511] = 0xAA;
+}
+
+static uint16_t fat_entry(uint32_t cluster)
+{
+    if (cluster < FIRST_CLUSTER)
+        return cluster == 0 ? 0xFF8 : 0xFFF;
+
+    if (cluster == CALIB_FIRST_CLUSTER - 1 || cluster == CALIB_FIRST_CLUSTER + CALIB_CLUSTERS - 1)
+        return 0xFFF; // end of chain
+
+    return cluster + 1;
+}
+
+static void build_fat(uint8_t *buf)
+{
+    for (uint32_t cluster = 0; cluster < FIRST_CLUSTER + CLUSTER_COUNT; cluster++)
+    {
+        const uint16_t value = fat_entry(cluster);
+        uint8_t *p = buf + cluster * 3 / 2;
+
+        if (cluster & 1)
+        {
+            p[0] = (p[0] & 0x0F) | (value << 4);
+            p[1] = value >> 4;
+        }
+        else
+        {
+            p[0] = value;
+            p[1] = (p[1] & 0xF0) | ((value >> 8) & 0x0F);
+        }
+    }
+}
+
+static void put_dir_entry(uint8_t *p, const char *name, uint8_t attr, uint16_t cluster, uint32_t size)
+{
+    memcpy(p, name, 11);
+    p[11] = attr;
+    put_le16(p + 16, FAT_DATE); // creation date
+    put_le16(p + 18, FAT_DATE); // last access date
+    put_le16(p + 24, FAT_DATE); // modification date
+    put_le16(p + 26, cluster);
+    put_le32(p + 28, size);
+}
+
+static void build_root_dir(uint8_t *buf)
+{
+    put_dir_entry(buf +  0, "UV-K5      ", 0x08, 0, 0);
+    put_dir_entry(buf + 32, "CODEPLUGBIN", 0x21, FIRST_CLUSTER, CODEPLUG_SIZE);
+    put_dir_entry(buf + 64, "CALIB   BIN", 0x21, CALIB_FIRST_CLUSTER, CALIB_SIZE);
+}
+
+void usbd_msc_get_cap(uint8_t lun, uint32_t *block_num, uint16_t *block_size)
+{
+    *block_num = BLOCK_COUNT;
+    *block_size = BLOCK_SIZE;
+}
+
+int usbd_msc_sector_read(uint32_t sector, uint8_t *buffer, uint32_t length)
+{
+    for (; length >= BLOCK_SIZE; length -= BLOCK_SIZE, buffer += BLOCK_SIZE, sector++)
+    {
+        memset(buffer, 0, BLOCK_SIZE);
+
+        if (sector == 0)
+            build_boot_sector(buffer);
+        else if (sector == LBA_FAT)
+            build_fat(buffer);
+        else if (sector == LBA_ROOT_DIR)
+            build_root_dir(buffer);
+        else if (sector < BLOCK_COUNT)
+        {
+            const uint16_t addr = (sector - LBA_DATA) * BLOCK_SIZE;
+            // EEPROM_ReadBuffer takes an 8-bit size
+            for (uint16_t i = 0; i < BLOCK_SIZE; i += 128)
+                EEPROM_ReadBuffer(addr + i, buffer + i, 128);
+        }
+        else
+            return -1;
+    }
+
+    return 0;
+}
+
+// read only, see above
+int usbd_msc_sector_write(uint32_t sector, uint8_t *buffer, uint32_t length)
+{
+    return -1;
+}
+
+void msc_disk_init(void)
+{
+    usbd_desc_register(msc_descriptor);
+    usbd_add_interface(usbd_msc_init_intf(&intf0, MSC_OUT_EP, MSC_IN_EP));
+    // reported as write protected, after the class init cleared it
+    usbd_msc_set_readonly(true);
+    usbd_initialize();
+}
@@ -0,0 +1,22 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+// Minimal check macro for the host tests: report and count, keep going
+static unsigned int TestFailures;
+
+#define CHECK(Cond, ...)                                        \
+    do {                                                        \
+        if (!(Cond)) {                                          \
+            printf("%s:%d: %s: ", __FILE__, __LINE__, #Cond);   \
+            printf(__VA_ARGS__);                                \
+            printf("\n");                                       \
+            TestFailures++;                                     \
+        }                                                       \
+    } while (0)
+
+#define TEST_RESULT(Name)                                       \
+    (printf("%s: %s\n", Name, TestFailures ? "FAILED" : "ok"), TestFailures != 0)
+
+#endif
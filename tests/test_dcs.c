@@ -0,0 +1,92 @@
+// Checks the bisection in DCS_GetCdcssCode() against the linear search it
+// replaced, for every 9-bit code in both polarities and all 23 rotations.
+
+#include <stdint.h>
+
+#include "dcs.h"
+#include "misc.h"
+#include "test.h"
+
+static uint32_t Golay(uint32_t CodeWord)
+{
+    uint32_t Word = CodeWord;
+
+    for (unsigned int i = 0; i < 12; i++)
+    {
+        Word <<= 1;
+        if (Word & 0x1000)
+            Word ^= 0x08EA;
+    }
+
+    return CodeWord | ((Word & 0x0FFE) << 11);
+}
+
+// DCS_GetCdcssCode() before the bisection
+static uint8_t GetCdcssCodeLinear(uint32_t Code)
+{
+    for (unsigned int i = 0; i < 23; i++)
+    {
+        uint32_t Shift;
+
+        if (((Code >> 9) & 0x7U) == 4)
+        {
+            for (unsigned int j = 0; j < ARRAY_SIZE(DCS_Options); j++)
+                if (DCS_Options[j] == (Code & 0x1FF))
+                    if (DCS_GetGolayCodeWord(2, j) == Code)
+                        return j;
+        }
+
+        Shift = Code >> 1;
+        if (Code & 1U)
+            Shift |= 0x400000U;
+        Code = Shift;
+    }
+
+    return 0xFF;
+}
+
+static uint32_t Rotate(uint32_t Code, unsigned int Count)
+{
+    return ((Code >> Count) | (Code << (23 - Count))) & 0x7FFFFF;
+}
+
+int main(void)
+{
+    unsigned int Hits = 0;
+
+    for (uint32_t Data = 0; Data < 512; Data++)
+    {
+        const uint32_t Word = Golay(Data | 0x800);
+
+        for (unsigned int Polarity = 0; Polarity < 2; Polarity++)
+        {
+            const uint32_t Code = Polarity ? Word ^ 0x7FFFFF : Word;
+
+            for (unsigned int r = 0; r < 23; r++)
+            {
+                const uint32_t Received = Rotate(Code, r);
+                const uint8_t  Expected = GetCdcssCodeLinear(Received);
+                const uint8_t  Got      = DCS_GetCdcssCode(Received);
+
+                CHECK(Got == Expected, "data 0x%03X polarity %u rotation %u: got %u, want %u",
+                    (unsigned int)Data, Polarity, r, Got, Expected);
+
+                if (Expected != 0xFF)
+                    Hits++;
+            }
+        }
+    }
+
+    // every listed code decodes from each of its rotations
+    for (unsigned int j = 0; j < ARRAY_SIZE(DCS_Options); j++)
+    {
+        const uint32_t Word = DCS_GetGolayCodeWord(CODE_TYPE_DIGITAL, j);
+
+        for (unsigned int r = 0; r < 23; r++)
+            CHECK(DCS_GetCdcssCode(Rotate(Word, r)) != 0xFF, "option %u rotation %u not found", j, r);
+    }
+
+    CHECK(Hits >= ARRAY_SIZE(DCS_Options) * 23, "only %u hits", Hits);
+
+    return TEST_RESULT("dcs");
+}
@@ -0,0 +1,197 @@
+// Checks the SETTINGS_FIELDS layout of the settings block: every field fits
+// its byte, no two fields share a bit, and each valid value survives an
+// encode/decode round trip without touching the bits around it.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "misc.h"
+#include "settings.h"
+#include "settings_fields.h"
+#include "test.h"
+
+EEPROM_Config_t gEeprom;
+
+#ifndef ENABLE_FEAT_F4HWN
+    // misc.c only defines it for F4HWN builds but uses it in all of them
+    uint32_t gBlinkCounter;
+#endif
+
+// misc.c keeps the channel attributes on flash, not used here
+void PY25Q16_ReadBuffer(uint32_t Address, void *pBuffer, uint32_t Size)
+{
+    (void)Address;
+    memset(pBuffer, 0xFF, Size);
+}
+
+void PY25Q16_WriteBuffer(uint32_t Address, const void *pBuffer, uint32_t Size, bool Append)
+{
+    (void)Address;
+    (void)pBuffer;
+    (void)Size;
+    (void)Append;
+}
+
+static uint32_t GetValue(const SettingsField_t *pField)
+{
+    switch (pField->Size)
+    {
+        case 1:  return *(const uint8_t *)pField->pValue;
+        case 2:  return *(const uint16_t *)pField->pValue;
+        default: return *(const uint32_t *)pField->pValue;
+    }
+}
+
+static void SetValue(const SettingsField_t *pField, uint32_t Value)
+{
+    switch (pField->Size)
+    {
+        case 1:  *(uint8_t *)pField->pValue = Value;  break;
+        case 2:  *(uint16_t *)pField->pValue = Value; break;
+        default: *(uint32_t *)pField->pValue = Value; break;
+    }
+}
+
+static void CheckShape(void)
+{
+    for (unsigned int i = 0; i < SETTINGS_FIELD_COUNT; i++)
+    {
+        const SettingsField_t *pField = &SETTINGS_FIELDS[i];
+        const unsigned int     Mask   = (1u << pField->Width) - 1;
+
+        CHECK(pField->Offset < SETTINGS_BLOCK_SIZE, "field %u at 0x%03X", i, pField->Offset);
+        CHECK(pField->Width > 0 && pField->Shift + pField->Width <= 8, "field %u at 0x%03X", i, pField->Offset);
+        CHECK(pField->Min <= pField->Max, "field %u at 0x%03X", i, pField->Offset);
+        CHECK(pField->Max <= Mask, "field %u at 0x%03X: max %u", i, pField->Offset, pField->Max);
+        CHECK(pField->Size == 1 || pField->Size == 2 || pField->Size == 4, "field %u at 0x%03X", i, pField->Offset);
+    }
+}
+
+static void CheckOverlap(void)
+{
+    uint8_t Used[SETTINGS_BLOCK_SIZE] = { 0 };
+
+    for (unsigned int i = 0; i < SETTINGS_FIELD_COUNT; i++)
+    {
+        const SettingsField_t *pField = &SETTINGS_FIELDS[i];
+        const uint8_t          Bits   = ((1u << pField->Width) - 1) << pField->Shift;
+
+        if (pField->Offset >= SETTINGS_BLOCK_SIZE)
+            continue;
+
+        CHECK((Used[pField->Offset] & Bits) == 0, "field %u shares bits 0x%02X at 0x%03X",
+            i, Used[pField->Offset] & Bits, pField->Offset);
+        Used[pField->Offset] |= Bits;
+
+        // two entries for the same variable would fight over it
+        for (unsigned int j = 0; j < i; j++)
+            CHECK(SETTINGS_FIELDS[j].pValue != pField->pValue, "fields %u and %u share a variable", j, i);
+    }
+}
+
+// Bytes settings.c handles by hand, no table field may land on them
+static void CheckReserved(void)
+{
+    static const struct
+    {
+        uint16_t From;
+        uint16_t To;
+    } Reserved[] = {
+        { 0x010, 0x0A8 },   // channels, FM settings and channels
+        { 0x0B0, 0x0B4 },   // power-on password
+        { 0x0B9, 0x0C0 },
+        { 0x0C8, 0x0E8 },   // logo lines
+        { 0x0E9, 0x0EB },   // DTMF separate and group call codes
+        { 0x0ED, 0x0F2 },   // DTMF timings
+        { 0x0F8, 0x130 },   // ANI, kill, revive, up and down codes
+        { 0x131, 0x137 },   // priority and call channels
+        { 0x138, 0x150 },   // AES key: read from 0x138, 0x140 in the flash layout notes
+        { 0x160, 0x170 },   // firmware version
+    };
+
+    for (unsigned int i = 0; i < SETTINGS_FIELD_COUNT; i++)
+    {
+        const uint16_t Offset = SETTINGS_FIELDS[i].Offset;
+
+        for (unsigned int r = 0; r < ARRAY_SIZE(Reserved); r++)
+            CHECK(Offset < Reserved[r].From || Offset >= Reserved[r].To, "field %u at 0x%03X is reserved", i, Offset);
+    }
+}
+
+static void CheckRoundTrip(void)
+{
+    static const uint8_t Backgrounds[] = { 0x00, 0xFF, 0xA5 };
+
+    for (unsigned int i = 0; i < SETTINGS_FIELD_COUNT; i++)
+    {
+        const SettingsField_t *pField = &SETTINGS_FIELDS[i];
+        const uint8_t          Bits   = ((1u << pField->Width) - 1) << pField->Shift;
+
+        for (unsigned int b = 0; b < sizeof(Backgrounds); b++)
+        {
+            for (uint32_t Value = pField->Min; Value <= pField->Max; Value++)
+            {
+                uint8_t Block[SETTINGS_BLOCK_SIZE];
+                uint8_t Before[SETTINGS_BLOCK_SIZE];
+
+                // load and store once so that every field holds a valid value
+                memset(Block, Backgrounds[b], sizeof(Block));
+                SETTINGS_DecodeFields(Block);
+                SETTINGS_EncodeFields(Block);
+                memcpy(Before, Block, sizeof(Block));
+
+                SetValue(pField, Value);
+                SETTINGS_EncodeFields(Block);
+
+                for (unsigned int k = 0; k < SETTINGS_BLOCK_SIZE; k++)
+                {
+                    const uint8_t Keep = (k == pField->Offset) ? (uint8_t)~Bits : 0xFF;
+                    CHECK((Block[k] & Keep) == (Before[k] & Keep), "field %u at 0x%03X: changed byte 0x%03X",
+                        i, pField->Offset, k);
+                }
+                CHECK(((Block[pField->Offset] & Bits) >> pField->Shift) == Value,
+                    "field %u at 0x%03X: stored %u", i, pField->Offset, (unsigned int)Value);
+
+                SetValue(pField, ~Value);
+                SETTINGS_DecodeFields(Block);
+                CHECK(GetValue(pField) == Value, "field %u at 0x%03X: decoded %u, want %u",
+                    i, pField->Offset, (unsigned int)GetValue(pField), (unsigned int)Value);
+            }
+        }
+    }
+}
+
+static void CheckDefaults(void)
+{
+    for (unsigned int i = 0; i < SETTINGS_FIELD_COUNT; i++)
+    {
+        const SettingsField_t *pField = &SETTINGS_FIELDS[i];
+        const unsigned int     Mask   = (1u << pField->Width) - 1;
+        uint8_t                Block[SETTINGS_BLOCK_SIZE];
+
+        // a stored value outside Min..Max loads as Default
+        for (unsigned int Stored = 0; Stored <= Mask; Stored++)
+        {
+            if (Stored >= pField->Min && Stored <= pField->Max)
+                continue;
+
+            memset(Block, 0, sizeof(Block));
+            Block[pField->Offset] = Stored << pField->Shift;
+            SETTINGS_DecodeFields(Block);
+            CHECK(GetValue(pField) == pField->Default, "field %u at 0x%03X: stored %u decoded %u",
+                i, pField->Offset, Stored, (unsigned int)GetValue(pField));
+        }
+    }
+}
+
+int main(void)
+{
+    CheckShape();
+    CheckOverlap();
+    CheckReserved();
+    CheckRoundTrip();
+    CheckDefaults();
+
+    return TEST_RESULT("settings_fields");
+}
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+#     Unless required by applicable law or agreed to in writing, software
+#     distributed under the License is distributed on an "AS IS" BASIS,
+#     WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#     See the License for the specific language governing permissions and
+#     limitations under the License.
+
+# Builds the voice prompt image the firmware plays from SPI flash, with the
+# clips encoded as IMA ADPCM (4 bits per sample). The image starts at 0x14c000:
+#
+#   0x14c000  Chinese index, 8 bytes per voice ID: offset, size | 0x80000000
+#   0x14c800  English index, same layout
+#   0x14d000  clip data; each clip is a 4 byte header (int16 predictor, uint8
+#             step index, pad) followed by the codes, low nibble first
+#
+# Clips are WAV files, 8 kHz mono 16-bit, named after the voice ID in decimal
+# or hex (e.g. 12.wav or 0x0c.wav). Missing IDs get an empty index entry.
+
+import argparse
+import os
+import struct
+import sys
+import wave
+
+IMAGE_BASE = 0x14C000
+INDEX_ZH = 0x14C000
+INDEX_EN = 0x14C800
+DATA_BASE = 0x14D000
+
+VOICE_ID_END = 0x4B
+CLIP_ADPCM = 0x80000000
+
+# limits checked by the firmware
+MAX_OFFSET = 0x0B0000
+MAX_SIZE = 0x019000
+
+STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767,
+]
+
+INDEX_ADJUST = [-1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def load_wav(file: str) -> list:
+
+    with wave.open(file, "rb") as w:
+        if w.getnchannels() != 1 or w.getsampwidth() != 2 or w.getframerate() != 8000:
+            raise ValueError("{}: need 8 kHz mono 16-bit".format(file))
+        raw = w.readframes(w.getnframes())
+
+    return list(struct.unpack("<{}h".format(len(raw) // 2), raw))
+
+
+def adpcm_encode(samples: list) -> bytes:
+
+    predictor = samples[0] if samples else 0
+    index = 0
+
+    # the decoder starts from this state, see VOICE_Start()
+    out = bytearray(struct.pack("<hBB", predictor, index, 0))
+
+    codes = []
+    for s in samples:
+        step = STEPS[index]
+        diff = s - predictor
+
+        code = 0
+        if diff < 0:
+            code = 8
+            diff = -diff
+
+        # same arithmetic as the decoder, so both track the same predictor
+        delta = step >> 3
+        if diff >= step:
+            code |= 4
+            diff -= step
+            delta += step
+        if diff >= step >> 1:
+            code |= 2
+            diff -= step >> 1
+            delta += step >> 1
+        if diff >= step >> 2:
+            code |= 1
+            delta += step >> 2
+
+        predictor += -delta if code & 8 else delta
+        predictor = max(-32768, min(32767, predictor))
+        index = max(0, min(88, index + INDEX_ADJUST[code & 7]))
+
+        codes.append(code)
+
+    if len(codes) % 2:
+        codes.append(0)
+
+    for i in range(0, len(codes), 2):
+        out.append(codes[i] | (codes[i + 1] << 4))
+
+    return bytes(out)
+
+
+def find_clips(folder: str) -> dict:
+
+    clips = {}
+    for name in os.listdir(folder):
+        stem, ext = os.path.splitext(name)
+        if ext.lower() != ".wav":
+            continue
+        try:
+            voice_id = int(stem, 0)
+        except ValueError:
+            print("Skipped {}: not a voice ID".format(name))
+            continue
+        if voice_id >= VOICE_ID_END:
+            print("Skipped {}: voice ID out of range".format(name))
+            continue
+        clips[voice_id] = os.path.join(folder, name)
+
+    return clips
+
+
+def build_index(folder: str, data: bytearray) -> bytes:
+
+    index = bytearray(8 * VOICE_ID_END)
+    if folder is None:
+        return bytes(index)
+
+    for voice_id, file in sorted(find_clips(folder).items()):
+        clip = adpcm_encode(load_wav(file))
+        offset = len(data)
+
+        if offset > MAX_OFFSET or len(clip) > MAX_SIZE:
+            raise ValueError("{}: does not fit the voice area".format(file))
+
+        struct.pack_into("<II", index, 8 * voice_id, offset, len(clip) | CLIP_ADPCM)
+        data.extend(clip)
+        print("{:#04x} {} -> {} bytes".format(voice_id, file, len(clip)))
+
+    return bytes(index)
+
+
+def main():
+
+    parser = argparse.ArgumentParser(description="Build an IMA ADPCM voice prompt image")
+    parser.add_argument("--zh", help="folder with the Chinese clips")
+    parser.add_argument("--en", help="folder with the English clips")
+    parser.add_argument("-o", "--output", required=True, help="image file, to be written at {:#x}".format(IMAGE_BASE))
+    args = parser.parse_args()
+
+    if args.zh is None and args.en is None:
+        parser.error("give --zh and/or --en")
+
+    data = bytearray()
+    try:
+        index_zh = build_index(args.zh, data)
+        index_en = build_index(args.en, data)
+    except (ValueError, wave.Error) as e:
+        print(e)
+        sys.exit(1)
+
+    image = bytearray(b"\xff" * (DATA_BASE - IMAGE_BASE))
+    image[INDEX_ZH - IMAGE_BASE:INDEX_ZH - IMAGE_BASE + len(index_zh)] = index_zh
+    image[INDEX_EN - IMAGE_BASE:INDEX_EN - IMAGE_BASE + len(index_en)] = index_en
+    image.extend(data)
+
+    with open(args.output, "wb") as fd:
+        fd.write(image)
+
+    print("Wrote {} bytes".format(len(image)))
+
+
+if __name__ == "__main__":
+    main()